@@ -1,9 +1,13 @@
 #pragma once
 #include "common.hpp"
+#include "utilities/arena.hpp"
+#include "utilities/intern.hpp"
 
 namespace cpak {
 
 
+using utilities::InternedString;
+
 class BuildTarget;
 
 enum struct AccessLevel {
@@ -35,15 +39,18 @@ struct Accessible {
 
 
 template<typename TStored>
-using Accessibles = std::vector<Accessible<TStored>>;
+using AccessiblesAllocator = utilities::ArenaAllocator<Accessible<TStored>>;
+
+template<typename TStored>
+using Accessibles = std::vector<Accessible<TStored>, AccessiblesAllocator<TStored>>;
 
 }
 
 
-template<>
-struct YAML::convert<cpak::Accessible<std::string>> {
+template<typename TStored>
+struct YAML::convert<cpak::Accessible<TStored>> {
     static Node
-    encode(const cpak::Accessible<std::string>& rhs) {
+    encode(const cpak::Accessible<TStored>& rhs) {
         Node node;
         switch (rhs.level) {
         case cpak::AccessLevel::ePublic:
@@ -62,20 +69,20 @@ struct YAML::convert<cpak::Accessible<std::string>> {
     }
 
     static bool
-    decode(const YAML::Node& node, cpak::Accessible<std::string>& rhs) {
+    decode(const YAML::Node& node, cpak::Accessible<TStored>& rhs) {
         if (node.Tag() == "!protected")
-            rhs = cpak::Accessible<std::string> {
-                .stored = node.as<std::string>(),
+            rhs = cpak::Accessible<TStored> {
+                .stored = node.as<TStored>(),
                 .level  = cpak::AccessLevel::eProtected
             };
         else if (node.Tag() == "!private")
-            rhs = cpak::Accessible<std::string> {
-                .stored = node.as<std::string>(),
+            rhs = cpak::Accessible<TStored> {
+                .stored = node.as<TStored>(),
                 .level  = cpak::AccessLevel::ePrivate
             };
         else
-            rhs = cpak::Accessible<std::string> {
-                .stored = node.as<std::string>(),
+            rhs = cpak::Accessible<TStored> {
+                .stored = node.as<TStored>(),
                 .level  = cpak::AccessLevel::ePublic
             };
         
@@ -1,12 +1,16 @@
 #include "application.hpp"
 
+#include "cache.hpp"
 #include "errorcode.hpp"
 #include "install.hpp"
 #include "management.hpp"
 #include "pipeline.hpp"
+#include "registry.hpp"
+#include "solver.hpp"
 #include "utilities/checksum.hpp"
 #include "utilities/logging.hpp"
 #include "utilities/stropts.hpp"
+#include "utilities/threadpool.hpp"
 
 
 namespace fs   = std::filesystem;
@@ -21,25 +25,26 @@ using cpak::BuildTarget;
 using cpak::Configuration;
 using cpak::CPakFile;
 using cpak::Dependency;
+using cpak::InternedString;
 using std::string;
 using std::string_view;
 using std::vector;
 
-using BuildQueue = std::queue<std::function<std::error_code()>>;
-using DependencyCache = std::unordered_map<std::string_view, const cpak::CPakFile*>;
-using InterfaceCache = std::unordered_map<std::string_view, const cpak::BuildTarget*>;
-using LibraryCache = std::unordered_map<std::string_view, const cpak::CPakFile*>;
+using BuildQueue = std::queue<cpak::BuildTask>;
+using InterfaceCache = std::unordered_map<cpak::InternedString, const cpak::BuildTarget*>;
+using LibraryCache = std::unordered_map<cpak::InternedString, const cpak::CPakFile*>;
 
 std::shared_ptr<spdlog::logger> logger;
 std::shared_ptr<ArgumentParser> program;
 std::shared_ptr<ArgumentParser> buildcmd;
 std::shared_ptr<ArgumentParser> pullcmd;
 std::shared_ptr<ArgumentParser> installcmd;
+std::shared_ptr<ArgumentParser> vendorcmd;
 std::shared_ptr<Configuration> config;
 BuildQueue buildQueue;
-DependencyCache dependencyCache;
 InterfaceCache interfaceCache;
 LibraryCache libraryCache;
+std::optional<fs::path> vendorPath;
 bool pulling;
 
 
@@ -98,24 +103,7 @@ updateOptions(CPakFile& cpakfile, const vector<string>& options) noexcept {
 
 void
 interpolateOptions(BuildTarget& target, const vector<BuildOption>& options) {
-    using cpak::interpolateOptions;
-
-    // TODO: support interpolation of the target type.
-    interpolateOptions(target.name, options);
-    for (auto&& val : target.defines) interpolateOptions(val.stored, options);
-    for (auto&& val : target.interfaces) interpolateOptions(val.stored, options);
-    for (auto&& val : target.libraries) interpolateOptions(val.stored, options);
-    for (auto&& val : target.sources) interpolateOptions(val.stored, options);
-    for (auto&& val : target.options) interpolateOptions(val.stored, options);
-
-    if (target.search != std::nullopt) {
-        for (auto&& val : target.search->include)
-            interpolateOptions(val.stored, options);
-        for (auto&& val : target.search->system)
-            interpolateOptions(val.stored, options);
-        for (auto&& val : target.search->library)
-            interpolateOptions(val.stored, options);
-    }
+    cpak::interpolateOptions(target, cpak::makeOptionTable(options));
 }
 
 
@@ -217,11 +205,21 @@ initBuildCommand() noexcept {
         .metavar("PROFILE")
         .nargs(1);
 
+    buildcmd->add_argument("--vendor")
+        .help("Fetches the dependencies from a directory made by the vendor command")
+        .metavar("DIR")
+        .nargs(1);
+
     buildcmd->add_argument("path")
         .help("Path to the project to build")
         .metavar("PATH")
         .nargs(argparse::nargs_pattern::optional);
 
+    buildcmd->add_argument("targets")
+        .help("Targets to build, every target is built when none are given")
+        .metavar("TARGET")
+        .nargs(argparse::nargs_pattern::any);
+
     program->add_subparser(*buildcmd);
 }
 
@@ -230,7 +228,7 @@ initPullCommand() noexcept {
     pullcmd = std::make_shared<ArgumentParser>(
         "pull", "1.0", argparse::default_arguments::help);
 
-    pullcmd->add_description("Pulls a project from GitHub given a project ID.");
+    pullcmd->add_description("Pulls projects from GitHub given their project IDs.");
     pullcmd->set_assign_chars("=:");
 
     pullcmd->add_argument("-u", "--update")
@@ -248,11 +246,22 @@ initPullCommand() noexcept {
         .metavar("OPTION[:value]")
         .append();
 
-    pullcmd->add_argument("id")
-        .help("The ID of the project to clone from GitHub.")
-        .metavar("id")
+    pullcmd->add_argument("-f", "--file")
+        .help("Reads the IDs to pull from a file, one per line.")
+        .metavar("FILE")
         .nargs(1);
 
+    pullcmd->add_argument("-j", "--jobs")
+        .help("The number of projects to fetch at once, overrides the configuration.")
+        .metavar("JOBS")
+        .nargs(1)
+        .scan<'u', std::uint32_t>();
+
+    pullcmd->add_argument("ids")
+        .help("The IDs of the projects to clone from GitHub.")
+        .metavar("ID")
+        .nargs(argparse::nargs_pattern::any);
+
     program->add_subparser(*pullcmd);
 }
 
@@ -277,70 +286,653 @@ initInstallCommand() noexcept {
     program->add_subparser(*installcmd);
 }
 
+void
+initVendorCommand() noexcept {
+    vendorcmd = std::make_shared<ArgumentParser>(
+        "vendor", "1.0", argparse::default_arguments::help);
+
+    vendorcmd->add_description(
+        "Copies the resolved dependencies of a project into a directory.");
+    vendorcmd->set_assign_chars("=:");
+
+    vendorcmd->add_argument("-o", "--output")
+        .help("The directory to vendor into, 'vendor' in the project by default")
+        .metavar("DIR")
+        .nargs(1);
+
+    vendorcmd->add_argument("path")
+        .help("Path to the project to vendor")
+        .metavar("PATH")
+        .nargs(argparse::nargs_pattern::optional);
+
+    program->add_subparser(*vendorcmd);
+}
+
 std::tuple<std::optional<CPakFile>, std::error_code>
-internalLoadCPakFile(const fs::path& projectPath) noexcept {
+internalLoadCPakFile(const fs::path& projectPath, bool interpolate = true) noexcept {
     auto loadStatus         = cpak::make_error_code(cpak::errc::success);
     auto [cpakfile, result] = mgmt::loadCPakFile(projectPath);
     if (result.value() != cpak::errc::success)
         return { cpakfile, result }; // Let the caller handle the error.
 
+    // Projects loaded outside of a command keep their default options.
     auto command = pulling ? pullcmd : buildcmd;
-
-    if (command->is_used("--define"))
+    if (command != nullptr && command->is_used("--define"))
         updateOptions(*cpakfile, command->get<vector<string>>("--define"));
 
-    interpolateOptions(*cpakfile);
-    for (const auto& target : cpakfile->targets) {
+    // The option values are part of the checksum, so the build path does not
+    // depend on how many of the targets get interpolated.
+    cpakfile->projectPath = projectPath;
+    cpakfile->buildPath   = projectPath / ".cpak" / util::checksum(*cpakfile);
+    if (interpolate) interpolateOptions(*cpakfile);
+    return std::make_tuple(cpakfile, result);
+}
+
+
+std::error_code
+registerInterfaces(const CPakFile& cpakfile) noexcept {
+    for (const auto& target : cpakfile.targets) {
+        if (target.type != cpak::TargetType::Interface) continue;
         if (interfaceCache.contains(target.name))
-            return { cpakfile, cpak::make_error_code(
-                                   cpak::errc::interfaceNameCollision) };
+            return cpak::make_error_code(cpak::errc::interfaceNameCollision);
 
-        if (target.type == cpak::TargetType::Interface)
-            interfaceCache[target.name] = &target;
+        interfaceCache[target.name] = &target;
     }
 
-    cpakfile->projectPath = projectPath;
-    cpakfile->buildPath   = projectPath / ".cpak" / util::checksum(*cpakfile);
-    return std::make_tuple(cpakfile, result);
+    return cpak::make_error_code(cpak::errc::success);
+}
+
+
+/// @brief  Gets the package an identity is a version of.
+/// @param  identity The identity of the project or dependency.
+/// @return The group id and name of the identity.
+string
+packageOf(const cpak::Identity& identity) noexcept {
+    return identity.gpid + "/" + identity.name;
+}
+
+
+/// @brief  Points the dependencies of a project at their selected versions.
+/// @param  cpakfile The project to update.
+/// @param  selection The version selected for every package.
+void
+applySelection(CPakFile& cpakfile,
+               const cpak::solver::Selection& selection) noexcept {
+    for (auto& dependency : cpakfile.dependencies) {
+        const auto iter = selection.find(packageOf(dependency));
+        if (iter != selection.end()) dependency.semv = iter->second;
+    }
+}
+
+
+/// @brief  Points a dependency at its vendored repository when building from a
+///         vendor directory.
+/// @param  dependency The dependency to fetch.
+/// @return The dependency to fetch instead.
+Dependency
+vendored(const Dependency& dependency) noexcept {
+    if (vendorPath == std::nullopt) return dependency;
+
+    // Dependencies downloaded as archives were vendored as archives.
+    auto vendoredDependency   = dependency;
+    vendoredDependency.remote = cpak::Repository{ .address = vendorPath->string() };
+    if (dependency.remote != std::nullopt && !dependency.remote->archive.empty())
+        vendoredDependency.remote->archive =
+            mgmt::vendoredArchiveURL(dependency, *vendorPath);
+    return vendoredDependency;
+}
+
+
+/// @brief   Selects one version of every package in the dependency graph.
+/// @details Versions that are checked out, locked or pinned are tried first.
+///          The tags of a remote are only listed when those can't satisfy a
+///          range, or when resolving with them fails. The dependencies of the
+///          given projects are pointed at the selected versions.
+/// @param   cpakfiles The projects whose dependencies to resolve.
+/// @param   lockfile The lockfile whose versions are preferred, if any.
+/// @return  The version selected for every package, and the status code.
+std::tuple<cpak::solver::Selection, std::error_code>
+internalResolveVersions(const vector<CPakFile*>& cpakfiles,
+                        const cpak::Lockfile* lockfile = nullptr) noexcept {
+    namespace solver = cpak::solver;
+    using Loaded     = std::tuple<std::optional<CPakFile>, std::error_code>;
+
+    // The projects being built only come in the version they are at.
+    std::unordered_map<string, const CPakFile*> members;
+    for (const auto* cpakfile : cpakfiles)
+        members[packageOf(cpakfile->project)] = cpakfile;
+
+    std::unordered_map<string, vector<cpak::version>> locked;
+    if (lockfile != nullptr) {
+        for (const auto& [cpakid, _] : lockfile->dependencies) {
+            // Loaded lockfiles are validated, anything else is re-resolved.
+            if (!cpak::parseCPakID(cpakid).isValid()) {
+                logger->warn("Ignoring invalid locked CPakID '{}'", cpakid);
+                continue;
+            }
+
+            const auto identity = cpak::identityFromString(cpakid);
+            locked[packageOf(identity)].push_back(identity.semv);
+        }
+    }
+
+    // Packages are fetched from the remote of the first dependency on them.
+    std::unordered_map<string, Dependency> remotes;
+    std::unordered_map<string, vector<cpak::VersionConstraint>> constraints;
+    std::unordered_map<string, vector<cpak::version>> pinned;
+    const auto requirementsOf = [&](const CPakFile& cpakfile) {
+        vector<solver::Requirement> requirements;
+        for (const auto& dependency : cpakfile.dependencies) {
+            const auto package = packageOf(dependency);
+            remotes.try_emplace(package, vendored(dependency));
+            if (dependency.constraint == std::nullopt)
+                pinned[package].push_back(dependency.semv);
+
+            auto constraint = dependency.constraint.value_or(
+                cpak::VersionConstraint::exactly(dependency.semv));
+            constraints[package].push_back(constraint);
+            requirements.push_back({ package, std::move(constraint) });
+        }
+
+        return requirements;
+    };
+
+    const auto versionOf = [&](const string& package, const cpak::version& semv) {
+        auto dependency = remotes.at(package);
+        dependency.versionIsBranch =
+            dependency.versionIsBranch && dependency.semv == semv;
+        dependency.semv = semv;
+        dependency.constraint.reset();
+        return dependency;
+    };
+
+    // Only the CPakFiles of candidate versions are read, from the mirrors of
+    // their remotes, so rejected versions are never checked out. They're read
+    // on the pool, so the CPakFiles of pinned dependencies can be fetched
+    // while the solver is still looking at the version that needs them.
+    const auto fetches = std::max<std::uint32_t>(
+        config ? config->network.maxConcurrentFetches : 1, 1);
+    util::ThreadPool pool(fetches);
+    std::unordered_map<string, std::shared_future<Loaded>> loads;
+    const auto load = [&](const Dependency& dependency) {
+        const auto cpakid = cpak::identityToString(dependency);
+        if (const auto iter = loads.find(cpakid); iter != loads.end())
+            return iter->second;
+
+        const cpak::LockedDependency* lockedDependency = nullptr;
+        if (lockfile != nullptr) {
+            const auto iter = lockfile->dependencies.find(cpakid);
+            if (iter != lockfile->dependencies.end()) lockedDependency = &iter->second;
+        }
+
+        auto loading = pool.submit([dependency, lockedDependency] {
+            return mgmt::readDependencyCPakFile(dependency, lockedDependency);
+        }).share();
+        loads.emplace(cpakid, loading);
+        return loading;
+    };
+
+    auto refresh = false;
+    std::unordered_set<string> listed;
+    solver::PackageSource source;
+    source.versions = [&](const string& package) {
+        using Versions = std::tuple<vector<cpak::version>, std::error_code>;
+        const auto success = cpak::make_error_code(cpak::errc::success);
+        if (const auto member = members.find(package); member != members.end())
+            return Versions{ { member->second->project.semv }, success };
+
+        const auto& dependency   = remotes.at(package);
+        auto [versions, result]  = mgmt::listVersions(dependency, false);
+        versions.insert(versions.end(), locked[package].begin(), locked[package].end());
+        versions.insert(versions.end(), pinned[package].begin(), pinned[package].end());
+
+        const auto satisfiable = [&](const cpak::VersionConstraint& constraint) {
+            return std::any_of(versions.begin(), versions.end(),
+                [&](const auto& semv) { return constraint.acceptsVersion(semv); });
+        };
+
+        const auto& wanted = constraints[package];
+        if (!refresh && std::all_of(wanted.begin(), wanted.end(), satisfiable))
+            return Versions{ versions, success };
+
+        auto [available, listResult] = mgmt::listVersions(dependency, true);
+        if (listResult.value() != cpak::errc::success) {
+            logger->warn("Could not list the versions of '{}'", package);
+            return Versions{ versions, success };
+        }
+
+        listed.insert(package);
+        versions.insert(versions.end(), available.begin(), available.end());
+        return Versions{ versions, success };
+    };
+
+    source.requirements = [&](const string& package, const cpak::version& semv) {
+        using Requirements = std::tuple<vector<solver::Requirement>, std::error_code>;
+        if (const auto member = members.find(package); member != members.end())
+            return Requirements{ requirementsOf(*member->second),
+                                 cpak::make_error_code(cpak::errc::success) };
+
+        const auto& [cpakfile, result] = load(versionOf(package, semv)).get();
+        if (result.value() != cpak::errc::success)
+            return Requirements{ vector<solver::Requirement>{}, result };
+
+        for (const auto& dependency : cpakfile->dependencies)
+            if (dependency.constraint == std::nullopt &&
+                !members.contains(packageOf(dependency)))
+                load(vendored(dependency));
+
+        return Requirements{ requirementsOf(*cpakfile),
+                             cpak::make_error_code(cpak::errc::success) };
+    };
+
+    source.preferred = [&](const string& package) -> std::optional<cpak::version> {
+        const auto& versions = locked[package];
+        if (versions.empty()) return std::nullopt;
+        return *std::max_element(versions.begin(), versions.end());
+    };
+
+    // A single project is the root itself, several are required by a root.
+    auto root         = string("the projects being built");
+    auto requirements = vector<solver::Requirement>{};
+    if (cpakfiles.size() == 1) {
+        root         = cpak::identityToString(cpakfiles.front()->project);
+        requirements = requirementsOf(*cpakfiles.front());
+    } else {
+        for (const auto* cpakfile : cpakfiles)
+            requirements.push_back(
+                { packageOf(cpakfile->project),
+                  cpak::VersionConstraint::exactly(cpakfile->project.semv) });
+    }
+
+    while (true) {
+        vector<string> explanation;
+        auto [selection, result] =
+            solver::resolve(root, requirements, source, &explanation);
+
+        // What is on disk may just be out of date, so the remotes get a say
+        // before giving up.
+        const auto unlisted = std::any_of(constraints.begin(), constraints.end(),
+            [&](const auto& entry) {
+                return !listed.contains(entry.first) &&
+                       std::any_of(entry.second.begin(), entry.second.end(),
+                           [](const auto& constraint) { return !constraint.isExact(); });
+            });
+
+        if (result.value() == cpak::errc::versionConflict && !refresh && unlisted) {
+            logger->debug("Listing remote versions to resolve the dependencies again");
+            refresh = true;
+            continue;
+        }
+
+        if (result.value() == cpak::errc::versionConflict) {
+            logger->error("Could not select versions of the dependencies:");
+            for (const auto& line : explanation) logger->error("  {}", line);
+        }
+
+        if (result.value() != cpak::errc::success)
+            return { selection, result }; // Let the caller handle the error.
+
+        for (auto* cpakfile : cpakfiles) applySelection(*cpakfile, selection);
+        return { selection, result };
+    }
+}
+
+
+std::error_code
+internalLoadDependencies(const vector<const CPakFile*>& cpakfiles,
+                         cpak::Lockfile* lockfile,
+                         const cpak::solver::Selection& selection) noexcept {
+    // Every dependency is loaded once, no matter how many projects use it.
+    auto& registry = cpak::ProjectRegistry::shared();
+    std::vector<std::pair<cpak::ProjectHandle, const Dependency*>> pending;
+    const auto discover = [&](const CPakFile& dependent) {
+        for (const auto& dependency : dependent.dependencies) {
+            const auto [handle, reserved] = registry.reserve(dependency);
+            if (reserved) pending.emplace_back(handle, &dependency);
+        }
+    };
+
+    // Walk the graph a level at a time, loading every dependency of a level
+    // concurrently. Each worker runs at most one clone at a time, so the size
+    // of the pool bounds the network operations in flight.
+    const auto fetches = std::max<std::uint32_t>(
+        config ? config->network.maxConcurrentFetches : 1, 1);
+    util::ThreadPool pool(fetches);
+
+    for (const auto* cpakfile : cpakfiles) discover(*cpakfile);
+    while (!pending.empty()) {
+        const auto level = std::move(pending);
+        pending.clear();
+
+        // Locked dependencies are checked out at the recorded commit, every
+        // dependency has the commit it resolved to recorded back.
+        std::vector<std::optional<CPakFile>> loaded(level.size());
+        std::vector<std::optional<cpak::LockedDependency>> locks(level.size());
+        std::vector<std::error_code> results(level.size());
+        pool.forEach(level.size(), [&](std::size_t index) {
+            const auto& dependency = *level[index].second;
+            const cpak::LockedDependency* locked = nullptr;
+            if (lockfile != nullptr) {
+                const auto iter = lockfile->dependencies.find(
+                    cpak::identityToString(dependency));
+                if (iter != lockfile->dependencies.end()) locked = &iter->second;
+            }
+
+            std::tie(loaded[index], results[index]) =
+                mgmt::loadDependency(vendored(dependency), locked);
+            if (lockfile != nullptr && loaded[index] != std::nullopt)
+                locks[index] = std::get<0>(
+                    mgmt::lockDependency(loaded[index]->projectPath));
+        });
+
+        for (auto index = 0u; index < level.size(); ++index) {
+            if (results[index].value() != cpak::errc::success)
+                return results[index]; // Let the caller handle the error.
+
+            applySelection(*loaded[index], selection);
+            if (locks[index] != std::nullopt) {
+                const auto cpakid = cpak::identityToString(*level[index].second);
+                lockfile->dependencies[cpakid] = *locks[index];
+            }
+
+            const auto& stored =
+                registry.store(level[index].first, std::move(*loaded[index]));
+
+            const auto result = registerInterfaces(stored);
+            if (result.value() != cpak::errc::success)
+                return result; // Let the caller handle the error.
+
+            discover(stored);
+        }
+    }
+
+    return cpak::make_error_code(cpak::errc::success);
 }
 
 
 std::error_code
-internalLoadDependencies(const CPakFile& cpakfile) noexcept {
-    for (const auto& dependency : cpakfile.dependencies) {
-        const auto cpakid          = cpak::identityToString(dependency);
-        auto [optCPakFile, result] = mgmt::loadDependency(dependency);
+internalLoadDependencies(const CPakFile& cpakfile,
+                         cpak::Lockfile* lockfile,
+                         const cpak::solver::Selection& selection) noexcept {
+    return internalLoadDependencies(vector<const CPakFile*>{ &cpakfile }, lockfile,
+                                    selection);
+}
+
+
+/// @brief  Loads the lockfile next to a project or workspace.
+/// @param  lockfilePath The path of the lockfile.
+/// @return The lockfile, empty if there is none yet, and the status code.
+std::tuple<cpak::Lockfile, std::error_code>
+internalLoadLockfile(const fs::path& lockfilePath) noexcept {
+    auto [lockfile, result] = mgmt::loadLockfile(lockfilePath);
+    if (result.value() == cpak::errc::pathDoesNotExist)
+        return { cpak::Lockfile{}, cpak::make_error_code(cpak::errc::success) };
+
+    return { lockfile.value_or(cpak::Lockfile{}), result };
+}
+
+
+/// @brief  Writes the revisions the dependencies resolved to.
+/// @param  lockfilePath The path of the lockfile.
+/// @param  lockfile The lockfile updated while loading the dependencies.
+/// @param  prune Whether to drop the dependencies that were not loaded.
+void
+internalSaveLockfile(const fs::path& lockfilePath,
+                     cpak::Lockfile& lockfile,
+                     bool prune) noexcept {
+    if (prune) {
+        const auto& registry = cpak::ProjectRegistry::shared();
+        std::erase_if(lockfile.dependencies, [&](const auto& entry) {
+            return !cpak::parseCPakID(entry.first).isValid() ||
+                   registry.get(cpak::identityFromString(entry.first)) == nullptr;
+        });
+    }
+
+    if (mgmt::saveLockfile(lockfilePath, lockfile).value() != cpak::errc::success)
+        logger->warn("Failed to write '{}'", lockfilePath.c_str());
+}
+
+
+std::error_code
+handleWorkspaceBuild(const fs::path& workspacePath) noexcept {
+    auto [workspace, result] = mgmt::loadWorkspace(workspacePath);
+    if (result.value() != cpak::errc::success)
+        return result; // Let the caller handle the error.
+
+    vector<fs::path> memberPaths;
+    for (const auto& member : workspace->members) {
+        std::error_code status;
+        memberPaths.push_back(fs::canonical(workspacePath / member, status));
+        if (!status) continue;
+
+        logger->error("Workspace member '{}' does not exist", member);
+        return cpak::make_error_code(cpak::errc::pathDoesNotExist);
+    }
+
+    // Members don't know about each other until they're loaded, so they're
+    // all loaded at once.
+    vector<std::optional<CPakFile>> members(memberPaths.size());
+    vector<std::error_code> results(memberPaths.size());
+    util::ThreadPool::shared().forEach(memberPaths.size(), [&](std::size_t index) {
+        std::tie(members[index], results[index]) =
+            internalLoadCPakFile(memberPaths[index]);
+    });
+
+    vector<CPakFile*> loaded;
+    for (auto index = 0u; index < members.size(); ++index) {
+        if (results[index].value() != cpak::errc::success)
+            return results[index]; // Let the caller handle the error.
+
+        loaded.push_back(&*members[index]);
+    }
+
+    const auto lockfilePath = workspacePath / "CPakWorkspace.lock";
+    auto [lockfile, lockResult] = internalLoadLockfile(lockfilePath);
+    if (lockResult.value() != cpak::errc::success)
+        return lockResult; // Let the caller handle the error.
+
+    // Every member gets the same version of a shared dependency.
+    auto [selection, resolveResult] = internalResolveVersions(loaded, &lockfile);
+    if (resolveResult.value() != cpak::errc::success)
+        return resolveResult; // Let the caller handle the error.
+
+    // Members are registered like dependencies, so members that depend on
+    // each other use the member instead of fetching it.
+    auto& registry = cpak::ProjectRegistry::shared();
+    vector<cpak::ProjectHandle> handles;
+    vector<const CPakFile*> cpakfiles;
+    for (auto index = 0u; index < members.size(); ++index) {
+        const auto& project           = members[index]->project;
+        const auto [handle, reserved] = registry.reserve(project);
+        if (!reserved) {
+            logger->error("Workspace lists project '{}' more than once",
+                          cpak::identityToString(project));
+            return cpak::make_error_code(cpak::errc::invalidWorkspace);
+        }
+
+        const auto& member = registry.store(handle, std::move(*members[index]));
+        result = registerInterfaces(member);
         if (result.value() != cpak::errc::success)
             return result; // Let the caller handle the error.
 
-        dependencyCache[cpakid] = &optCPakFile.value();
-        internalLoadDependencies(optCPakFile.value());
+        handles.push_back(handle);
+        cpakfiles.push_back(&member);
     }
 
-    return cpak::make_error_code(cpak::errc::success);
+    result = internalLoadDependencies(cpakfiles, &lockfile, selection);
+    if (result.value() != cpak::errc::success)
+        return result; // Let the caller handle the error.
+
+    internalSaveLockfile(lockfilePath, lockfile, true);
+
+    // Members queued as the dependency of an earlier member are skipped.
+    for (const auto handle : handles) {
+        if (!registry.claimBuild(handle)) continue;
+
+        result = cpak::queueForBuild(*registry.get(handle));
+        if (result.value() != cpak::errc::success)
+            return result; // Let the caller handle the error.
+    }
+
+    result = cpak::executeBuild();
+    auto& hashes = cpak::cache::FileHashCache::shared();
+    if (hashes.save().value() != cpak::errc::success)
+        logger->warn("Failed to save file hash cache");
+
+    return result;
 }
 
 
 std::error_code
 handleBuildCommand() noexcept {
+    std::error_code status;
     const auto pathStr     = buildcmd->get("path");
     const auto projectPath = pathStr.empty()
         ? std::filesystem::current_path()
-        : fs::canonical(pathStr);
+        : fs::canonical(pathStr, status);
+    if (status) {
+        // Targets follow the path, so a lone target name lands here.
+        logger->error("Project directory '{}' does not exist", pathStr);
+        logger->info("To build a target, use 'cpak build . {}'", pathStr);
+        return cpak::make_error_code(cpak::errc::pathDoesNotExist);
+    }
 
-    auto [optCPakFile, result] = internalLoadCPakFile(projectPath);
+    if (buildcmd->is_used("--vendor")) {
+        vendorPath = fs::canonical(buildcmd->get("--vendor"), status);
+        if (status) {
+            logger->error("Vendor directory '{}' does not exist",
+                          buildcmd->get("--vendor"));
+            return cpak::make_error_code(cpak::errc::pathDoesNotExist);
+        }
+    }
+
+    if (fs::exists(projectPath / "CPakWorkspace")) {
+        if (buildcmd->is_used("targets")) {
+            logger->error("Targets cannot be selected when building a workspace");
+            return cpak::make_error_code(cpak::errc::failure);
+        }
+
+        return handleWorkspaceBuild(projectPath);
+    }
+
+    const auto targets = buildcmd->present<vector<string>>("targets")
+                             .value_or(vector<string>{});
+
+    auto [optCPakFile, result] = internalLoadCPakFile(projectPath, targets.empty());
+    if (result.value() != cpak::errc::success)
+        return result; // Let the caller handle the error.
+
+    // Only the requested targets and what they need are built. Dependencies
+    // are only fetched when the selection references something the project
+    // does not provide.
+    auto& cpakfile = optCPakFile.value();
+    auto unresolved = vector<cpak::InternedString>{};
+    if (!targets.empty()) {
+        std::tie(unresolved, result) = cpak::selectTargets(cpakfile, targets);
+        if (result.value() != cpak::errc::success)
+            return result; // Let the caller handle the error.
+
+        if (unresolved.empty()) cpakfile.dependencies.clear();
+    }
+
+    result = registerInterfaces(cpakfile);
     if (result.value() != cpak::errc::success)
         return result; // Let the caller handle the error.
 
-    result = internalLoadDependencies(optCPakFile.value());
+    const auto lockfilePath = projectPath / "CPakFile.lock";
+    auto [lockfile, lockResult] = internalLoadLockfile(lockfilePath);
+    if (lockResult.value() != cpak::errc::success)
+        return lockResult; // Let the caller handle the error.
+
+    auto [selection, resolveResult] = internalResolveVersions({ &cpakfile }, &lockfile);
+    if (resolveResult.value() != cpak::errc::success)
+        return resolveResult; // Let the caller handle the error.
+
+    result = internalLoadDependencies(cpakfile, &lockfile, selection);
     if (result.value() != cpak::errc::success)
         return result; // Let the caller handle the error.
 
-    result = cpak::queueForBuild(optCPakFile.value());
+    // Only a build of every target knows which locked dependencies are unused.
+    if (!cpakfile.dependencies.empty() || targets.empty())
+        internalSaveLockfile(lockfilePath, lockfile, targets.empty());
+
+    if (!targets.empty()) cpak::selectDependencies(cpakfile, unresolved);
+    result = cpak::queueForBuild(cpakfile);
     if (result.value() != cpak::errc::success)
         return result; // Let the caller handle the error.
 
-    return cpak::executeBuild();
+    result = cpak::executeBuild();
+    auto& hashes = cpak::cache::FileHashCache::shared();
+    if (hashes.save().value() != cpak::errc::success)
+        logger->warn("Failed to save file hash cache");
+
+    return result;
+}
+
+
+/// @brief  Checks that an ID given to pull is a valid CPakID.
+/// @param  id The ID to check.
+/// @param  useBranch Whether the version of the ID is a branch name.
+/// @param  origin Where the ID was given, used when reporting it.
+/// @return True if the ID is valid, otherwise false.
+bool
+validatePullID(string_view id, bool useBranch, string_view origin) noexcept {
+    const auto parsed = cpak::parseCPakID(id, useBranch);
+    if (parsed.isValid()) return true;
+
+    logger->error("Invalid project ID '{}' {}, {} at column {}", id, origin,
+                  parsed.error, parsed.errorPosition + 1);
+    return false;
+}
+
+
+/// @brief  Reads the IDs to pull from a file, one per line.
+/// @param  listPath The file listing the IDs.
+/// @param  useBranch Whether the versions of the IDs are branch names.
+/// @return The IDs in the file and the status code for the operation.
+std::tuple<vector<string>, std::error_code>
+readPullList(const fs::path& listPath, bool useBranch) noexcept {
+    std::ifstream listStream(listPath);
+    if (!listStream.is_open()) {
+        logger->error("Could not read the IDs to pull from '{}'", listPath.c_str());
+        return { vector<string>{}, cpak::make_error_code(cpak::errc::pathDoesNotExist) };
+    }
+
+    // One ID per line, blank lines and comments are skipped.
+    vector<string> ids;
+    auto lineNumber = 0u;
+    for (string line; std::getline(listStream, line);) {
+        ++lineNumber;
+        line = util::trim(std::move(line));
+        if (line.empty() || line.front() == '#') continue;
+
+        const auto origin =
+            fmt::format("on line {} of '{}'", lineNumber, listPath.c_str());
+        if (!validatePullID(line, useBranch, origin))
+            return { vector<string>{}, cpak::make_error_code(cpak::errc::failure) };
+
+        ids.push_back(std::move(line));
+    }
+
+    return { ids, cpak::make_error_code(cpak::errc::success) };
+}
+
+
+/// @brief  Turns validated IDs into identities, dropping repeated projects.
+/// @param  ids The IDs to pull, already validated.
+/// @param  useBranch Whether the versions of the IDs are branch names.
+/// @return The identities in the order they were first given.
+vector<cpak::Identity>
+uniquePullIdentities(const vector<string>& ids, bool useBranch) noexcept {
+    std::unordered_set<string> seen;
+    vector<cpak::Identity> identities;
+    for (const auto& id : ids) {
+        auto identity = cpak::identityFromString(id, useBranch);
+        if (seen.insert(cpak::identityToString(identity)).second)
+            identities.push_back(std::move(identity));
+    }
+
+    return identities;
 }
 
 
@@ -350,11 +942,28 @@ handlePullCommand() noexcept {
 
     pulling = true;
 
-    // TODO: allow for custom remote addresses.
+    // Every ID is checked before anything is fetched.
     const auto versionIsBranch = pullcmd->get<bool>("--branch");
-    const auto cpakid =
-        cpak::identityFromString(pullcmd->get("id"), versionIsBranch);
+    auto ids = pullcmd->get<vector<string>>("ids");
+    for (const auto& id : ids)
+        if (!validatePullID(id, versionIsBranch, "on the command line"))
+            return cpak::make_error_code(cpak::errc::failure);
+
+    if (pullcmd->is_used("--file")) {
+        const auto [listed, result] =
+            readPullList(pullcmd->get("--file"), versionIsBranch);
+        if (result.value() != cpak::errc::success)
+            return result; // Let the caller handle the error.
 
+        ids.insert(ids.end(), listed.begin(), listed.end());
+    }
+
+    if (ids.empty()) {
+        logger->error("No project IDs to pull");
+        return cpak::make_error_code(cpak::errc::failure);
+    }
+
+    // TODO: allow for custom remote addresses.
     const auto remote = cpak::Repository{
         .address  = "https://github.com"s,
         .username = ""s,
@@ -362,39 +971,104 @@ handlePullCommand() noexcept {
         .password = ""s,
     };
 
-    // Build dependency manually.
-    auto dependency            = cpak::Dependency{};
-    dependency.name            = cpakid.name;
-    dependency.gpid            = cpakid.gpid;
-    dependency.semv            = cpakid.semv;
-    dependency.remote          = remote;
-    dependency.versionIsBranch = cpakid.versionIsBranch;
-
-    // Clone the dependency.
-    std::error_code result;
-    std::filesystem::path dependencyPath;
-    std::optional<CPakFile> cpakfile;
-
-    std::tie(dependencyPath, result) = mgmt::findDependencyPath(dependency);
-
-    // Dependency already exists.
-    if (result.value() == cpak::errc::success &&
-        !pullcmd->get<bool>("--update"))
-        return result;
-
-    // TODO: Create function specifically for the operation of loading and
-    // building.
-    //       Both pull and the actual build command rely on this functionality.
-    std::tie(cpakfile, result) =
-        mgmt::cloneDependency(dependency, dependencyPath);
-    if (result.value() != cpak::errc::success)
-        return result; // Let the caller handle the error.
+    // Build dependencies manually, projects that are already pulled are only
+    // fetched again when updating.
+    const auto update = pullcmd->get<bool>("--update");
+    vector<std::pair<Dependency, fs::path>> fetching;
+    for (const auto& cpakid : uniquePullIdentities(ids, versionIsBranch)) {
+        auto dependency            = cpak::Dependency{};
+        dependency.name            = cpakid.name;
+        dependency.gpid            = cpakid.gpid;
+        dependency.semv            = cpakid.semv;
+        dependency.remote          = remote;
+        dependency.versionIsBranch = cpakid.versionIsBranch;
+
+        const auto [dependencyPath, result] = mgmt::findDependencyPath(dependency);
+        if (result.value() == cpak::errc::success && !update) {
+            logger->info("Project '{}' is already pulled",
+                         cpak::identityToString(cpakid));
+            continue;
+        }
+
+        fetching.emplace_back(std::move(dependency), dependencyPath);
+    }
+
+    if (fetching.empty()) return cpak::make_error_code(cpak::errc::success);
+
+    // Every project is fetched before any of them is built, a failed fetch
+    // does not stop the others.
+    const auto fetches = std::max<std::uint32_t>(
+        pullcmd->present<std::uint32_t>("--jobs").value_or(
+            config ? config->network.maxConcurrentFetches : 1), 1);
+    util::ThreadPool pool(fetches);
+
+    std::atomic<std::size_t> finished{ 0 };
+    vector<std::optional<CPakFile>> pulled(fetching.size());
+    vector<std::error_code> results(fetching.size());
+    logger->info("Pulling {} projects, {} at a time", fetching.size(), fetches);
+    pool.forEach(fetching.size(), [&](std::size_t index) {
+        const auto& [dependency, dependencyPath] = fetching[index];
+        std::tie(pulled[index], results[index]) =
+            mgmt::cloneDependency(dependency, dependencyPath);
+
+        const auto succeeded = results[index].value() == cpak::errc::success;
+        logger->info("[{}/{}] {} '{}'", ++finished, fetching.size(),
+                     succeeded ? "Pulled" : "Failed to pull",
+                     cpak::identityToString(dependency));
+    });
+
+    const auto failed = [](const std::error_code& result) {
+        return result.value() != cpak::errc::success;
+    };
+
+    const auto failure = std::find_if(results.begin(), results.end(), failed);
+    if (failure != results.end()) {
+        logger->error("Failed to pull {} of {} projects",
+                      std::count_if(results.begin(), results.end(), failed),
+                      fetching.size());
+        return *failure; // Let the caller handle the error.
+    }
 
-    result = cpak::queueForBuild(cpakfile.value());
+    // The pulled projects and everything they depend on are built together.
+    vector<CPakFile*> resolving;
+    for (auto& cpakfile : pulled) resolving.push_back(&*cpakfile);
+
+    auto [selection, resolveResult] = internalResolveVersions(resolving);
+    if (resolveResult.value() != cpak::errc::success)
+        return resolveResult; // Let the caller handle the error.
+
+    auto& registry = cpak::ProjectRegistry::shared();
+    vector<cpak::ProjectHandle> handles;
+    vector<const CPakFile*> cpakfiles;
+    for (auto index = 0u; index < pulled.size(); ++index) {
+        const auto [handle, reserved] = registry.reserve(fetching[index].first);
+        const auto& cpakfile = registry.store(handle, std::move(*pulled[index]));
+        const auto result    = registerInterfaces(cpakfile);
+        if (result.value() != cpak::errc::success)
+            return result; // Let the caller handle the error.
+
+        handles.push_back(handle);
+        cpakfiles.push_back(&cpakfile);
+    }
+
+    auto result = internalLoadDependencies(cpakfiles, nullptr, selection);
     if (result.value() != cpak::errc::success)
         return result; // Let the caller handle the error.
 
-    return cpak::executeBuild();
+    for (const auto handle : handles) {
+        if (!registry.claimBuild(handle)) continue;
+
+        result = cpak::queueForBuild(*registry.get(handle));
+        if (result.value() != cpak::errc::success)
+            return result; // Let the caller handle the error.
+    }
+
+    result = cpak::executeBuild();
+    auto& hashes = cpak::cache::FileHashCache::shared();
+    if (hashes.save().value() != cpak::errc::success)
+        logger->warn("Failed to save file hash cache");
+
+    return result;
 }
 
 
@@ -409,7 +1083,76 @@ handleInstallCommand() noexcept {
     if (result.value() != cpak::errc::success)
         return result; // Let the caller handle the error.
 
-    return cpak::installProject(optCPakFile.value());
+    result = registerInterfaces(optCPakFile.value());
+    if (result.value() != cpak::errc::success)
+        return result; // Let the caller handle the error.
+
+    result = cpak::installProject(optCPakFile.value());
+    auto& hashes = cpak::cache::FileHashCache::shared();
+    if (hashes.save().value() != cpak::errc::success)
+        logger->warn("Failed to save file hash cache");
+
+    return result;
+}
+
+
+std::error_code
+handleVendorCommand() noexcept {
+    const auto pathStr     = vendorcmd->get("path");
+    const auto projectPath = pathStr.empty()
+        ? std::filesystem::current_path()
+        : fs::canonical(pathStr);
+    const auto outputPath = fs::absolute(
+        vendorcmd->present("--output").value_or((projectPath / "vendor").string()));
+
+    auto [optCPakFile, result] = internalLoadCPakFile(projectPath);
+    if (result.value() != cpak::errc::success)
+        return result; // Let the caller handle the error.
+
+    // Dependencies are resolved and locked as they would be for a build, so a
+    // build from the vendor directory finds the same versions.
+    auto& cpakfile          = optCPakFile.value();
+    const auto lockfilePath = projectPath / "CPakFile.lock";
+    auto [lockfile, lockResult] = internalLoadLockfile(lockfilePath);
+    if (lockResult.value() != cpak::errc::success)
+        return lockResult; // Let the caller handle the error.
+
+    auto [selection, resolveResult] = internalResolveVersions({ &cpakfile }, &lockfile);
+    if (resolveResult.value() != cpak::errc::success)
+        return resolveResult; // Let the caller handle the error.
+
+    result = internalLoadDependencies(cpakfile, &lockfile, selection);
+    if (result.value() != cpak::errc::success)
+        return result; // Let the caller handle the error.
+
+    internalSaveLockfile(lockfilePath, lockfile, true);
+
+    // Every dependency in the graph is copied from the checkout it was loaded
+    // from.
+    const auto& registry = cpak::ProjectRegistry::shared();
+    std::map<string, const Dependency*> dependencies;
+    const auto collect = [&](const CPakFile& dependent) {
+        for (const auto& dependency : dependent.dependencies)
+            dependencies.try_emplace(cpak::identityToString(dependency), &dependency);
+    };
+
+    collect(cpakfile);
+    registry.forEach([&](cpak::ProjectHandle, const CPakFile& stored) {
+        collect(stored);
+    });
+
+    for (const auto& [cpakid, dependency] : dependencies) {
+        const auto* stored = registry.get(*dependency);
+        result = mgmt::vendorDependency(*dependency, stored->projectPath, outputPath);
+        if (result.value() != cpak::errc::success) {
+            logger->error("Failed to vendor '{}'", cpakid);
+            return result; // Let the caller handle the error.
+        }
+    }
+
+    logger->info("Vendored {} dependencies into '{}'", dependencies.size(),
+                 outputPath.c_str());
+    return cpak::make_error_code(cpak::errc::success);
 }
 
 
@@ -421,6 +1164,7 @@ cpak::application::init() noexcept {
     initBuildCommand();
     initPullCommand();
     initInstallCommand();
+    initVendorCommand();
 
     spdlog::register_logger(logger);
     return cpak::make_error_code(errc::success);
@@ -456,6 +1200,10 @@ cpak::application::run(const vector<string>& arguments) noexcept {
         commandString = "install";
         commandStatus = handleInstallCommand();
         return commandStatus;
+    } else if (program->is_subcommand_used("vendor")) {
+        commandString = "vendor";
+        commandStatus = handleVendorCommand();
+        return commandStatus;
     }
 
     if (commandStatus.value() != cpak::errc::success) {
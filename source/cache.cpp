@@ -0,0 +1,395 @@
+#include "cache.hpp"
+#include "cpakfile.hpp"
+#include "errorcode.hpp"
+#include "utilities/compression.hpp"
+#include "utilities/fingerprint.hpp"
+#include "utilities/fsopts.hpp"
+
+
+namespace fs   = std::filesystem;
+namespace util = cpak::utilities;
+
+using cpak::BuildTarget;
+using cpak::CPakFile;
+using cpak::cache::FileHashCache;
+using cpak::cache::FileStamp;
+using util::Compression;
+using util::Hash128;
+using util::ThreadPool;
+using std::string;
+using std::string_view;
+using std::vector;
+
+
+constexpr string_view kFileHashMagic = "CPKH\x01";
+
+
+/// @brief  Gets the path of the link cache entry for the given key.
+/// @param  key The key of the entry.
+/// @param  compressed Whether to get the path of the compressed entry.
+/// @return The path of the entry, sharded by the first two key characters.
+fs::path
+linkEntryPath(string_view key, bool compressed) noexcept {
+    auto entryPath = cpak::cache::cacheRootPath() / "links" /
+                     string(key.substr(0, 2)) / string(key);
+    if (compressed) entryPath += ".lz";
+    return entryPath;
+}
+
+
+/// @brief  Decompresses a cache entry into the output path.
+/// @param  entryPath The compressed entry.
+/// @param  outputPath Where to write the decompressed output.
+/// @return True if the entry was decompressed, otherwise false.
+bool
+decompressEntry(const fs::path& entryPath, const fs::path& outputPath) noexcept {
+    std::error_code error;
+    fs::remove(outputPath, error);
+
+    std::ifstream input(entryPath, std::ios::binary);
+    std::ofstream output(outputPath, std::ios::binary | std::ios::trunc);
+    if (!input.is_open() || !output.is_open()) return false;
+    if (!Compression::decompress(input, output)) {
+        output.close();
+        fs::remove(outputPath, error);
+        return false;
+    }
+
+    // Entries keep the permissions of the output they were created from.
+    output.close();
+    fs::permissions(outputPath, fs::status(entryPath).permissions(), error);
+    return !error;
+}
+
+
+/// @brief  Compresses an output into a cache entry.
+/// @param  outputPath The output to compress.
+/// @param  entryPath Where to write the compressed entry.
+/// @param  level The level to compress with.
+/// @return True if the entry was written, otherwise false.
+bool
+compressEntry(const fs::path& outputPath,
+              const fs::path& entryPath,
+              std::uint32_t level) noexcept {
+    std::error_code error;
+    std::ifstream input(outputPath, std::ios::binary);
+    std::ofstream output(entryPath, std::ios::binary | std::ios::trunc);
+    if (!input.is_open() || !output.is_open()) return false;
+    if (!Compression::compress(input, output, level)) return false;
+
+    output.close();
+    fs::permissions(entryPath, fs::status(outputPath).permissions(), error);
+    return !error;
+}
+
+
+/// @brief  Reads the stamp of a file.
+/// @param  path The file to read the stamp of.
+/// @return The stamp, or nothing if the file could not be inspected.
+std::optional<FileStamp>
+readFileStamp(const fs::path& path) noexcept {
+#if defined(__unix__) || defined(__APPLE__)
+    struct stat info;
+    if (::stat(path.c_str(), &info) != 0 || !S_ISREG(info.st_mode))
+        return std::nullopt;
+
+#if defined(__APPLE__)
+    const auto& modified = info.st_mtimespec;
+    const auto& changed  = info.st_ctimespec;
+#else
+    const auto& modified = info.st_mtim;
+    const auto& changed  = info.st_ctim;
+#endif
+
+    return FileStamp{
+        .device     = static_cast<std::uint64_t>(info.st_dev),
+        .inode      = static_cast<std::uint64_t>(info.st_ino),
+        .size       = static_cast<std::uint64_t>(info.st_size),
+        .modifiedNs = modified.tv_sec * 1'000'000'000LL + modified.tv_nsec,
+        .changedNs  = changed.tv_sec * 1'000'000'000LL + changed.tv_nsec,
+    };
+#else
+    return std::nullopt;
+#endif
+}
+
+
+fs::path
+cpak::cache::cacheRootPath() noexcept {
+    return CPakFile::rootInstallPath() / "cache";
+}
+
+
+string
+cpak::cache::toolchainFingerprint(string_view compiler) noexcept {
+    fs::path resolved(compiler);
+    const auto* searchPath = std::getenv("PATH");
+    if (resolved.is_relative() && searchPath != nullptr) {
+        std::istringstream paths(searchPath);
+        string directory;
+        while (std::getline(paths, directory, ':')) {
+            const auto candidate = fs::path(directory) / compiler;
+            if (fs::is_regular_file(candidate)) {
+                resolved = candidate;
+                break;
+            }
+        }
+    }
+
+    // An unknown compiler is only fingerprinted by its name.
+    std::error_code error;
+    resolved = fs::canonical(resolved, error);
+    if (error) return string(compiler);
+
+    const auto [digest, result] = FileHashCache::shared().hash(resolved);
+    return fmt::format("{}:{}", resolved.string(), digest);
+}
+
+
+string
+cpak::cache::targetFingerprint(const BuildTarget& target,
+                               const vector<string>& arguments) noexcept {
+    const auto update = [](Hash128& hash, string_view value) {
+        Hash128::update(hash, value);
+        Hash128::update(hash, string_view("\0", 1));
+    };
+
+    Hash128 hash("");
+    update(hash, target.name.view());
+    update(hash, buildTypeName(target.type));
+    for (const auto& [name, value] : target.referencedOptions) {
+        update(hash, name);
+        update(hash, value);
+    }
+
+    for (const auto& argument : arguments) update(hash, argument);
+    if (!arguments.empty()) update(hash, toolchainFingerprint(arguments[0]));
+
+    Hash128::block_t block;
+    Hash128::finalize(hash, block);
+    return ::util::digestToString(block);
+}
+
+
+std::tuple<std::string, std::error_code>
+cpak::cache::linkCacheKey(const vector<string>& arguments,
+                          const vector<fs::path>& inputs) noexcept {
+    // Keys never leave the machine, so the fast hash is good enough.
+    Hash128 hash("");
+    for (const auto& argument : arguments) {
+        Hash128::update(hash, argument);
+        Hash128::update(hash, string_view("\0", 1));
+    }
+
+    // Inputs are hashed in parallel, unchanged ones are never read, and
+    // contribute their digests in command line order.
+    vector<string> digests(inputs.size());
+    vector<std::error_code> results(inputs.size());
+    ThreadPool::shared().forEach(inputs.size(), [&](std::size_t index) {
+        std::tie(digests[index], results[index]) =
+            FileHashCache::shared().hash(inputs[index]);
+    });
+
+    Hash128::block_t block;
+    for (auto index = 0u; index < inputs.size(); ++index) {
+        if (results[index].value() != errc::success)
+            return std::make_tuple(string(), results[index]);
+
+        Hash128::update(hash, digests[index]);
+    }
+
+    Hash128::finalize(hash, block);
+    return std::make_tuple(::util::digestToString(block),
+                           make_error_code(errc::success));
+}
+
+
+std::error_code
+cpak::cache::restoreLinkOutput(string_view key,
+                               const fs::path& outputPath) noexcept {
+    const auto compressedPath = linkEntryPath(key, true);
+    if (fs::exists(compressedPath))
+        return decompressEntry(compressedPath, outputPath)
+            ? make_error_code(errc::success)
+            : make_error_code(errc::cacheMiss);
+
+    const auto entryPath = linkEntryPath(key, false);
+    if (!fs::exists(entryPath))
+        return make_error_code(errc::cacheMiss);
+
+    // Post-link steps such as strip, objcopy or ar may rewrite the output in
+    // place, so it must never share an inode with the cache entry.
+    const auto method = ::util::cloneFile(entryPath, outputPath, false);
+    if (method == ::util::CloneMethod::eNone)
+        return make_error_code(errc::cacheMiss);
+
+    return make_error_code(errc::success);
+}
+
+
+std::error_code
+cpak::cache::storeLinkOutput(string_view key,
+                             const fs::path& outputPath,
+                             std::uint32_t compressionLevel) noexcept {
+    std::error_code error;
+    const auto entryPath = linkEntryPath(key, compressionLevel != 0);
+    fs::create_directories(entryPath.parent_path(), error);
+    if (error) return make_error_code(errc::cacheStoreFailed);
+
+    // Write next to the entry and rename, so readers never see partial files.
+    auto temporaryPath = entryPath;
+    temporaryPath += fmt::format(
+        ".{}.tmp", std::chrono::steady_clock::now().time_since_epoch().count());
+
+    const auto written = compressionLevel != 0
+        ? compressEntry(outputPath, temporaryPath, compressionLevel)
+        : ::util::cloneFile(outputPath, temporaryPath, false) !=
+              ::util::CloneMethod::eNone;
+    if (written) fs::rename(temporaryPath, entryPath, error);
+    if (!written || error) {
+        fs::remove(temporaryPath, error);
+        return make_error_code(errc::cacheStoreFailed);
+    }
+
+    return make_error_code(errc::success);
+}
+
+
+FileHashCache::FileHashCache(fs::path storePath,
+                             std::chrono::nanoseconds racyWindow) noexcept
+    : storePath_(std::move(storePath))
+    , racyWindowNs_(racyWindow.count()) {
+    load();
+}
+
+
+FileHashCache&
+FileHashCache::shared() noexcept {
+    static FileHashCache cache(cacheRootPath() / "filehashes");
+    return cache;
+}
+
+
+std::tuple<std::string, std::error_code>
+FileHashCache::hash(const fs::path& path) noexcept {
+    const auto stamp = readFileStamp(path);
+    if (stamp.has_value()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto iter = entries_.find({ stamp->device, stamp->inode });
+        if (iter != entries_.end() && iter->second.stamp == *stamp &&
+            stamp->modifiedNs < iter->second.hashedAtNs - racyWindowNs_ &&
+            stamp->changedNs < iter->second.hashedAtNs - racyWindowNs_) {
+            iter->second.used = true;
+            return std::make_tuple(::util::digestToString(iter->second.digest),
+                                   make_error_code(errc::success));
+        }
+    }
+
+    const auto hashedAt = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    const auto [digest, result] = ::util::hashFileTree<Hash128>(path);
+    if (result.value() != errc::success)
+        return std::make_tuple(string(), result);
+
+    // The stamp is read again so a write during hashing is never recorded.
+    std::lock_guard<std::mutex> lock(mutex_);
+    readCount_++;
+    if (stamp.has_value() && readFileStamp(path) == stamp) {
+        entries_[{ stamp->device, stamp->inode }] = {
+            .stamp      = *stamp,
+            .hashedAtNs = hashedAt,
+            .digest     = digest,
+            .used       = true,
+        };
+
+        dirty_ = true;
+    }
+
+    return std::make_tuple(::util::digestToString(digest),
+                           make_error_code(errc::success));
+}
+
+
+std::error_code
+FileHashCache::save() noexcept {
+    constexpr std::size_t kMaxEntries = 1 << 18;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!dirty_) return make_error_code(errc::success);
+
+    // Entries of files that are gone are only dropped once the cache grows
+    // large, by forgetting whatever this run did not look at.
+    if (entries_.size() > kMaxEntries)
+        std::erase_if(entries_, [](const auto& item) {
+            return !item.second.used;
+        });
+
+    std::error_code error;
+    fs::create_directories(storePath_.parent_path(), error);
+    if (error) return make_error_code(errc::cacheStoreFailed);
+
+    auto temporaryPath = storePath_;
+    temporaryPath += fmt::format(
+        ".{}.tmp", std::chrono::steady_clock::now().time_since_epoch().count());
+
+    std::ofstream stream(temporaryPath, std::ios::binary | std::ios::trunc);
+    const std::uint64_t count = entries_.size();
+    stream.write(kFileHashMagic.data(), kFileHashMagic.size());
+    stream.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    for (const auto& [key, entry] : entries_) {
+        stream.write(reinterpret_cast<const char*>(&entry.stamp),
+                     sizeof(entry.stamp));
+        stream.write(reinterpret_cast<const char*>(&entry.hashedAtNs),
+                     sizeof(entry.hashedAtNs));
+        stream.write(reinterpret_cast<const char*>(entry.digest.data()),
+                     entry.digest.size());
+    }
+
+    stream.close();
+    if (stream) fs::rename(temporaryPath, storePath_, error);
+    if (!stream || error) {
+        fs::remove(temporaryPath, error);
+        return make_error_code(errc::cacheStoreFailed);
+    }
+
+    dirty_ = false;
+    return make_error_code(errc::success);
+}
+
+
+std::size_t
+FileHashCache::readCount() const noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return readCount_;
+}
+
+
+void
+FileHashCache::load() noexcept {
+    // The store is a local cache in host byte order, anything that does not
+    // look right is simply ignored and rebuilt.
+    std::ifstream stream(storePath_, std::ios::binary);
+    if (!stream.is_open()) return;
+
+    std::array<char, kFileHashMagic.size()> magic;
+    std::uint64_t count = 0;
+    stream.read(magic.data(), magic.size());
+    stream.read(reinterpret_cast<char*>(&count), sizeof(count));
+    if (!stream || string_view(magic.data(), magic.size()) != kFileHashMagic)
+        return;
+
+    for (; count != 0; --count) {
+        Entry entry{};
+        stream.read(reinterpret_cast<char*>(&entry.stamp), sizeof(entry.stamp));
+        stream.read(reinterpret_cast<char*>(&entry.hashedAtNs),
+                    sizeof(entry.hashedAtNs));
+        stream.read(reinterpret_cast<char*>(entry.digest.data()),
+                    entry.digest.size());
+        if (!stream) {
+            entries_.clear();
+            return;
+        }
+
+        entries_[{ entry.stamp.device, entry.stamp.inode }] = entry;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,159 @@
+#pragma once
+#include <mutex>
+#include <unordered_map>
+#include "common.hpp"
+#include "target.hpp"
+#include "utilities/noncopyable.hpp"
+
+namespace cpak::cache {
+
+
+/// @brief  Gets the root directory of the build output cache.
+/// @return The path to the build output cache, \c ~/.cpak/cache by default.
+std::filesystem::path
+cacheRootPath() noexcept;
+
+
+/// @brief   Computes the fingerprint of a compiler.
+/// @details Covers the resolved path and the contents of the compiler driver,
+///          so upgrading the toolchain in place changes the fingerprint.
+/// @param   compiler The compiler command, looked up on the \c PATH.
+/// @return  The fingerprint of the compiler.
+std::string
+toolchainFingerprint(std::string_view compiler) noexcept;
+
+
+/// @brief   Computes the configuration fingerprint of a target.
+/// @details Covers the target name and type, the options it referenced during
+///          interpolation, its flattened compilation arguments and the
+///          toolchain that runs them. Options the target does not reference
+///          never change its fingerprint.
+/// @param   target The consolidated target.
+/// @param   arguments The compilation arguments of the target.
+/// @return  The fingerprint of the target.
+std::string
+targetFingerprint(const BuildTarget& target,
+                  const std::vector<std::string>& arguments) noexcept;
+
+
+/// @brief   Computes the cache key for a link or archive step.
+/// @details The key covers the full command line and the contents of every
+///          input object and library. Input and output paths are hashed as
+///          part of the command line, so a relocated checkout produces a
+///          different key even when the contents are identical.
+/// @param   arguments The command line that produces the output.
+/// @param   inputs The object and library files consumed by the command.
+/// @return  The key and the status code for the operation.
+std::tuple<std::string, std::error_code>
+linkCacheKey(const std::vector<std::string>& arguments,
+             const std::vector<std::filesystem::path>& inputs) noexcept;
+
+
+/// @brief   Restores a previously linked output from the cache.
+/// @details Compressed entries are decompressed block by block straight into
+///          the output, uncompressed entries are cloned.
+/// @param   key The key computed by \c linkCacheKey.
+/// @param   outputPath Where the output should be placed.
+/// @return  The status code for the operation, \c cacheMiss if not cached.
+std::error_code
+restoreLinkOutput(std::string_view key,
+                  const std::filesystem::path& outputPath) noexcept;
+
+
+/// @brief  Stores a freshly linked output in the cache.
+/// @param  key The key computed by \c linkCacheKey.
+/// @param  outputPath The output that was just produced.
+/// @param  compressionLevel The level to compress with, 0 stores it as is.
+/// @return The status code for the operation.
+std::error_code
+storeLinkOutput(std::string_view key,
+                const std::filesystem::path& outputPath,
+                std::uint32_t compressionLevel = 0) noexcept;
+
+
+/// @brief   Identifies the state of a file on disk without reading it.
+/// @details Any write to the file changes its ctime, so a matching stamp means
+///          the contents are unchanged unless the file was modified within the
+///          timestamp granularity of the moment it was hashed.
+struct FileStamp {
+    std::uint64_t device;
+    std::uint64_t inode;
+    std::uint64_t size;
+    std::int64_t modifiedNs;
+    std::int64_t changedNs;
+
+    bool operator==(const FileStamp&) const = default;
+};
+
+
+/// @brief   A persistent cache of file content digests.
+/// @details Digests are keyed by device and inode and only reused while the
+///          stamp of the file is unchanged, so unchanged files are never read.
+///          Like git's index, an entry is "racy" when the file was modified
+///          too close to the moment it was hashed for the stamp to prove that
+///          nothing changed afterwards; racy entries are hashed again until
+///          they settle. The build, the link cache and installation share the
+///          instance returned by \c shared.
+class FileHashCache : public util::NonCopyable {
+    public:
+    /// @brief Creates a cache backed by the given file, loading its entries.
+    /// @param storePath The file the entries are loaded from and saved to.
+    /// @param racyWindow How close to being hashed a modification is racy,
+    ///        the default covers the coarse clocks filesystems stamp files
+    ///        with, down to FAT's 2 seconds.
+    explicit FileHashCache(
+        std::filesystem::path storePath,
+        std::chrono::nanoseconds racyWindow = std::chrono::seconds(2)) noexcept;
+
+    /// @brief  Gets the cache shared by the whole process.
+    /// @return The shared cache, stored under \c cacheRootPath.
+    static FileHashCache&
+    shared() noexcept;
+
+    /// @brief   Gets the content digest of a file.
+    /// @details Thread safe, files are hashed outside of the lock.
+    /// @param   path The file to get the digest of.
+    /// @return  The digest as a hexadecimal string and the status code.
+    std::tuple<std::string, std::error_code>
+    hash(const std::filesystem::path& path) noexcept;
+
+    /// @brief  Writes the entries back if any changed.
+    /// @return The status code for the operation.
+    std::error_code
+    save() noexcept;
+
+    /// @brief  Gets the number of files that had to be read.
+    /// @return The number of files hashed since the cache was created.
+    std::size_t
+    readCount() const noexcept;
+
+    private:
+    struct Entry {
+        FileStamp stamp;
+        std::int64_t hashedAtNs;
+        std::array<std::uint8_t, 16> digest;
+        bool used;
+    };
+
+    struct KeyHash {
+        std::size_t
+        operator()(const std::pair<std::uint64_t, std::uint64_t>& key)
+            const noexcept {
+            return std::hash<std::uint64_t>()(key.first * 31 + key.second);
+        }
+    };
+
+    void
+    load() noexcept;
+
+    std::filesystem::path storePath_;
+    std::int64_t racyWindowNs_;
+    std::unordered_map<std::pair<std::uint64_t, std::uint64_t>, Entry, KeyHash>
+        entries_;
+    mutable std::mutex mutex_;
+    std::size_t readCount_{ 0 };
+    bool dirty_{ false };
+};
+
+
+} // namespace cpak::cache
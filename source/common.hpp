@@ -2,6 +2,7 @@
 #include <algorithm>
 #include <array>
 #include <cassert>
+#include <csignal>
 #include <cstdint>
 #include <cstring>
 #include <ctime>
@@ -9,16 +10,20 @@
 #include <fstream>
 #include <functional>
 #include <iostream>
+#include <limits>
+#include <map>
 #include <memory>
 #include <optional>
 #include <queue>
 #include <regex>
+#include <set>
 #include <sstream>
 #include <streambuf>
 #include <string>
 #include <string_view>
 #include <system_error>
 #include <type_traits>
+#include <unordered_map>
 #include <vector>
 #include "subprocess.hpp"
 #include "argparse/argparse.hpp"
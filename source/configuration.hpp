@@ -4,12 +4,31 @@
 namespace cpak {
 
 
+/// @brief   Stores the settings for the build output cache.
+/// @details Cache entries are compressed at the given level. A level of 0
+///          stores entries as they are, which allows restoring them with
+///          reflinks at the cost of disk space.
+struct CacheConfiguration {
+    std::uint32_t compressionLevel{ 1 };
+};
+
+
+/// @brief   Stores the settings for fetching dependencies.
+/// @details Dependencies are cloned concurrently, at most the given number at
+///          a time.
+struct NetworkConfiguration {
+    std::uint32_t maxConcurrentFetches{ 8 };
+};
+
+
 /// @brief   Stores the configuration for the application.
 /// @details This struct stores the configuration for the application for a
 ///          given execution. These values are set by the command line
 ///          arguments or the application configuration file.
 struct Configuration {
     bool verbose{ false };
+    CacheConfiguration cache;
+    NetworkConfiguration network;
 };
 
 
@@ -21,11 +40,19 @@ struct YAML::convert<cpak::Configuration> {
     static Node
     encode(const cpak::Configuration& rhs) {
         Node node;
+        node["cache"]["compression"] = rhs.cache.compressionLevel;
+        node["network"]["fetches"]   = rhs.network.maxConcurrentFetches;
         return node;
     }
 
     static bool
     decode(const Node& node, cpak::Configuration& rhs) {
+        if (node["cache"] && node["cache"]["compression"])
+            rhs.cache.compressionLevel =
+                node["cache"]["compression"].as<std::uint32_t>();
+        if (node["network"] && node["network"]["fetches"])
+            rhs.network.maxConcurrentFetches =
+                node["network"]["fetches"].as<std::uint32_t>();
         return true;
     }
 };
\ No newline at end of file
@@ -0,0 +1,297 @@
+#pragma once
+#include "version.hpp"
+
+namespace cpak {
+
+
+/// @brief Compares a version against a bound of a constraint.
+struct VersionComparator {
+    enum class Operator { Equal, Less, LessEqual, Greater, GreaterEqual };
+
+    Operator op;
+    cpak::version bound;
+
+    /// @brief  Checks whether the version is on the accepted side of the bound.
+    /// @param  semv The version to check.
+    /// @return True if the version is accepted, false otherwise.
+    bool
+    acceptsVersion(const cpak::version& semv) const noexcept {
+        switch (op) {
+        case Operator::Equal:        return semv == bound;
+        case Operator::Less:         return semv < bound;
+        case Operator::LessEqual:    return semv <= bound;
+        case Operator::Greater:      return semv > bound;
+        case Operator::GreaterEqual: return semv >= bound;
+        }
+
+        return false;
+    }
+};
+
+
+/// @brief   The versions of a dependency that are accepted.
+/// @details Constraints are written like npm ranges: comparators separated by
+///          spaces must all hold, and \c || separates alternatives. A version
+///          is also accepted with \c ^ (same left-most non-zero component),
+///          \c ~ (same minor), \c x wildcards, partial versions, or a hyphen
+///          range. Pre-releases are only accepted by an alternative that
+///          names a pre-release of the same version.
+class VersionConstraint {
+public:
+    /// @brief  Parses a constraint.
+    /// @param  text The constraint to parse, e.g. \c ^1.2 or \c >=1.4 \c <2.
+    /// @return The constraint, or nothing if the text is not a constraint.
+    static std::optional<VersionConstraint>
+    parse(std::string_view text) {
+        VersionConstraint constraint;
+        constraint.text_ = std::string(text);
+
+        std::size_t start = 0;
+        while (true) {
+            const auto end = text.find("||", start);
+            auto alternative = parseAlternative(text.substr(start, end - start));
+            if (alternative == std::nullopt) return std::nullopt;
+
+            constraint.alternatives_.push_back(std::move(*alternative));
+            if (end == std::string_view::npos) break;
+            start = end + 2;
+        }
+
+        return constraint;
+    }
+
+    /// @brief  Creates a constraint that only accepts one version.
+    /// @param  semv The version to accept.
+    /// @return The constraint.
+    static VersionConstraint
+    exactly(const cpak::version& semv) {
+        VersionConstraint constraint;
+        constraint.text_ = semv.str();
+        constraint.alternatives_.push_back(
+            { { VersionComparator::Operator::Equal, semv } });
+        return constraint;
+    }
+
+    /// @brief  Checks whether a version is accepted.
+    /// @param  semv The version to check.
+    /// @return True if the version is accepted, false otherwise.
+    bool
+    acceptsVersion(const cpak::version& semv) const noexcept {
+        return std::any_of(alternatives_.begin(), alternatives_.end(),
+            [&](const auto& comparators) {
+                return acceptsVersion(comparators, semv);
+            });
+    }
+
+    /// @brief  Checks whether only a single version is accepted.
+    /// @return True if the constraint pins a version, false otherwise.
+    bool
+    isExact() const noexcept {
+        return alternatives_.size() == 1 && alternatives_[0].size() == 1 &&
+               alternatives_[0][0].op == VersionComparator::Operator::Equal;
+    }
+
+    /// @brief  Gets the constraint as it was written.
+    /// @return The text of the constraint.
+    const std::string&
+    str() const noexcept {
+        return text_;
+    }
+
+private:
+    using Operator    = VersionComparator::Operator;
+    using Alternative = std::vector<VersionComparator>;
+
+    /// @brief A version with some components left out or wildcarded.
+    struct PartialVersion {
+        std::uint64_t major{ 0 };
+        std::uint64_t minor{ 0 };
+        std::uint64_t patch{ 0 };
+        std::string prerelease;
+
+        // How many of the components were given.
+        int components{ 0 };
+
+        cpak::version
+        lower() const {
+            return cpak::version(major, minor, patch, prerelease);
+        }
+
+        cpak::version
+        upper() const {
+            // The first version past the components that were given.
+            if (components == 1) return cpak::version(major + 1, 0, 0);
+            if (components == 2) return cpak::version(major, minor + 1, 0);
+            return cpak::version(major, minor, patch + 1);
+        }
+    };
+
+    static bool
+    acceptsVersion(const Alternative& comparators,
+                   const cpak::version& semv) noexcept {
+        const auto accepted =
+            std::all_of(comparators.begin(), comparators.end(),
+                [&](const auto& comparator) {
+                    return comparator.acceptsVersion(semv);
+                });
+
+        if (!accepted || !semv.is_prerelease()) return accepted;
+        return std::any_of(comparators.begin(), comparators.end(),
+            [&](const auto& comparator) {
+                const auto& bound = comparator.bound;
+                return bound.is_prerelease() && bound.major() == semv.major() &&
+                       bound.minor() == semv.minor() &&
+                       bound.patch() == semv.patch();
+            });
+    }
+
+    static std::optional<PartialVersion>
+    parsePartial(std::string_view text) {
+        if (text.starts_with('v')) text.remove_prefix(1);
+
+        PartialVersion partial;
+        std::uint64_t* components[] = { &partial.major, &partial.minor,
+                                        &partial.patch };
+        std::size_t position = 0;
+        for (auto index = 0; index < 3; ++index) {
+            if (index > 0) {
+                if (position == text.size()) return partial;
+                if (text[position++] != '.') return std::nullopt;
+            }
+
+            const auto start = position;
+            while (position < text.size() && text[position] >= '0' &&
+                   text[position] <= '9')
+                ++position;
+
+            if (position == start) {
+                // A wildcard ends the version.
+                if (position == text.size() ||
+                    (text[position] != 'x' && text[position] != 'X' &&
+                     text[position] != '*'))
+                    return std::nullopt;
+                return ++position == text.size()
+                    ? std::optional<PartialVersion>(partial)
+                    : std::nullopt;
+            }
+
+            const auto digits = text.substr(start, position - start);
+            if (digits.size() > 1 && digits.front() == '0') return std::nullopt;
+
+            *components[index] = std::stoull(std::string(digits));
+            partial.components = index + 1;
+        }
+
+        // Build metadata doesn't take part in ordering.
+        auto rest = text.substr(position);
+        rest = rest.substr(0, rest.find('+'));
+        if (rest.starts_with('-')) {
+            try {
+                partial.prerelease =
+                    cpak::version::parse(fmt::format("0.0.0{}", rest)).prerelease();
+            } catch (const std::exception&) {
+                return std::nullopt;
+            }
+        } else if (!rest.empty()) {
+            return std::nullopt;
+        }
+
+        return partial;
+    }
+
+    static bool
+    appendComparators(std::string_view text, Alternative& comparators) {
+        auto op = std::string_view();
+        for (const auto candidate : { ">=", "<=", ">", "<", "=", "^", "~" }) {
+            if (!text.starts_with(candidate)) continue;
+            op = candidate;
+            break;
+        }
+
+        const auto partial = parsePartial(text.substr(op.size()));
+        if (partial == std::nullopt) return false;
+        if (partial->components == 0) {
+            // A wildcard accepts any version, there is nothing below or
+            // above it.
+            return op != "<" && op != ">";
+        }
+
+        const auto exact = partial->components == 3;
+        const auto lower = partial->lower();
+        const auto upper = partial->upper();
+        const auto add   = [&](Operator op, const cpak::version& bound) {
+            comparators.push_back({ op, bound });
+        };
+
+        if (op == ">=") {
+            add(Operator::GreaterEqual, lower);
+        } else if (op == ">") {
+            add(exact ? Operator::Greater : Operator::GreaterEqual,
+                exact ? lower : upper);
+        } else if (op == "<") {
+            add(Operator::Less, lower);
+        } else if (op == "<=") {
+            add(exact ? Operator::LessEqual : Operator::Less,
+                exact ? lower : upper);
+        } else if (op == "^") {
+            add(Operator::GreaterEqual, lower);
+            if (partial->major > 0 || partial->components == 1)
+                add(Operator::Less, cpak::version(partial->major + 1, 0, 0));
+            else if (partial->minor > 0 || partial->components == 2)
+                add(Operator::Less, cpak::version(0, partial->minor + 1, 0));
+            else
+                add(Operator::Less, cpak::version(0, 0, partial->patch + 1));
+        } else if (op == "~") {
+            add(Operator::GreaterEqual, lower);
+            add(Operator::Less, partial->components == 1
+                ? cpak::version(partial->major + 1, 0, 0)
+                : cpak::version(partial->major, partial->minor + 1, 0));
+        } else if (exact) {
+            add(Operator::Equal, lower);
+        } else {
+            add(Operator::GreaterEqual, lower);
+            add(Operator::Less, upper);
+        }
+
+        return true;
+    }
+
+    static std::optional<Alternative>
+    parseAlternative(std::string_view text) {
+        std::vector<std::string_view> words;
+        for (std::size_t position = 0; position < text.size();) {
+            const auto start = text.find_first_not_of(" \t", position);
+            if (start == std::string_view::npos) break;
+
+            position = std::min(text.find_first_of(" \t", start), text.size());
+            words.push_back(text.substr(start, position - start));
+        }
+
+        Alternative comparators;
+        if (words.size() == 3 && words[1] == "-") {
+            // A hyphen range includes both ends.
+            const auto lower = parsePartial(words[0]);
+            const auto upper = parsePartial(words[2]);
+            if (lower == std::nullopt || upper == std::nullopt) return std::nullopt;
+
+            if (lower->components > 0)
+                comparators.push_back({ Operator::GreaterEqual, lower->lower() });
+            if (upper->components == 3)
+                comparators.push_back({ Operator::LessEqual, upper->lower() });
+            else if (upper->components > 0)
+                comparators.push_back({ Operator::Less, upper->upper() });
+            return comparators;
+        }
+
+        for (const auto word : words)
+            if (!appendComparators(word, comparators)) return std::nullopt;
+
+        return comparators;
+    }
+
+    std::vector<Alternative> alternatives_;
+    std::string text_;
+};
+
+
+} // namespace cpak
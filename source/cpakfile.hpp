@@ -48,11 +48,15 @@ struct CPakFile {
         return buildPath / "libraries";
     }
 
-    /// @brief  Gets the path to the objects build directory for this project.
-    /// @return The path to the objects build directory for this project.
+    /// @brief   Gets the path to the objects build directory for a target.
+    /// @details Objects are kept outside of the build path picked by the
+    ///          project options, keyed by the fingerprint of the target that
+    ///          compiles them, so targets unaffected by an option keep theirs.
+    /// @param   fingerprint The configuration fingerprint of the target.
+    /// @return  The path to the objects build directory for the target.
     inline std::filesystem::path
-    objectBuildPath() const noexcept {
-        return buildPath / "objects";
+    objectBuildPath(std::string_view fingerprint) const noexcept {
+        return projectPath / ".cpak" / "objects" / fingerprint;
     }
 
     // TODO: extract to application.
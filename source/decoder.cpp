@@ -0,0 +1,680 @@
+#include "decoder.hpp"
+#include "yaml-cpp/eventhandler.h"
+
+
+using cpak::AccessLevel;
+using cpak::Accessibles;
+using cpak::AccessiblesAllocator;
+using cpak::BuildOption;
+using cpak::BuildTarget;
+using cpak::CPakFile;
+using cpak::Dependency;
+using cpak::FileType;
+using cpak::Install;
+using cpak::InstallFile;
+using cpak::InternedString;
+using cpak::ProjectInfo;
+using cpak::Repository;
+using cpak::SearchPaths;
+using cpak::TargetType;
+using std::string;
+using std::string_view;
+using std::vector;
+
+
+/// @brief   A single event of the YAML parser.
+/// @details Collections keep the index one past their closing event, so a
+///          whole value can be skipped without walking it.
+struct Event {
+    enum struct Kind : std::uint8_t {
+        eNull,
+        eScalar,
+        eSequence,
+        eMap,
+        eEnd,
+    };
+
+    Kind kind;
+    YAML::Mark mark;
+    string tag;
+    string value;
+    std::size_t end{ 0 };
+};
+
+
+/// @brief   Records the events of a YAML document in order.
+/// @details Aliases are expanded in place by copying the events of the value
+///          they refer to, so the decoder never has to resolve them. Nested
+///          aliases grow the events exponentially, so expansion is capped
+///          relative to how much of the input has been read.
+class EventRecorder : public YAML::EventHandler {
+    public:
+    static constexpr std::size_t kMinimumEventLimit = 1 << 16;
+    static constexpr std::size_t kEventsPerByte     = 4;
+
+    vector<Event> events;
+
+    void
+    OnDocumentStart(const YAML::Mark&) override {}
+
+    void
+    OnDocumentEnd() override {}
+
+    void
+    OnNull(const YAML::Mark& mark, YAML::anchor_t anchor) override {
+        addValue({ Event::Kind::eNull, mark, {}, {} }, anchor);
+    }
+
+    void
+    OnAlias(const YAML::Mark& mark, YAML::anchor_t anchor) override {
+        const auto found = anchors_.find(anchor);
+        if (found == anchors_.end())
+            throw YAML::Exception(mark, YAML::ErrorMsg::UNKNOWN_ANCHOR);
+
+        const auto [first, last] = found->second;
+        const auto limit         = std::max(
+            kMinimumEventLimit,
+            kEventsPerByte * static_cast<std::size_t>(mark.pos + 1));
+        if (events.size() + last - first > limit)
+            throw YAML::Exception(mark, "Alias expands to too many nodes.");
+
+        const auto offset = events.size() - first;
+        events.reserve(events.size() + last - first);
+        for (auto index = first; index < last; ++index) {
+            auto copy = events[index];
+            copy.end += offset;
+            events.push_back(std::move(copy));
+        }
+    }
+
+    void
+    OnScalar(const YAML::Mark& mark,
+             const string& tag,
+             YAML::anchor_t anchor,
+             const string& value) override {
+        addValue({ Event::Kind::eScalar, mark, tag, value }, anchor);
+    }
+
+    void
+    OnSequenceStart(const YAML::Mark& mark,
+                    const string& tag,
+                    YAML::anchor_t anchor,
+                    YAML::EmitterStyle::value) override {
+        open({ Event::Kind::eSequence, mark, tag, {} }, anchor);
+    }
+
+    void
+    OnSequenceEnd() override {
+        close();
+    }
+
+    void
+    OnMapStart(const YAML::Mark& mark,
+               const string& tag,
+               YAML::anchor_t anchor,
+               YAML::EmitterStyle::value) override {
+        open({ Event::Kind::eMap, mark, tag, {} }, anchor);
+    }
+
+    void
+    OnMapEnd() override {
+        close();
+    }
+
+    private:
+    void
+    addValue(Event&& event, YAML::anchor_t anchor) {
+        event.end = events.size() + 1;
+        events.push_back(std::move(event));
+        if (anchor != YAML::NullAnchor)
+            anchors_[anchor] = { events.size() - 1, events.size() };
+    }
+
+    void
+    open(Event&& event, YAML::anchor_t anchor) {
+        open_.emplace_back(events.size(), anchor);
+        events.push_back(std::move(event));
+    }
+
+    void
+    close() {
+        const auto [start, anchor] = open_.back();
+        open_.pop_back();
+
+        events.push_back({ Event::Kind::eEnd, events[start].mark, {}, {} });
+        events.back().end = events.size();
+        events[start].end = events.size();
+        if (anchor != YAML::NullAnchor)
+            anchors_[anchor] = { start, events.size() };
+    }
+
+    private:
+    vector<std::pair<std::size_t, YAML::anchor_t>> open_;
+    std::unordered_map<YAML::anchor_t, std::pair<std::size_t, std::size_t>>
+        anchors_;
+};
+
+
+/// @brief   Fills a CPakFile from recorded events.
+/// @details Every map is walked once to find the indices of its keys, then
+///          the values are validated in the same order as the converters do
+///          and decoded in place. Scalars are moved out of the events.
+class CPakFileDecoder {
+    public:
+    static constexpr std::size_t kMissing = std::numeric_limits<std::size_t>::max();
+
+    explicit CPakFileDecoder(vector<Event>&& events)
+        : events_(std::move(events))
+        , allocator_(cpak::utilities::makeArena(
+              events_.size() * sizeof(cpak::Accessible<InternedString>))) {}
+
+    CPakFile
+    decode() {
+        if (events_.empty())
+            throw YAML::Exception(YAML::Mark::null_mark(),
+                                  "CPakFile is not a map");
+
+        constexpr std::size_t kRoot = 0;
+        if (!isMap(kRoot)) fail(kRoot, "CPakFile is not a map");
+
+        std::size_t project = kMissing, targets = kMissing, options = kMissing,
+                    repositories = kMissing, dependencies = kMissing,
+                    install = kMissing;
+        forEachEntry(kRoot, [&](string_view key, std::size_t value) {
+            if (key == "project") project = value;
+            else if (key == "targets") targets = value;
+            else if (key == "options") options = value;
+            else if (key == "repositories") repositories = value;
+            else if (key == "dependencies") dependencies = value;
+            else if (key == "install") install = value;
+        });
+
+        if (project == kMissing)
+            fail(kRoot, "CPakFile must contain project info.");
+
+        if (targets == kMissing)
+            fail(kRoot, "CPakFile must contain build targets.");
+        else if (!isSequence(targets))
+            fail(targets, "CPakFile targets must be a sequence.");
+        else if (countItems(targets) == 0)
+            fail(targets, "CPakFile targets must not be empty.");
+
+        if (options != kMissing && !isSequence(options))
+            fail(options, "CPakFile options must be a sequence.");
+
+        if (repositories != kMissing && !isSequence(repositories))
+            fail(repositories, "CPakFile repositories must be a sequence.");
+
+        if (dependencies != kMissing && !isSequence(dependencies))
+            fail(dependencies, "CPakFile dependencies must be a sequence.");
+
+        if (install != kMissing && !isMap(install))
+            fail(install, "CPakFile install is not a map.");
+
+        CPakFile cpakfile;
+        decodeProject(project, cpakfile.project);
+        if (options != kMissing) {
+            cpakfile.options.resize(countItems(options));
+            auto option = cpakfile.options.begin();
+            forEachItem(options, [&](std::size_t item) {
+                decodeOption(item, *option++);
+            });
+        }
+
+        if (repositories != kMissing) {
+            cpakfile.repositories.resize(countItems(repositories));
+            auto repository = cpakfile.repositories.begin();
+            forEachItem(repositories, [&](std::size_t item) {
+                decodeRepository(item, *repository++);
+            });
+        }
+
+        if (dependencies != kMissing) {
+            cpakfile.dependencies.resize(countItems(dependencies));
+            auto dependency = cpakfile.dependencies.begin();
+            forEachItem(dependencies, [&](std::size_t item) {
+                decodeDependency(item, *dependency++);
+            });
+        }
+
+        cpakfile.targets.resize(countItems(targets));
+        auto target = cpakfile.targets.begin();
+        forEachItem(targets, [&](std::size_t item) {
+            decodeTarget(item, *target++);
+        });
+
+        // The targets are in place now, so their accessibles can point at them.
+        for (auto& target : cpakfile.targets) assignOwner(target);
+
+        if (install != kMissing) {
+            cpakfile.install = Install();
+            decodeInstall(install, *cpakfile.install);
+        }
+
+        return cpakfile;
+    }
+
+    private:
+    [[noreturn]] void
+    fail(std::size_t index, string_view message) const {
+        throw YAML::Exception(events_[index].mark, string(message));
+    }
+
+    bool
+    isScalar(std::size_t index) const noexcept {
+        return events_[index].kind == Event::Kind::eScalar;
+    }
+
+    bool
+    isSequence(std::size_t index) const noexcept {
+        return events_[index].kind == Event::Kind::eSequence;
+    }
+
+    bool
+    isMap(std::size_t index) const noexcept {
+        return events_[index].kind == Event::Kind::eMap;
+    }
+
+    /// @brief Calls the function with the key and value index of every entry
+    ///        of a map, entries with keys that are not scalars are skipped.
+    template<typename Function>
+    void
+    forEachEntry(std::size_t map, Function&& function) const {
+        if (!isMap(map)) return;
+
+        auto index = map + 1;
+        while (events_[index].kind != Event::Kind::eEnd) {
+            const auto value = events_[index].end;
+            if (isScalar(index)) function(string_view(events_[index].value), value);
+            index = events_[value].end;
+        }
+    }
+
+    template<typename Function>
+    void
+    forEachItem(std::size_t sequence, Function&& function) const {
+        for (auto index = sequence + 1; events_[index].kind != Event::Kind::eEnd;
+             index = events_[index].end)
+            function(index);
+    }
+
+    std::size_t
+    countItems(std::size_t sequence) const noexcept {
+        std::size_t count = 0;
+        forEachItem(sequence, [&](std::size_t) { ++count; });
+        return count;
+    }
+
+    string
+    takeScalar(std::size_t index) {
+        if (!isScalar(index)) fail(index, YAML::ErrorMsg::BAD_CONVERSION);
+        return std::move(events_[index].value);
+    }
+
+    vector<string>
+    takeStrings(std::size_t sequence) {
+        vector<string> values;
+        values.reserve(countItems(sequence));
+        forEachItem(sequence, [&](std::size_t item) {
+            values.push_back(takeScalar(item));
+        });
+
+        return values;
+    }
+
+    cpak::version
+    takeVersion(std::size_t index) {
+        try {
+            return cpak::version::parse(takeScalar(index));
+        } catch (const std::runtime_error& exc) {
+            fail(index, exc.what());
+        }
+    }
+
+    static AccessLevel
+    levelFromTag(string_view tag) noexcept {
+        if (tag == "!protected") return AccessLevel::eProtected;
+        if (tag == "!private") return AccessLevel::ePrivate;
+        return AccessLevel::ePublic;
+    }
+
+    void
+    decodeAccessibles(std::size_t sequence, Accessibles<InternedString>& accessibles) {
+        accessibles = Accessibles<InternedString>(allocator_);
+        accessibles.reserve(countItems(sequence));
+        forEachItem(sequence, [&](std::size_t item) {
+            const auto level = levelFromTag(events_[item].tag);
+            accessibles.push_back({ .stored = takeScalar(item), .level = level });
+        });
+    }
+
+    void
+    decodeProject(std::size_t node, ProjectInfo& project) {
+        if (!isMap(node)) fail(node, "Project is not a map");
+
+        std::size_t name = kMissing, gpid = kMissing, semv = kMissing,
+                    desc = kMissing, home = kMissing, issues = kMissing,
+                    license = kMissing, authors = kMissing;
+        forEachEntry(node, [&](string_view key, std::size_t value) {
+            if (key == "name") name = value;
+            else if (key == "gpid") gpid = value;
+            else if (key == "semv") semv = value;
+            else if (key == "desc") desc = value;
+            else if (key == "home") home = value;
+            else if (key == "issues") issues = value;
+            else if (key == "license") license = value;
+            else if (key == "authors") authors = value;
+        });
+
+        if (name == kMissing) fail(node, "Project is missing a name.");
+        else if (!isScalar(name)) fail(name, "Project name must be a string.");
+
+        if (gpid == kMissing) fail(node, "Project is missing a gpid.");
+        else if (!isScalar(gpid)) fail(gpid, "Project gpid must be a string.");
+
+        if (semv == kMissing) fail(node, "Project is missing a semv.");
+        else if (!isScalar(semv)) fail(semv, "Project semv must be a string.");
+
+        if (desc != kMissing && !isScalar(desc))
+            fail(desc, "Project desc must be a string.");
+
+        if (home != kMissing && !isScalar(home))
+            fail(home, "Project home must be a string.");
+
+        if (issues != kMissing && !isScalar(issues))
+            fail(issues, "Project issues must be a string.");
+
+        if (license != kMissing && !isScalar(license))
+            fail(license, "Project license must be a string.");
+
+        if (authors != kMissing && !isSequence(authors))
+            fail(authors, "Project authors must be a sequence.");
+
+        project.name = takeScalar(name);
+        project.gpid = takeScalar(gpid);
+        project.semv = takeVersion(semv);
+
+        // Optional fields.
+        if (desc != kMissing) project.description = takeScalar(desc);
+        if (home != kMissing) project.homePage = takeScalar(home);
+        if (issues != kMissing) project.issuesPage = takeScalar(issues);
+        if (license != kMissing) project.license = takeScalar(license);
+        if (authors != kMissing) project.authors = takeStrings(authors);
+    }
+
+    void
+    decodeOption(std::size_t node, BuildOption& option) {
+        std::size_t name = kMissing, value = kMissing, desc = kMissing;
+        forEachEntry(node, [&](string_view key, std::size_t entry) {
+            if (key == "name") name = entry;
+            else if (key == "value") value = entry;
+            else if (key == "desc") desc = entry;
+        });
+
+        if (name == kMissing) fail(node, "Build option is missing a name.");
+        else if (!isScalar(name)) fail(name, "Build option name must be a string.");
+
+        if (value == kMissing) fail(node, "Build option is missing a value.");
+        else if (!isScalar(value))
+            fail(value, "Build option value must be a string.");
+
+        if (desc != kMissing && !isScalar(desc))
+            fail(desc, "Build option desc must be a string.");
+
+        option.name  = takeScalar(name);
+        option.value = takeScalar(value);
+        if (desc != kMissing) option.desc = takeScalar(desc);
+    }
+
+    void
+    decodeRepository(std::size_t node, Repository& repository) {
+        std::size_t address = kMissing, username = kMissing, email = kMissing,
+                    password = kMissing, archive = kMissing;
+        forEachEntry(node, [&](string_view key, std::size_t value) {
+            if (key == "address") address = value;
+            else if (key == "username") username = value;
+            else if (key == "email") email = value;
+            else if (key == "password") password = value;
+            else if (key == "archive") archive = value;
+        });
+
+        if (address == kMissing) fail(node, "Repository is missing an address.");
+        else if (!isScalar(address))
+            fail(address, "Repository address must be a string.");
+
+        if (username != kMissing && !isScalar(username))
+            fail(username, "Repository username must be a string.");
+
+        if (email != kMissing && !isScalar(email))
+            fail(email, "Repository email must be a string.");
+
+        if (password != kMissing && !isScalar(password))
+            fail(password, "Repository password must be a string.");
+
+        if (archive != kMissing && !isScalar(archive))
+            fail(archive, "Repository archive must be a string.");
+
+        repository.address = takeScalar(address);
+        if (username != kMissing) repository.username = takeScalar(username);
+        if (email != kMissing) repository.email = takeScalar(email);
+        if (password != kMissing) repository.password = takeScalar(password);
+        if (archive != kMissing) repository.archive = takeScalar(archive);
+    }
+
+    void
+    decodeIdentity(std::size_t node, Dependency& dependency) {
+        try {
+            cpak::decodeDependencyID(events_[node].value, events_[node].mark,
+                                     dependency);
+        } catch (const YAML::Exception&) {
+            throw; // Already points at the offending character.
+        } catch (const std::runtime_error& exc) {
+            fail(node, exc.what());
+        }
+    }
+
+    void
+    decodeDependency(std::size_t node, Dependency& dependency) {
+        if (isScalar(node)) {
+            decodeIdentity(node, dependency);
+            return;
+        }
+
+        if (!isMap(node))
+            fail(node, "Dependency must be a string or a map.");
+
+        std::size_t cpakid = kMissing, repository = kMissing, remote = kMissing;
+        forEachEntry(node, [&](string_view key, std::size_t value) {
+            if (key == "cpakid") cpakid = value;
+            else if (key == "repository") repository = value;
+            else if (key == "remote") remote = value;
+        });
+
+        if (cpakid == kMissing) fail(node, "Dependency is missing a cpakid.");
+        else if (!isScalar(cpakid))
+            fail(cpakid, "Dependency cpakid must be a string.");
+
+        if (repository != kMissing && !isMap(repository))
+            fail(repository, "Dependency repository must be a map.");
+
+        decodeIdentity(cpakid, dependency);
+        if (remote != kMissing) {
+            dependency.remote = Repository();
+            decodeRepository(remote, *dependency.remote);
+        }
+    }
+
+    void
+    decodeSearchPaths(std::size_t node, SearchPaths& search) {
+        if (!isMap(node)) fail(node, "Search paths must be a map.");
+
+        std::size_t include = kMissing, system = kMissing, library = kMissing;
+        forEachEntry(node, [&](string_view key, std::size_t value) {
+            if (key == "include") include = value;
+            else if (key == "system") system = value;
+            else if (key == "library") library = value;
+        });
+
+        if (include != kMissing && !isSequence(include))
+            fail(include, "Include paths must be a sequence.");
+        if (system != kMissing && !isSequence(system))
+            fail(system, "System paths must be a sequence.");
+        if (library != kMissing && !isSequence(library))
+            fail(library, "Library paths must be a sequence.");
+
+        if (include != kMissing) decodeAccessibles(include, search.include);
+        if (system != kMissing) decodeAccessibles(system, search.system);
+        if (library != kMissing) decodeAccessibles(library, search.library);
+    }
+
+    void
+    decodeTarget(std::size_t node, BuildTarget& target) {
+        std::size_t name = kMissing, type = kMissing, sources = kMissing,
+                    defines = kMissing, interfaces = kMissing,
+                    libraries = kMissing, options = kMissing, search = kMissing;
+        forEachEntry(node, [&](string_view key, std::size_t value) {
+            if (key == "name") name = value;
+            else if (key == "type") type = value;
+            else if (key == "sources") sources = value;
+            else if (key == "defines") defines = value;
+            else if (key == "interfaces") interfaces = value;
+            else if (key == "libraries") libraries = value;
+            else if (key == "options") options = value;
+            else if (key == "search") search = value;
+        });
+
+        if (name == kMissing) fail(node, "Target is missing a name.");
+        else if (!isScalar(name)) fail(name, "Target name must be a string.");
+
+        if (type == kMissing) fail(node, "Target is missing a type.");
+        else if (!isScalar(type)) fail(type, "Target type must be a string.");
+
+        // Interfaces don't require sources, so their absence is checked once
+        // the type is known.
+        if (sources != kMissing) {
+            if (!isSequence(sources))
+                fail(sources, "Target sources must be a sequence.");
+            else if (countItems(sources) == 0)
+                fail(sources, "Target sources must not be empty.");
+        }
+
+        if (defines != kMissing && !isSequence(defines))
+            fail(defines, "Target defines must be a sequence.");
+
+        if (interfaces != kMissing && !isSequence(interfaces))
+            fail(interfaces, "Target interfaces must be a sequence.");
+
+        if (libraries != kMissing && !isSequence(libraries))
+            fail(libraries, "Target libraries must be a sequence.");
+
+        if (options != kMissing && !isScalar(options) && !isSequence(options))
+            fail(options, "Target options must be a string or sequence.");
+
+        target.name = takeScalar(name);
+        target.type = cpak::buildTypeFromName(takeScalar(type));
+        if (target.type != TargetType::Interface) {
+            if (sources == kMissing) fail(node, "Target is missing sources.");
+            decodeAccessibles(sources, target.sources);
+        }
+
+        // Handle optional fields.
+        if (search != kMissing) {
+            target.search = SearchPaths();
+            decodeSearchPaths(search, *target.search);
+        }
+
+        if (options != kMissing && isScalar(options)) {
+            const auto level = levelFromTag(events_[options].tag);
+            target.options   = cpak::accessiblesFromString(
+                level, takeScalar(options), ' ', allocator_);
+        } else if (options != kMissing) {
+            decodeAccessibles(options, target.options);
+        }
+
+        if (defines != kMissing) decodeAccessibles(defines, target.defines);
+        if (libraries != kMissing) decodeAccessibles(libraries, target.libraries);
+        if (interfaces != kMissing) decodeAccessibles(interfaces, target.interfaces);
+    }
+
+    static void
+    assignOwner(BuildTarget& target) noexcept {
+        cpak::assignTargetToAccessibles(target.defines, &target);
+        cpak::assignTargetToAccessibles(target.interfaces, &target);
+        cpak::assignTargetToAccessibles(target.libraries, &target);
+        cpak::assignTargetToAccessibles(target.sources, &target);
+        cpak::assignTargetToAccessibles(target.options, &target);
+        if (target.search.has_value()) {
+            cpak::assignTargetToAccessibles(target.search->include, &target);
+            cpak::assignTargetToAccessibles(target.search->system, &target);
+            cpak::assignTargetToAccessibles(target.search->library, &target);
+        }
+    }
+
+    void
+    decodeInstall(std::size_t node, Install& install) {
+        std::size_t targets = kMissing, files = kMissing, global = kMissing;
+        forEachEntry(node, [&](string_view key, std::size_t value) {
+            if (key == "targets") targets = value;
+            else if (key == "files") files = value;
+            else if (key == "global") global = value;
+        });
+
+        const auto& mark = events_[node].mark;
+        if (targets == kMissing && files == kMissing)
+            throw YAML::ParserException(mark,
+                "Either targets or files must be specified.");
+
+        if (targets == kMissing || !isSequence(targets))
+            throw YAML::ParserException(mark,
+                "Targets must be a sequence of strings.");
+
+        if (files == kMissing || !isSequence(files))
+            throw YAML::ParserException(mark,
+                "Files must be a sequence of strings.");
+
+        if (global != kMissing && !isScalar(global))
+            throw YAML::ParserException(mark, "Global must be a boolean.");
+
+        install.targets = takeStrings(targets);
+        install.files.reserve(countItems(files));
+        forEachItem(files, [&](std::size_t item) {
+            if (!isScalar(item))
+                throw YAML::ParserException(events_[item].mark,
+                                            "Install file must be a string.");
+
+            const string_view tag = events_[item].tag;
+            FileType type;
+            if (tag == "!header") type = FileType::Header;
+            else if (tag == "!archive") type = FileType::Archive;
+            else if (tag == "!dynlib") type = FileType::Dynlib;
+            else if (tag == "!binary") type = FileType::Binary;
+            else
+                throw YAML::ParserException(events_[item].mark,
+                                            "Unknown install file type.");
+
+            install.files.push_back({ takeScalar(item), type });
+        });
+
+        if (global != kMissing) {
+            const auto& value = events_[global].value;
+            if (!YAML::convert<bool>::decode(YAML::Node(value), install.global))
+                fail(global, YAML::ErrorMsg::BAD_CONVERSION);
+        }
+    }
+
+    private:
+    vector<Event> events_;
+
+    /// @brief Allocates the accessibles of every target from one arena, which
+    ///        is sized so a typical CPakFile fits in its first block.
+    AccessiblesAllocator<InternedString> allocator_;
+};
+
+
+CPakFile
+cpak::decoder::decodeCPakFile(std::istream& stream) {
+    YAML::Parser parser(stream);
+    EventRecorder recorder;
+    parser.HandleNextDocument(recorder);
+    return CPakFileDecoder(std::move(recorder.events)).decode();
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include "cpakfile.hpp"
+
+namespace cpak::decoder {
+
+
+/// @brief   Decodes a CPakFile straight from the events of the YAML parser.
+/// @details No node tree is built, the events are recorded in order and the
+///          CPakFile is filled and validated in a single walk over them. The
+///          same schema as the YAML converters is enforced, with the same
+///          messages, but errors are marked at the offending value instead of
+///          the map that contains it.
+/// @param   stream The stream to read the CPakFile from.
+/// @return  The decoded CPakFile.
+/// @throws  YAML::Exception when the CPakFile is malformed or invalid.
+CPakFile
+decodeCPakFile(std::istream& stream);
+
+
+} // namespace cpak::decoder
@@ -1,4 +1,5 @@
 #pragma once
+#include "constraint.hpp"
 #include "identity.hpp"
 #include "repository.hpp"
 
@@ -9,6 +10,10 @@ namespace cpak {
 /// @details This struct contains the necessary information to get a
 struct Dependency : public Identity {
     std::optional<Repository> remote;
+
+    // Set when a range of versions is accepted, the version is only known
+    // once the dependencies are resolved.
+    std::optional<VersionConstraint> constraint;
 };
 
 
@@ -36,6 +41,50 @@ validateDependencySchema(const YAML::Node& node) {
 }
 
 
+/// @brief   Reads the CPakID of a dependency.
+/// @details An exact version pins the dependency, anything else after the
+///          '@' is read as a version constraint. A version that is only
+///          missing components is taken as a typo rather than a range, ranges
+///          are spelled with an operator or a wildcard.
+/// @param   cpakid The CPakID of the dependency.
+/// @param   mark Where the CPakID starts in the document.
+/// @param   dependency The dependency to fill in.
+inline void
+decodeDependencyID(std::string cpakid, YAML::Mark mark, Dependency& dependency) {
+    const auto at = cpakid.find('@');
+    if (!parseCPakID(cpakid).isValid() && at != std::string::npos &&
+        cpakid.find_first_not_of("0123456789.", at + 1) != std::string::npos) {
+        auto constraint = VersionConstraint::parse(cpakid.substr(at + 1));
+        auto pinned     = cpakid.substr(0, at + 1) + "0.0.0";
+        if (constraint == std::nullopt || !parseCPakID(pinned).isValid())
+            validateCPakID(cpakid, mark); // Reports what is wrong with it.
+
+        dependency.constraint = std::move(constraint);
+        cpakid                = std::move(pinned);
+    } else {
+        validateCPakID(cpakid, mark);
+    }
+
+    const auto& identity = identityFromString(cpakid);
+    dependency.name = identity.name;
+    dependency.gpid = identity.gpid;
+    dependency.semv = identity.semv;
+}
+
+
+/// @brief  Converts the given dependency into a string.
+/// @param  dependency The dependency to convert.
+/// @return The CPakID of the dependency, with its constraint if it has one.
+inline std::string
+dependencyToString(const Dependency& dependency) {
+    if (dependency.constraint == std::nullopt)
+        return identityToString(dependency);
+
+    return fmt::format("{}/{}@{}", dependency.gpid, dependency.name,
+                       dependency.constraint->str());
+}
+
+
 } // namespace cpak
 
 
@@ -45,12 +94,12 @@ struct YAML::convert<cpak::Dependency> {
     encode(const cpak::Dependency& rhs) {
         Node node;
         if (rhs.remote != std::nullopt) {
-            node["cpakid"] = cpak::identityToString(rhs);
+            node["cpakid"] = cpak::dependencyToString(rhs);
             node["remote"] = rhs.remote.value();
             return node;
         }
 
-        node = cpak::identityToString(rhs);
+        node = cpak::dependencyToString(rhs);
         return node;
     }
 
@@ -58,22 +107,13 @@ struct YAML::convert<cpak::Dependency> {
     decode(const Node& node, cpak::Dependency& rhs) {
         cpak::validateDependencySchema(node);
         if (node.IsScalar()) {
-            const auto& identity =
-                cpak::identityFromString(node.as<std::string>());
-
-            rhs.name = identity.name;
-            rhs.gpid = identity.gpid;
-            rhs.semv = identity.semv;
+            cpak::decodeDependencyID(node.as<std::string>(), node.Mark(), rhs);
             return true;
         }
 
         // Decode mapped dependency.
-        const auto& identity =
-            cpak::identityFromString(node["cpakid"].as<std::string>());
-
-        rhs.name = identity.name;
-        rhs.gpid = identity.gpid;
-        rhs.semv = identity.semv;
+        cpak::decodeDependencyID(node["cpakid"].as<std::string>(),
+                                 node["cpakid"].Mark(), rhs);
         if (node["remote"])
             rhs.remote = node["remote"].as<cpak::Repository>();
         return true;
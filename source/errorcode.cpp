@@ -52,6 +52,26 @@ struct CPakBuildErrorCategory : public std::error_category {
             return cpak::errc::kInterfaceNotFoundMessage.data();
         case cpak::errc::interfaceNameCollision:
             return cpak::errc::kInterfaceNameCollisionMessage.data();
+        case cpak::errc::cacheMiss:
+            return cpak::errc::kCacheMissMessage.data();
+        case cpak::errc::cacheStoreFailed:
+            return cpak::errc::kCacheStoreFailedMessage.data();
+        case cpak::errc::buildTargetNotFound:
+            return cpak::errc::kBuildTargetNotFoundMessage.data();
+        case cpak::errc::noWorkspaceAtPath:
+            return cpak::errc::kNoWorkspaceAtPathMessage.data();
+        case cpak::errc::invalidWorkspace:
+            return cpak::errc::kInvalidWorkspaceMessage.data();
+        case cpak::errc::invalidLockfile:
+            return cpak::errc::kInvalidLockfileMessage.data();
+        case cpak::errc::lockfileMismatch:
+            return cpak::errc::kLockfileMismatchMessage.data();
+        case cpak::errc::versionConflict:
+            return cpak::errc::kVersionConflictMessage.data();
+        case cpak::errc::vendorFailed:
+            return cpak::errc::kVendorFailedMessage.data();
+        case cpak::errc::archiveFetchFailed:
+            return cpak::errc::kArchiveFetchFailedMessage.data();
         default: return "Unknown error";
         }
     }
@@ -28,6 +28,16 @@ enum values : std::uint16_t {
     libraryNotFound,
     interfaceNotFound,
     interfaceNameCollision,
+    cacheMiss,
+    cacheStoreFailed,
+    buildTargetNotFound,
+    noWorkspaceAtPath,
+    invalidWorkspace,
+    invalidLockfile,
+    lockfileMismatch,
+    versionConflict,
+    vendorFailed,
+    archiveFetchFailed,
 
     // When all else fails, use this, who knows what the problem could be..
     unknown = std::numeric_limits<std::uint16_t>::max(),
@@ -38,7 +48,7 @@ enum values : std::uint16_t {
 
     // Define beginning and end of build range.
     build_begin = dependencyNotFound,
-    build_end   = interfaceNameCollision,
+    build_end   = archiveFetchFailed,
 };
 
 
@@ -57,6 +67,16 @@ constexpr std::string_view kInstallTargetNotFoundMessage = "Install target not f
 constexpr std::string_view kLibraryNotFoundMessage = "Library not found";
 constexpr std::string_view kInterfaceNotFoundMessage = "Interface not found";
 constexpr std::string_view kInterfaceNameCollisionMessage = "Interface name collision";
+constexpr std::string_view kCacheMissMessage = "Cache miss";
+constexpr std::string_view kCacheStoreFailedMessage = "Cache store failed";
+constexpr std::string_view kBuildTargetNotFoundMessage = "Build target not found";
+constexpr std::string_view kNoWorkspaceAtPathMessage = "No CPakWorkspace at path";
+constexpr std::string_view kInvalidWorkspaceMessage = "Invalid CPakWorkspace";
+constexpr std::string_view kInvalidLockfileMessage = "Invalid CPakFile.lock";
+constexpr std::string_view kLockfileMismatchMessage = "Dependency does not match CPakFile.lock";
+constexpr std::string_view kVersionConflictMessage = "No versions satisfy the dependency constraints";
+constexpr std::string_view kVendorFailedMessage = "Failed to vendor dependency";
+constexpr std::string_view kArchiveFetchFailedMessage = "Failed to fetch source archive";
 
 } // namespace cpak::errc
 
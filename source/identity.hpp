@@ -17,6 +17,249 @@ struct Identity {
 };
 
 
+/// @brief   The components of a CPakID, or why it could not be parsed.
+/// @details The components view into the parsed string, so it must outlive
+///          the result.
+struct CPakIDParseResult {
+    std::string_view gpid;
+    std::string_view name;
+    std::string_view version;
+
+    std::size_t errorPosition = std::string_view::npos;
+    std::string_view error;
+
+    /// @brief  Checks whether the CPakID was parsed.
+    /// @return True if the CPakID is valid, false otherwise.
+    constexpr bool
+    isValid() const noexcept {
+        return errorPosition == std::string_view::npos;
+    }
+};
+
+
+namespace detail {
+
+
+constexpr bool
+isLowerAlphaNumeric(char character) noexcept {
+    return (character >= 'a' && character <= 'z') ||
+           (character >= '0' && character <= '9');
+}
+
+
+constexpr bool
+isDigit(char character) noexcept {
+    return character >= '0' && character <= '9';
+}
+
+
+constexpr bool
+isIdentifierCharacter(char character) noexcept {
+    return isLowerAlphaNumeric(character) || character == '-' ||
+           (character >= 'A' && character <= 'Z');
+}
+
+
+/// @brief  Scans a group id or name starting at the given position.
+/// @param  text The text being parsed.
+/// @param  position The position to start at, moved past the segment.
+/// @param  result Receives the error if the segment is invalid.
+/// @return The segment that was scanned.
+constexpr std::string_view
+scanCPakIDSegment(std::string_view text,
+                  std::size_t& position,
+                  CPakIDParseResult& result) noexcept {
+    constexpr std::size_t kMaxSegmentLength = 39;
+
+    const auto start = position;
+    while (position < text.size() && text[position] != '/' &&
+           text[position] != '@') {
+        const auto character = text[position];
+        const auto isHyphen  = character == '-';
+        if (!isLowerAlphaNumeric(character) && !isHyphen) {
+            result.errorPosition = position;
+            result.error = "expected a lower case letter, digit or hyphen";
+            return {};
+        }
+
+        // Hyphens only go between letters and digits.
+        if (isHyphen && (position == start || text[position - 1] == '-')) {
+            result.errorPosition = position;
+            result.error = "hyphens must follow a letter or digit";
+            return {};
+        }
+
+        if (position - start == kMaxSegmentLength) {
+            result.errorPosition = position;
+            result.error = "group ids and names are at most 39 characters";
+            return {};
+        }
+
+        ++position;
+    }
+
+    if (position == start) {
+        result.errorPosition = position;
+        result.error = "expected a group id or name";
+    } else if (text[position - 1] == '-') {
+        result.errorPosition = position - 1;
+        result.error = "group ids and names cannot end with a hyphen";
+    }
+
+    return text.substr(start, position - start);
+}
+
+
+/// @brief  Scans dot separated semantic version identifiers.
+/// @param  text The text being parsed.
+/// @param  position The position to start at, moved past the identifiers.
+/// @param  numericLeadingZeros Whether numeric identifiers may start with 0.
+/// @param  result Receives the error if an identifier is invalid.
+constexpr void
+scanVersionIdentifiers(std::string_view text,
+                       std::size_t& position,
+                       bool numericLeadingZeros,
+                       CPakIDParseResult& result) noexcept {
+    while (true) {
+        const auto start = position;
+        auto isNumeric   = true;
+        while (position < text.size() && isIdentifierCharacter(text[position])) {
+            isNumeric = isNumeric && isDigit(text[position]);
+            ++position;
+        }
+
+        if (position == start) {
+            result.errorPosition = position;
+            result.error = "expected a letter, digit or hyphen";
+            return;
+        }
+
+        if (isNumeric && !numericLeadingZeros && text[start] == '0' &&
+            position - start > 1) {
+            result.errorPosition = start;
+            result.error = "numeric identifiers cannot have leading zeros";
+            return;
+        }
+
+        if (position == text.size() || text[position] != '.') return;
+        ++position;
+    }
+}
+
+
+/// @brief  Scans a version number, which cannot have leading zeros.
+/// @param  text The text being parsed.
+/// @param  position The position to start at, moved past the number.
+/// @param  result Receives the error if the number is invalid.
+constexpr void
+scanVersionNumber(std::string_view text,
+                  std::size_t& position,
+                  CPakIDParseResult& result) noexcept {
+    const auto start = position;
+    while (position < text.size() && isDigit(text[position])) ++position;
+
+    if (position == start) {
+        result.errorPosition = position;
+        result.error = "expected a version number";
+    } else if (text[start] == '0' && position - start > 1) {
+        result.errorPosition = start;
+        result.error = "version numbers cannot have leading zeros";
+    }
+}
+
+
+} // namespace detail
+
+
+/// @brief   Parses and validates a CPakID without allocating.
+/// @details The expected form is \c gpid/name@major.minor.patch, optionally
+///          followed by a pre-release and build metadata. When a branch is
+///          used, the version is a branch name made of dot separated
+///          identifiers instead.
+/// @param   cpakid The CPakID to parse.
+/// @param   useBranch Whether the version is a branch name.
+/// @return  The components of the CPakID, or the position and reason it is
+///          invalid.
+constexpr CPakIDParseResult
+parseCPakID(std::string_view cpakid, bool useBranch = false) noexcept {
+    CPakIDParseResult result;
+    std::size_t position = 0;
+
+    const auto expect = [&](char expected, std::string_view error) {
+        if (position < cpakid.size() && cpakid[position] == expected) {
+            ++position;
+            return true;
+        }
+
+        result.errorPosition = position;
+        result.error         = error;
+        return false;
+    };
+
+    result.gpid = detail::scanCPakIDSegment(cpakid, position, result);
+    if (!result.isValid() || !expect('/', "expected '/' after the group id"))
+        return result;
+
+    result.name = detail::scanCPakIDSegment(cpakid, position, result);
+    if (!result.isValid() || !expect('@', "expected '@' after the name"))
+        return result;
+
+    const auto versionStart = position;
+    if (useBranch) {
+        detail::scanVersionIdentifiers(cpakid, position, true, result);
+    } else {
+        detail::scanVersionNumber(cpakid, position, result);
+        if (result.isValid() && expect('.', "expected '.' after the major version"))
+            detail::scanVersionNumber(cpakid, position, result);
+        if (result.isValid() && expect('.', "expected '.' after the minor version"))
+            detail::scanVersionNumber(cpakid, position, result);
+        if (result.isValid() && position < cpakid.size() && cpakid[position] == '-')
+            detail::scanVersionIdentifiers(cpakid, ++position, false, result);
+        if (result.isValid() && position < cpakid.size() && cpakid[position] == '+')
+            detail::scanVersionIdentifiers(cpakid, ++position, true, result);
+    }
+
+    if (!result.isValid()) return result;
+    if (position != cpakid.size()) {
+        result.errorPosition = position;
+        result.error         = "unexpected character in version";
+        return result;
+    }
+
+    result.version = cpakid.substr(versionStart);
+    return result;
+}
+
+
+/// @brief   Validates the given CPakID.
+/// @details The mark of the thrown exception points at the offending
+///          character of the CPakID.
+/// @param   cpakid The CPakID to validate.
+/// @param   mark Where the CPakID starts in the document.
+inline void
+validateCPakID(std::string_view cpakid, YAML::Mark mark) {
+    const auto parsed = parseCPakID(cpakid);
+    if (parsed.isValid()) return;
+
+    if (mark.pos != -1) {
+        mark.pos    += static_cast<int>(parsed.errorPosition);
+        mark.column += static_cast<int>(parsed.errorPosition);
+    }
+
+    throw YAML::Exception(mark, fmt::format(
+        "Identity is not a valid CPakID, {} at column {}.", parsed.error,
+        parsed.errorPosition + 1));
+}
+
+
+/// @brief Validates the CPakID in the given scalar node.
+/// @param node The node containing the CPakID.
+inline void
+validateCPakID(const YAML::Node& node) {
+    validateCPakID(node.as<std::string>(), node.Mark());
+}
+
+
 inline void
 validateIdentitySchema(const YAML::Node& node) {
     // Get identity as mapping or scalar.
@@ -47,21 +290,8 @@ validateIdentitySchema(const YAML::Node& node) {
     }
 
 
-    constexpr std::string_view kIdentityRegex =
-        "^[a-z\\d](?:[a-z\\d]|-(?=[a-z\\d])){0,38}/"
-        "[a-z\\d](?:[a-z\\d]|-(?=[a-z\\d])){0,38}@"
-        "(0|[1-9]\\d*)\\.(0|[1-9]\\d*)\\.(0|[1-9]\\d*)"
-        "(?:-((?:0|[1-9]\\d*|\\d*[a-zA-Z-][0-9a-zA-Z-]*)(?:\\.(?:0|[1-9]\\d*|"
-        "\\d*[a-zA-Z-][0-9a-zA-Z-]*))*))"
-        "?(?:\\+([0-9a-zA-Z-]+(?:\\.[0-9a-zA-Z-]+)*))?$";
-
-    static std::regex identityRegex(kIdentityRegex.data());
-
-    // If the identity is a scalar, check it with a regex.
-    // We expect the form to be gpid/name@semv.
-    std::cmatch match;
-    if (!std::regex_match(node.as<std::string>().c_str(), match, identityRegex))
-        throw YAML::Exception(node.Mark(), "Identity is not a valid CPakID.");
+    // If the identity is a scalar, we expect the form to be gpid/name@semv.
+    if (node.IsScalar()) validateCPakID(node);
 }
 
 
@@ -70,33 +300,18 @@ validateIdentitySchema(const YAML::Node& node) {
 /// @return An Identity struct containing the CPakID components.
 inline Identity
 identityFromString(std::string_view cpakid, bool useBranch = false) {
+    const auto parsed = parseCPakID(cpakid, useBranch);
+    if (!parsed.isValid())
+        throw std::runtime_error(fmt::format(
+            "Invalid CPakID '{}', {} at column {}.", cpakid, parsed.error,
+            parsed.errorPosition + 1));
+
     Identity result;
-    std::string token;
-    std::istringstream iss(cpakid.data());
-
-    // Split the CPakID into its components.
-    // Format: gpid/name@semv
-    if (cpakid.find_first_of('/') == std::string::npos)
-        throw std::runtime_error(
-            "Invalid CPakID format, missing group id or name.");
-    std::getline(iss, token, '/');
-    result.gpid = token;
-
-    if (cpakid.find_first_of('@') == std::string::npos)
-        throw std::runtime_error(
-            "Invalid CPakID format, missing name or version.");
-    std::getline(iss, token, '@');
-    result.name = token;
-
-    std::getline(iss, token);
-    if (token.empty())
-        throw std::runtime_error("Invalid CPakID format, missing version.");
-    
-    const auto versionString = useBranch
-        ? "0.0.0-" + token
-        : token;
-
-    result.semv = version::parse(versionString);
+    result.gpid = parsed.gpid;
+    result.name = parsed.name;
+    result.semv = useBranch
+        ? version::parse("0.0.0-" + std::string(parsed.version))
+        : version::parse(std::string(parsed.version));
     result.versionIsBranch = useBranch;
     return result;
 }
@@ -0,0 +1,132 @@
+#pragma once
+#include "common.hpp"
+#include "identity.hpp"
+
+namespace cpak {
+
+
+/// @brief   The exact revision a dependency was resolved to.
+/// @details The tree is recorded along with the commit so a checkout can be
+///          verified without trusting the history it came from. Dependencies
+///          downloaded as source archives have no history, the BLAKE3 digest
+///          of the archive is recorded instead.
+struct LockedDependency {
+    std::string commit;
+    std::string tree;
+    std::string archive;
+
+    bool
+    operator==(const LockedDependency&) const = default;
+};
+
+
+/// @brief   Contains the contents of a lockfile.
+/// @details Dependencies are keyed by their CPakID, and kept ordered so the
+///          file only changes when a resolved revision does.
+struct Lockfile {
+    std::map<std::string, LockedDependency> dependencies;
+
+    bool
+    operator==(const Lockfile&) const = default;
+};
+
+
+/// @brief   Checks whether a string is a hash written out in hex.
+/// @details Git names objects by SHA-1 or SHA-256, BLAKE3 digests are as long
+///          as the latter.
+/// @param   hash The string to check.
+/// @param   sha1 Whether a SHA-1 hash is accepted as well.
+/// @return  True if the string is a hash.
+inline bool
+isHexHash(std::string_view hash, bool sha1) noexcept {
+    if (hash.size() != 64 && (!sha1 || hash.size() != 40)) return false;
+    return std::all_of(hash.begin(), hash.end(), [](char character) {
+        return std::isxdigit(static_cast<unsigned char>(character)) != 0;
+    });
+}
+
+
+inline void
+validateLockfileSchema(const YAML::Node& node) {
+    if (!node.IsMap())
+        throw YAML::ParserException(node.Mark(), "Lockfile is not a map.");
+
+    if (!node["dependencies"]) return;
+    if (!node["dependencies"].IsMap())
+        throw YAML::ParserException(node["dependencies"].Mark(), "Lockfile dependencies must be a map.");
+
+    for (const auto& entry : node["dependencies"]) {
+        if (!entry.first.IsScalar())
+            throw YAML::ParserException(entry.first.Mark(), "Locked dependency must be keyed by its CPakID.");
+        validateCPakID(entry.first.Scalar(), entry.first.Mark());
+        try {
+            identityFromString(entry.first.Scalar());
+        } catch (const std::exception&) {
+            // Version numbers too large to hold.
+            throw YAML::ParserException(entry.first.Mark(), "Locked dependency version is out of range.");
+        }
+
+        const auto& locked = entry.second;
+        if (locked.IsMap() && locked["archive"]) {
+            if (!locked["archive"].IsScalar() ||
+                !isHexHash(locked["archive"].Scalar(), false))
+                throw YAML::ParserException(locked.Mark(), "Locked archive must be a digest.");
+            continue;
+        }
+
+        if (!locked.IsMap() || !locked["commit"] || !locked["tree"])
+            throw YAML::ParserException(locked.Mark(), "Locked dependency must have a commit and a tree.");
+
+        if (!locked["commit"].IsScalar() || !locked["tree"].IsScalar() ||
+            !isHexHash(locked["commit"].Scalar(), true) ||
+            !isHexHash(locked["tree"].Scalar(), true))
+            throw YAML::ParserException(locked.Mark(), "Locked commit and tree must be hashes.");
+    }
+}
+
+
+} // namespace cpak
+
+
+template<>
+struct YAML::convert<cpak::Lockfile> {
+    static Node
+    encode(const cpak::Lockfile& rhs) {
+        Node node;
+        for (const auto& [cpakid, locked] : rhs.dependencies) {
+            if (!locked.archive.empty()) {
+                node["dependencies"][cpakid]["archive"] = locked.archive;
+                continue;
+            }
+
+            node["dependencies"][cpakid]["commit"] = locked.commit;
+            node["dependencies"][cpakid]["tree"]   = locked.tree;
+        }
+
+        return node;
+    }
+
+    static bool
+    decode(const YAML::Node& node, cpak::Lockfile& rhs) {
+        if (node.IsNull()) return true; // Nothing is locked.
+
+        cpak::validateLockfileSchema(node);
+        if (!node["dependencies"]) return true;
+
+        for (const auto& entry : node["dependencies"]) {
+            if (entry.second["archive"]) {
+                rhs.dependencies[entry.first.as<std::string>()] = {
+                    .archive = entry.second["archive"].as<std::string>(),
+                };
+                continue;
+            }
+
+            rhs.dependencies[entry.first.as<std::string>()] = {
+                .commit = entry.second["commit"].as<std::string>(),
+                .tree   = entry.second["tree"].as<std::string>(),
+            };
+        }
+
+        return true;
+    }
+};
@@ -1,8 +1,12 @@
+#include "cache.hpp"
+#include "decoder.hpp"
 #include "errorcode.hpp"
 #include "management.hpp"
 #include "option.hpp"
+#include "snapshot.hpp"
 #include "target.hpp"
 #include "utilities/checksum.hpp"
+#include "utilities/hasher.hpp"
 #include "utilities/stropts.hpp"
 
 
@@ -26,7 +30,8 @@ extern void
 interpolateOptions(CPakFile& cpakfile) noexcept;
 
 extern std::tuple<std::optional<cpak::CPakFile>, std::error_code>
-internalLoadCPakFile(const std::filesystem::path& projectPath) noexcept;
+internalLoadCPakFile(const std::filesystem::path& projectPath,
+                     bool interpolate = true) noexcept;
 
 
 std::tuple<std::optional<cpak::CPakFile>, std::error_code>
@@ -69,8 +74,20 @@ cpak::management::loadCPakFile(
     logger->info("Found CPakfile '{}'", cpakfilePath.c_str());
     logger->debug("Loading CPakfile '{}'", cpakfilePath.c_str());
 
-    // Read file into string so we can use YAML::Marks to report errors.
+    // A snapshot of the same contents skips reading and decoding the YAML.
     std::optional<CPakFile> cpakfile;
+    std::string snapshotKey;
+    if (auto [digest, result] = cache::FileHashCache::shared().hash(cpakfilePath);
+        result.value() == errc::success) {
+        snapshotKey = snapshot::snapshotKey(digest);
+        std::tie(cpakfile, result) = snapshot::loadSnapshot(snapshotKey);
+        if (cpakfile.has_value()) {
+            logger->debug("Loaded snapshot '{}'", snapshotKey);
+            return std::make_tuple(cpakfile, loadStatus);
+        }
+    }
+
+    // Read file into string so we can use YAML::Marks to report errors.
     std::ifstream cpakfileStream(cpakfilePath);
     if (!cpakfileStream.is_open()) {
         // TODO: replace this error with something more appropriate.
@@ -86,7 +103,11 @@ cpak::management::loadCPakFile(
 
     try {
         // Load CPakFile and set paths.
-        cpakfile = YAML::Load(temporaryStream.str()).as<CPakFile>();
+        std::istringstream contentsStream(cpakfileAsString);
+        cpakfile = decoder::decodeCPakFile(contentsStream);
+        if (!snapshotKey.empty() &&
+            snapshot::storeSnapshot(snapshotKey, *cpakfile).value() != errc::success)
+            logger->warn("Failed to store snapshot '{}'", snapshotKey);
     } catch (const YAML::Exception& e) {
         logger->error(fmt::format(fmt::fg(fmt::terminal_color::bright_red),
             "Failed to load CPakfile '{}'", cpakfilePath.c_str()));
@@ -158,25 +179,253 @@ cpak::management::loadCPakFile(
         return std::make_tuple(cpakfile,
                                result); // Let the caller handle the error.
 
-    // Update options, then interpolate them.
+    // Update options and paths, then interpolate the options.
     ::updateOptions(*cpakfile, options);
-    ::interpolateOptions(*cpakfile);
-
-    // Update paths.
     cpakfile->projectPath = projectPath;
     cpakfile->buildPath   = projectPath / ".cpak" / ::util::checksum(*cpakfile);
+    ::interpolateOptions(*cpakfile);
+    return std::make_tuple(cpakfile, result);
+}
+
+
+std::tuple<std::optional<cpak::Workspace>, std::error_code>
+cpak::management::loadWorkspace(
+    const std::filesystem::path& workspacePath) noexcept {
+    auto logger = spdlog::get("cpak");
+    const auto manifestPath = workspacePath / "CPakWorkspace";
+    if (!std::filesystem::exists(manifestPath))
+        return { std::nullopt, make_error_code(errc::noWorkspaceAtPath) };
+
+    logger->info("Found CPakWorkspace '{}'", manifestPath.c_str());
+    try {
+        auto workspace = YAML::LoadFile(manifestPath).as<Workspace>();
+        workspace.workspacePath = workspacePath;
+        return { workspace, make_error_code(errc::success) };
+    } catch (const YAML::Exception& e) {
+        logger->error(fmt::format(fmt::fg(fmt::terminal_color::bright_red),
+            "Error at line {}, column {} of {}: {}", e.mark.line + 1,
+            e.mark.column + 1, manifestPath.c_str(), e.msg));
+        return { std::nullopt, make_error_code(errc::invalidWorkspace) };
+    }
+}
+
+
+/// @brief   Runs a git command and reads its output.
+/// @details The command goes through the shell, so the arguments are quoted,
+///          some of them come from the CPakFiles of dependencies.
+/// @param   arguments The arguments to pass to git.
+/// @return  The trimmed output of the command, and whether it succeeded.
+std::tuple<string, bool>
+readGit(vector<string> arguments) noexcept {
+    for (auto& argument : arguments) argument = util::quoteShellArgument(argument);
+    arguments.insert(arguments.begin(), "git");
+    auto gitCommand = subprocess::Popen(
+        arguments,
+        subprocess::output{ subprocess::PIPE },
+        subprocess::error{ subprocess::PIPE }, subprocess::shell{ true });
+
+    auto [output, error] = gitCommand.communicate();
+    return std::make_tuple(util::trim(string(output.buf.data(), output.length)),
+                           gitCommand.retcode() == cpak::errc::success);
+}
+
+
+/// @brief  Runs a git command, discarding its output.
+/// @param  arguments The arguments to pass to git.
+/// @return True if the command succeeded.
+bool
+runGit(vector<string> arguments) noexcept {
+    return std::get<1>(readGit(std::move(arguments)));
+}
+
+
+/// @brief   Gets the path of the mirror for a remote.
+/// @details Mirrors are laid out like the remote URL without its scheme and
+///          credentials, so every remote gets its own bare repository.
+/// @param   remoteURL The URL of the remote.
+/// @return  The path of the mirror under \c ~/.cpak/mirrors.
+std::filesystem::path
+findMirrorPath(const string& remoteURL) noexcept {
+#if _WIN32
+    auto mirrorPath = std::filesystem::path(std::getenv("USERPROFILE"));
+#else
+    auto mirrorPath = std::filesystem::path(std::getenv("HOME"));
+#endif
+
+    auto relative = remoteURL;
+    if (const auto scheme = relative.find("://"); scheme != string::npos)
+        relative.erase(0, scheme + 3);
+    if (const auto at = relative.find('@'); at < relative.find('/'))
+        relative.erase(0, at + 1);
+
+    std::replace(relative.begin(), relative.end(), ':', '/');
+    relative.erase(0, relative.find_first_not_of('/'));
+    if (!relative.ends_with(".git")) relative += ".git";
+    return mirrorPath / ".cpak" / "mirrors" / relative;
+}
+
+
+/// @brief  Gets the mutex that serializes git operations on a mirror.
+/// @param  mirrorPath The path of the mirror.
+/// @return The mutex of the mirror.
+std::mutex&
+mirrorMutex(const std::filesystem::path& mirrorPath) noexcept {
+    static std::mutex mutex;
+    static std::unordered_map<string, std::unique_ptr<std::mutex>> mutexes;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& mirrorMutex = mutexes[mirrorPath.string()];
+    if (mirrorMutex == nullptr) mirrorMutex = std::make_unique<std::mutex>();
+    return *mirrorMutex;
+}
+
+
+/// @brief  Checks whether a repository has a commit.
+/// @param  repositoryPath The path of the repository or one of its worktrees.
+/// @param  commit The hash of the commit.
+/// @return True if the commit is in the repository.
+bool
+hasCommit(const std::filesystem::path& repositoryPath,
+          const string& commit) noexcept {
+    return runGit({ "-C", repositoryPath, "cat-file", "-e", commit + "^{commit}" });
+}
+
+
+/// @brief  Checks that a checkout has the tree recorded in the lockfile.
+/// @param  dependencyPath The path of the checkout.
+/// @param  locked The revision recorded in the lockfile.
+/// @return The status code for the operation.
+std::error_code
+verifyLocked(const std::filesystem::path& dependencyPath,
+             const cpak::LockedDependency& locked) noexcept {
+    const auto [tree, found] =
+        readGit({ "-C", dependencyPath, "show", "-s", "--format=%T", "HEAD" });
+    if (found && tree == locked.tree)
+        return cpak::make_error_code(cpak::errc::success);
+
+    spdlog::get("cpak")->error("Checkout '{}' does not match the locked tree {}",
+                               dependencyPath.c_str(), locked.tree);
+    return cpak::make_error_code(cpak::errc::lockfileMismatch);
+}
+
+
+/// @brief   Checks out only what a project needs to be built and installed.
+/// @details The CPakFile sits at the top of the checkout, which a sparse
+///          checkout always has, so it is loaded first to find the rest.
+/// @param   dependencyPath The path of the checkout.
+/// @return  The loaded project, and the status code for the operation.
+std::tuple<std::optional<cpak::CPakFile>, std::error_code>
+narrowCheckout(const std::filesystem::path& dependencyPath) noexcept {
+    auto [cpakfile, result] = internalLoadCPakFile(dependencyPath);
+    if (result.value() != cpak::errc::success)
+        return std::make_tuple(cpakfile, result); // Let the caller handle the error.
+
+    vector<string> arguments{ "-C", dependencyPath, "sparse-checkout" };
+    const auto directories = cpak::management::findSparseDirectories(*cpakfile);
+    if (directories == std::nullopt) {
+        arguments.push_back("disable");
+    } else {
+        arguments.insert(arguments.end(), { "set", "--cone", "--" });
+        arguments.insert(arguments.end(), directories->begin(), directories->end());
+    }
+
+    spdlog::get("cpak")->debug("Checking out {} directories of '{}'",
+                               directories ? std::to_string(directories->size()) : "all",
+                               dependencyPath.c_str());
+    if (!runGit(arguments))
+        return std::make_tuple(std::nullopt,
+                               cpak::make_error_code(cpak::errc::gitCloneFailed));
+
     return std::make_tuple(cpakfile, result);
 }
 
 
+/// @brief  Gets the path of the file recording the archive a checkout was
+///         extracted from.
+/// @param  dependencyPath The path of the checkout.
+/// @return The path of the record.
+std::filesystem::path
+archiveRecordPath(const std::filesystem::path& dependencyPath) noexcept {
+    return dependencyPath / ".cpak-archive";
+}
+
+
+/// @brief  Reads the digest of the archive a checkout was extracted from.
+/// @param  dependencyPath The path of the checkout.
+/// @return The digest, or nothing if the checkout was cloned.
+std::optional<string>
+readArchiveDigest(const std::filesystem::path& dependencyPath) noexcept {
+    std::ifstream record(archiveRecordPath(dependencyPath));
+    string digest;
+    if (!record.is_open() || !std::getline(record, digest)) return std::nullopt;
+    return util::trim(std::move(digest));
+}
+
+
+/// @brief   Moves an existing checkout to the revision in the lockfile.
+/// @details A checkout already at the locked commit is used as is, without
+///          talking to the remote. Otherwise the commit is fetched only if the
+///          repository doesn't have it yet.
+/// @param   dependencyPath The path of the checkout.
+/// @param   locked The revision recorded in the lockfile.
+/// @return  The status code for the operation.
+std::error_code
+checkoutLocked(const std::filesystem::path& dependencyPath,
+               const cpak::LockedDependency& locked) noexcept {
+    // An extracted archive can't be moved to another revision, only checked.
+    auto logger       = spdlog::get("cpak");
+    const auto digest = readArchiveDigest(dependencyPath);
+    if (digest != std::nullopt || !locked.archive.empty()) {
+        if (digest == locked.archive) return cpak::make_error_code(cpak::errc::success);
+
+        logger->error("Checkout '{}' does not match the locked archive",
+                      dependencyPath.c_str());
+        return cpak::make_error_code(cpak::errc::lockfileMismatch);
+    }
+
+    const auto [head, found] =
+        readGit({ "-C", dependencyPath, "rev-parse", "HEAD" });
+    if (!found) {
+        logger->warn("Cannot lock '{}', it is not a git checkout",
+                     dependencyPath.c_str());
+        return cpak::make_error_code(cpak::errc::success);
+    }
+
+    if (head == locked.commit) return cpak::make_error_code(cpak::errc::success);
+
+    logger->info("Checking out locked commit {} in '{}'", locked.commit,
+                 dependencyPath.c_str());
+    // Worktrees fetch into the mirror they share with the other versions.
+    const auto [remoteURL, _] =
+        readGit({ "-C", dependencyPath, "config", "--get", "remote.origin.url" });
+    {
+        std::lock_guard<std::mutex> lock(mirrorMutex(findMirrorPath(remoteURL)));
+        if (!hasCommit(dependencyPath, locked.commit) &&
+            !runGit({ "-C", dependencyPath, "fetch", "--quiet", "origin", locked.commit }))
+            return cpak::make_error_code(cpak::errc::lockfileMismatch);
+    }
+
+    if (!runGit({ "-C", dependencyPath, "checkout", "--quiet", "--detach", locked.commit }))
+        return cpak::make_error_code(cpak::errc::lockfileMismatch);
+
+    // The locked commit may need other directories.
+    const auto result = verifyLocked(dependencyPath, locked);
+    if (result.value() != cpak::errc::success) return result;
+    return std::get<1>(narrowCheckout(dependencyPath));
+}
+
+
 std::tuple<std::optional<cpak::CPakFile>, std::error_code>
-cpak::management::loadDependency(const cpak::Dependency& dependency) noexcept {
+cpak::management::loadDependency(const cpak::Dependency& dependency,
+                                 const cpak::LockedDependency* locked) noexcept {
     std::optional<CPakFile> cpakfile{ std::nullopt };
 
     // If the path isn't there, we need to clone the dependency.
     auto [path, result] = findDependencyPath(dependency);
     if (result.value() == cpak::errc::pathDoesNotExist)
-        std::tie(cpakfile, result) = cloneDependency(dependency, path);
+        std::tie(cpakfile, result) = cloneDependency(dependency, path, locked);
+    else if (result.value() == cpak::errc::success && locked != nullptr)
+        result = checkoutLocked(path, *locked);
     if (result.value() == cpak::errc::success)
         std::tie(cpakfile, result) = internalLoadCPakFile(path);
 
@@ -185,32 +434,64 @@ cpak::management::loadDependency(const cpak::Dependency& dependency) noexcept {
 }
 
 
-std::tuple<std::optional<cpak::CPakFile>, std::error_code>
-cpak::management::cloneDependency(const cpak::Dependency& dependency,
-                                  const std::string& dependencyPath) noexcept {
-    using namespace std::string_literals;
+/// @brief  Finds the reference of a version in the output of ls-remote.
+/// @param  listing The output of \c git \c ls-remote.
+/// @param  version The tag or branch to look for.
+/// @return The full name of the reference, tags win over branches, or an
+///         empty string if the remote has neither.
+string
+findRemoteReference(const string& listing, const string& version) noexcept {
+    const auto tag    = "refs/tags/" + version;
+    const auto branch = "refs/heads/" + version;
 
-    // TODO: account for version.
-    auto logger    = spdlog::get("cpak");
-    auto remoteURL = dependency.remote != std::nullopt
-                         ? dependency.remote->address
-                         : "https://github.com"s;
+    std::istringstream lines(listing);
+    string found;
+    for (string line; std::getline(lines, line);) {
+        const auto reference = util::trim(line.substr(line.find('\t') + 1));
+        if (reference == tag) return tag;
+        if (reference == branch) found = branch;
+    }
 
-    logger->info("Cloning dependency '{}'", dependency.name.c_str());
-    remoteURL += "/"s + dependency.gpid + "/"s + dependency.name;
+    return found;
+}
 
+
+/// @brief   Checks whether a checkout is a worktree of the given mirror.
+/// @details Checkouts made before versions shared a mirror are standalone
+///          clones, which have their own objects and are not worktrees.
+/// @param   dependencyPath The path of the checkout.
+/// @param   mirrorPath The path of the mirror.
+/// @return  True if the checkout shares the objects of the mirror.
+bool
+isMirrorWorktree(const std::filesystem::path& dependencyPath,
+                 const std::filesystem::path& mirrorPath) noexcept {
+    const auto [commonPath, found] = readGit(
+        { "-C", dependencyPath, "rev-parse", "--path-format=absolute",
+          "--git-common-dir" });
+    if (!found) return false;
+
+    std::error_code status;
+    return fs::equivalent(commonPath, mirrorPath, status) && !status;
+}
+
+
+/// @brief  Fetches the reference of a version into a mirror.
+/// @param  dependency The dependency to fetch.
+/// @param  remoteURL The URL of the remote of the dependency.
+/// @param  mirrorPath The path of the mirror.
+/// @return The full name of the fetched reference, and the status code.
+std::tuple<string, std::error_code>
+fetchVersion(const cpak::Dependency& dependency,
+             const string& remoteURL,
+             const std::filesystem::path& mirrorPath) noexcept {
     // Check if remote has repo.
+    auto logger = spdlog::get("cpak");
     logger->debug("Checking if remote '{}' exists", remoteURL.c_str());
-    auto gitLsRemoteCommand = subprocess::Popen(
-        { "git", "ls-remote", remoteURL },
-        subprocess::output{ subprocess::PIPE },
-        subprocess::error{ subprocess::PIPE }, subprocess::shell{ true });
-
-    auto [output, error] = gitLsRemoteCommand.communicate();
-    if (gitLsRemoteCommand.retcode() != errc::success) {
+    const auto [listing, found] = readGit({ "ls-remote", remoteURL });
+    if (!found) {
         logger->debug("Did not find remote '{}'", remoteURL.c_str());
-        return std::make_tuple(std::nullopt,
-                               make_error_code(errc::gitRemoteNotFound));
+        return std::make_tuple(string(),
+                               cpak::make_error_code(cpak::errc::gitRemoteNotFound));
     }
 
     const auto version = dependency.versionIsBranch
@@ -219,29 +500,651 @@ cpak::management::cloneDependency(const cpak::Dependency& dependency,
 
     // Check if version/branch exists.
     logger->debug("Checking if version '{}' exists", version);
-    const auto outputStr = std::string(output.buf.begin(), output.buf.end());
-    if (outputStr.find(version) == std::string::npos) {
+    const auto reference = findRemoteReference(listing, version);
+    if (reference.empty()) {
         logger->debug("Did not find version '{}'", version);
-        return std::make_tuple(std::nullopt,
-                               make_error_code(errc::gitRemoteVersionNotFound));
+        return std::make_tuple(string(),
+                               cpak::make_error_code(cpak::errc::gitRemoteVersionNotFound));
     }
 
-    const auto versionFlag = "-b " + version;
-    const auto depthFlag   = "--depth=1";
+    logger->debug("Fetching '{}' into mirror '{}'", reference,
+                  mirrorPath.c_str());
+    const auto refspec = fmt::format("+{0}:{0}", reference);
+    if (!runGit({ "-C", mirrorPath, "fetch", "--quiet", "origin", refspec }))
+        return std::make_tuple(string(),
+                               cpak::make_error_code(cpak::errc::gitCloneFailed));
+
+    return std::make_tuple(reference, cpak::make_error_code(cpak::errc::success));
+}
 
-    // Try clone with version/branch flag.
-    auto gitCloneCommand = subprocess::Popen(
-        { "git", "clone", depthFlag, versionFlag, remoteURL, dependencyPath },
-        subprocess::output{ subprocess::PIPE },
-        subprocess::error{ subprocess::PIPE }, subprocess::shell{ true });
 
-    std::tie(output, error) = gitCloneCommand.communicate();
-    if (gitCloneCommand.retcode() != errc::success)
+/// @brief  Gets the URL of the remote a dependency is fetched from.
+/// @param  dependency The dependency to get the remote of.
+/// @return The URL of the repository of the dependency.
+string
+findRemoteURL(const cpak::Dependency& dependency) noexcept {
+    using namespace std::string_literals;
+
+    const auto address = dependency.remote != std::nullopt
+                             ? dependency.remote->address
+                             : "https://github.com"s;
+
+    // A remote on disk is handed to git as a path. The mirror runs git from
+    // its own directory, so relative paths are made absolute first.
+    std::error_code status;
+    if (address.find("://") == string::npos && fs::is_directory(address, status))
+        return (fs::absolute(address) / dependency.gpid / dependency.name).string();
+
+    return address + "/"s + dependency.gpid + "/"s + dependency.name;
+}
+
+
+/// @brief   Gets the URL of the source archive of a dependency.
+/// @details Replaces \c {gpid}, \c {name} and \c {version} in the archive
+///          URL of the remote of the dependency.
+/// @param   dependency The dependency to get the archive of.
+/// @return  The URL of the archive.
+string
+findArchiveURL(const cpak::Dependency& dependency) noexcept {
+    auto url = dependency.remote->archive;
+    const std::pair<std::string_view, string> fields[] = {
+        { "{gpid}", dependency.gpid },
+        { "{name}", dependency.name },
+        { "{version}", dependency.semv.str() },
+    };
+
+    for (const auto& [field, value] : fields) {
+        for (auto position = url.find(field); position != string::npos;
+             position = url.find(field, position + value.size()))
+            url.replace(position, field.size(), value);
+    }
+
+    return url;
+}
+
+
+/// @brief Archive extensions and the tar options that decompress them.
+constexpr std::pair<std::string_view, std::string_view> kArchiveFormats[] = {
+    { ".tar.gz", "-z" },   { ".tgz", "-z" },   { ".tar.xz", "-J" },
+    { ".txz", "-J" },      { ".tar.bz2", "-j" }, { ".tbz2", "-j" },
+    { ".tar.zst", "--zstd" },
+};
+
+
+/// @brief  Gets the extension of an archive.
+/// @param  url The URL of the archive.
+/// @return The extension, \c .tar if the archive isn't compressed.
+string
+archiveExtension(const string& url) noexcept {
+    const auto path = url.substr(0, url.find_first_of("?#"));
+    for (const auto& [extension, _] : kArchiveFormats)
+        if (path.ends_with(extension)) return string(extension);
+    return ".tar";
+}
+
+
+/// @brief  Gets the tar option that decompresses an archive.
+/// @param  url The URL of the archive, its extension names the compression.
+/// @return The option, or an empty string for an uncompressed archive.
+string
+archiveCompression(const string& url) noexcept {
+    const auto extension = archiveExtension(url);
+    for (const auto& [known, option] : kArchiveFormats)
+        if (extension == known) return string(option);
+    return string();
+}
+
+
+/// @brief   Downloads the source archive of a dependency, extracting it while
+///          it streams in.
+/// @details The archive is hashed on its way from curl to tar, so it is never
+///          written to disk whole. The extracted files are only moved into
+///          place once both succeeded and the digest matches the locked one.
+///          The top level directory of the archive is dropped, as source
+///          archives of a tag usually keep everything in one.
+/// @param   dependency The dependency to download.
+/// @param   dependencyPath The path to extract the archive to.
+/// @param   lockedDigest The digest the archive must have, if any.
+/// @return  The digest of the archive, and the status code for the operation.
+std::tuple<string, std::error_code>
+fetchArchive(const cpak::Dependency& dependency,
+             const std::filesystem::path& dependencyPath,
+             const string& lockedDigest) noexcept {
+    auto logger            = spdlog::get("cpak");
+    const auto url         = findArchiveURL(dependency);
+    const auto partialPath = fs::path(dependencyPath.string() + ".partial");
+    const auto failed      = [&](cpak::errc::values value) {
+        std::error_code status;
+        fs::remove_all(partialPath, status);
+        return std::make_tuple(string(), cpak::make_error_code(value));
+    };
+
+    std::error_code status;
+    fs::remove_all(partialPath, status);
+    fs::create_directories(partialPath, status);
+    if (status) return failed(cpak::errc::archiveFetchFailed);
+
+    vector<string> extract{ "tar", "-x", "-f", "-", "--strip-components=1",
+                            "-C", partialPath.string() };
+    if (const auto compression = archiveCompression(url); !compression.empty())
+        extract.insert(extract.begin() + 1, compression);
+
+#if !_WIN32
+    // A tar that gives up early must not take us down with it.
+    std::signal(SIGPIPE, SIG_IGN);
+#endif
+
+    logger->debug("Downloading archive '{}'", url);
+    util::Blake3 hasher("");
+    auto downloaded = false, extracted = false;
+    try {
+        subprocess::Popen download(
+            vector<string>{ "curl", "--fail", "--silent", "--show-error",
+                            "--location", url },
+            subprocess::output{ subprocess::PIPE });
+        subprocess::Popen extraction(extract, subprocess::input{ subprocess::PIPE });
+
+        // Curl is drained even if tar stops reading, so it can exit.
+        auto writing = true;
+        vector<char> buffer(1 << 16);
+        for (std::size_t count;
+             (count = std::fread(buffer.data(), 1, buffer.size(), download.output())) > 0;) {
+            util::Blake3::update(hasher, { buffer.data(), count });
+            writing = writing &&
+                std::fwrite(buffer.data(), 1, count, extraction.input()) == count;
+        }
+
+        extraction.close_input();
+        downloaded = download.wait() == 0;
+        extracted  = extraction.wait() == 0 && writing;
+    } catch (const std::exception& e) {
+        logger->error("Failed to run curl and tar: {}", e.what());
+    }
+
+    if (!downloaded || !extracted) {
+        logger->error("Failed to {} archive '{}'",
+                      downloaded ? "extract" : "download", url);
+        return failed(cpak::errc::archiveFetchFailed);
+    }
+
+    util::Blake3::block_t block;
+    util::Blake3::finalize(hasher, block);
+    const auto digest = util::digestToString(block);
+    if (!lockedDigest.empty() && digest != lockedDigest) {
+        logger->error("Archive '{}' does not match the locked digest {}", url,
+                      lockedDigest);
+        return failed(cpak::errc::lockfileMismatch);
+    }
+
+    std::ofstream(archiveRecordPath(partialPath)) << digest << "\n";
+    fs::remove_all(dependencyPath, status);
+    fs::rename(partialPath, dependencyPath, status);
+    if (status) return failed(cpak::errc::archiveFetchFailed);
+
+    return std::make_tuple(digest, cpak::make_error_code(cpak::errc::success));
+}
+
+
+/// @brief   Fetches the revision of a dependency into the mirror of its remote.
+/// @details Creates the mirror if there is none yet. The caller must hold the
+///          mutex of the mirror.
+/// @param   dependency The dependency to fetch.
+/// @param   remoteURL The URL of the remote of the dependency.
+/// @param   mirrorPath The path of the mirror.
+/// @param   locked The revision recorded in the lockfile, if any.
+/// @param   reuseTags Whether a tag already in the mirror is used without
+///          asking the remote.
+/// @return  The revision to check out, and the status code for the operation.
+std::tuple<string, std::error_code>
+fetchIntoMirror(const cpak::Dependency& dependency,
+                const string& remoteURL,
+                const std::filesystem::path& mirrorPath,
+                const cpak::LockedDependency* locked,
+                bool reuseTags) noexcept {
+    auto logger = spdlog::get("cpak");
+    if (!std::filesystem::exists(mirrorPath)) {
+        logger->debug("Creating mirror '{}'", mirrorPath.c_str());
+        std::error_code status;
+        std::filesystem::create_directories(mirrorPath, status);
+        // Blobs are left out of fetches, checkouts download the ones they need.
+        if (status || !runGit({ "init", "--bare", "--quiet", mirrorPath }) ||
+            !runGit({ "-C", mirrorPath, "remote", "add", "origin", remoteURL }) ||
+            !runGit({ "-C", mirrorPath, "config", "remote.origin.promisor", "true" }) ||
+            !runGit({ "-C", mirrorPath, "config", "remote.origin.partialclonefilter",
+                      "blob:none" })) {
+            std::filesystem::remove_all(mirrorPath, status);
+            return std::make_tuple(string(),
+                                   cpak::make_error_code(cpak::errc::gitCloneFailed));
+        }
+    }
+
+    // A locked commit is fetched directly, without listing the remote. Remotes
+    // that refuse to serve a commit by hash get the version fetched instead.
+    auto revision = locked != nullptr ? locked->commit : string();
+    if (!revision.empty() && !hasCommit(mirrorPath, revision)) {
+        logger->debug("Fetching locked commit {} into mirror '{}'", revision,
+                      mirrorPath.c_str());
+        runGit({ "-C", mirrorPath, "fetch", "--quiet", "origin", revision });
+    }
+
+    const auto tag = "refs/tags/" + dependency.semv.str();
+    if (revision.empty() && reuseTags && !dependency.versionIsBranch &&
+        runGit({ "-C", mirrorPath, "rev-parse", "--quiet", "--verify", tag }))
+        return std::make_tuple(tag, cpak::make_error_code(cpak::errc::success));
+
+    if (revision.empty() || !hasCommit(mirrorPath, revision)) {
+        auto [reference, result] = fetchVersion(dependency, remoteURL, mirrorPath);
+        if (result.value() != cpak::errc::success)
+            return std::make_tuple(string(), result);
+
+        if (revision.empty()) revision = reference;
+        else if (!hasCommit(mirrorPath, revision))
+            return std::make_tuple(string(),
+                                   cpak::make_error_code(cpak::errc::lockfileMismatch));
+    }
+
+    return std::make_tuple(revision, cpak::make_error_code(cpak::errc::success));
+}
+
+
+std::tuple<std::vector<cpak::version>, std::error_code>
+cpak::management::listVersions(const cpak::Dependency& dependency,
+                               bool remote) noexcept {
+    std::vector<version> versions;
+    const auto addVersion = [&](const string& semv) {
+        try {
+            versions.push_back(version::parse(semv));
+        } catch (const std::exception&) {
+            // Not every tag or checkout is a version.
+        }
+    };
+
+    // Checkouts are named after the version they hold.
+    const auto [path, _] = findDependencyPath(dependency);
+    const auto prefix    = dependency.name + "@";
+    std::error_code status;
+    std::filesystem::directory_iterator checkouts(path.parent_path(), status), end;
+    for (; !status && checkouts != end; checkouts.increment(status)) {
+        const auto checkout = checkouts->path().filename().string();
+        if (checkout.starts_with(prefix)) addVersion(checkout.substr(prefix.size()));
+    }
+
+    if (!remote) return std::make_tuple(versions, make_error_code(errc::success));
+
+    const auto remoteURL = findRemoteURL(dependency);
+    spdlog::get("cpak")->debug("Listing versions of '{}'", remoteURL);
+    const auto [listing, found] = readGit({ "ls-remote", "--tags", "--refs", remoteURL });
+    if (!found)
+        return std::make_tuple(versions, make_error_code(errc::gitRemoteNotFound));
+
+    std::istringstream lines(listing);
+    for (string line; std::getline(lines, line);) {
+        const auto tag = line.find("refs/tags/");
+        if (tag != string::npos) addVersion(::util::trim(line.substr(tag + 10)));
+    }
+
+    return std::make_tuple(versions, make_error_code(errc::success));
+}
+
+
+std::tuple<std::optional<cpak::CPakFile>, std::error_code>
+cpak::management::cloneDependency(const cpak::Dependency& dependency,
+                                  const std::string& dependencyPath,
+                                  const cpak::LockedDependency* locked) noexcept {
+    // Tagged versions are downloaded as a source archive when the remote has
+    // them, unless they are locked to a commit.
+    auto logger = spdlog::get("cpak");
+    if (dependency.remote != std::nullopt && !dependency.remote->archive.empty() &&
+        !dependency.versionIsBranch && (locked == nullptr || locked->commit.empty())) {
+        logger->info("Downloading dependency '{}'", dependency.name.c_str());
+        const auto [digest, result] = fetchArchive(
+            dependency, dependencyPath, locked != nullptr ? locked->archive : string());
+        if (result.value() != errc::success)
+            return std::make_tuple(std::nullopt, result);
+
+        logger->info("Downloaded dependency '{}'", dependency.name.c_str());
+        return internalLoadCPakFile(dependencyPath);
+    }
+
+    const auto remoteURL = findRemoteURL(dependency);
+    logger->info("Cloning dependency '{}'", dependency.name.c_str());
+
+    // Versions share the objects of a single mirror of the remote, so adding
+    // a version only fetches what the mirror doesn't have yet.
+    const auto mirrorPath = findMirrorPath(remoteURL);
+    std::lock_guard<std::mutex> lock(mirrorMutex(mirrorPath));
+    const auto [revision, fetchResult] = fetchIntoMirror(
+        dependency, remoteURL, mirrorPath, locked,
+        !std::filesystem::exists(dependencyPath));
+    if (fetchResult.value() != errc::success)
+        return std::make_tuple(std::nullopt, fetchResult);
+
+    // Updating moves the existing checkout, a new version gets its own
+    // worktree of the mirror. Checkouts that aren't worktrees of the mirror
+    // are cloned again as one. New worktrees start out with only the files at
+    // the top, enough to read the CPakFile.
+    if (std::filesystem::exists(dependencyPath) &&
+        !isMirrorWorktree(dependencyPath, mirrorPath)) {
+        logger->info("Replacing standalone checkout '{}' with a worktree",
+                     dependencyPath);
+        std::error_code status;
+        std::filesystem::remove_all(dependencyPath, status);
+        if (status)
+            return std::make_tuple(std::nullopt,
+                                   make_error_code(errc::gitCloneFailed));
+    }
+
+    const auto checkedOut = std::filesystem::exists(dependencyPath)
+        ? runGit({ "-C", dependencyPath, "checkout", "--quiet", "--detach", revision })
+        : runGit({ "-C", mirrorPath, "worktree", "prune" }) &&
+          runGit({ "-C", mirrorPath, "worktree", "add", "--quiet", "--no-checkout",
+                   "--detach", dependencyPath, revision }) &&
+          runGit({ "-C", dependencyPath, "sparse-checkout", "set", "--cone" }) &&
+          runGit({ "-C", dependencyPath, "checkout", "--quiet" });
+    if (!checkedOut)
         return std::make_tuple(std::nullopt,
                                make_error_code(errc::gitCloneFailed));
 
+    if (locked != nullptr) {
+        const auto result = verifyLocked(dependencyPath, *locked);
+        if (result.value() != errc::success)
+            return std::make_tuple(std::nullopt, result);
+    }
+
     logger->info("Cloned dependency '{}'", dependency.name.c_str());
-    return internalLoadCPakFile(dependencyPath);
+    return narrowCheckout(dependencyPath);
+}
+
+
+std::tuple<std::optional<cpak::CPakFile>, std::error_code>
+cpak::management::readDependencyCPakFile(
+    const cpak::Dependency& dependency,
+    const cpak::LockedDependency* locked) noexcept {
+    // A checkout on disk is read as it is, unless it may have to be moved to a
+    // locked commit. Source archives have to be downloaded to be read.
+    const auto lockedCommit   = locked != nullptr && !locked->commit.empty();
+    const auto [path, result] = findDependencyPath(dependency);
+    if (result.value() == errc::success && !lockedCommit)
+        return loadCPakFile(path);
+
+    if (dependency.remote != std::nullopt && !dependency.remote->archive.empty() &&
+        !dependency.versionIsBranch && !lockedCommit)
+        return loadDependency(dependency, locked);
+
+    // Otherwise only the CPakFile is read from the mirror, without checking
+    // anything out.
+    const auto remoteURL  = findRemoteURL(dependency);
+    const auto mirrorPath = findMirrorPath(remoteURL);
+    std::lock_guard<std::mutex> lock(mirrorMutex(mirrorPath));
+    const auto [revision, fetchResult] =
+        fetchIntoMirror(dependency, remoteURL, mirrorPath, locked, true);
+    if (fetchResult.value() != errc::success)
+        return std::make_tuple(std::nullopt, fetchResult);
+
+    auto logger = spdlog::get("cpak");
+    for (const auto* name : { "CPakFile", "CPakFile.yaml", "CPakFile.yml" }) {
+        const auto [contents, found] =
+            readGit({ "-C", mirrorPath, "show", fmt::format("{}:{}", revision, name) });
+        if (!found) continue;
+
+        logger->debug("Read {} of '{}' from mirror '{}'", name,
+                      cpak::identityToString(dependency), mirrorPath.c_str());
+        try {
+            std::istringstream contentsStream(contents);
+            return std::make_tuple(std::optional(decoder::decodeCPakFile(contentsStream)),
+                                   make_error_code(errc::success));
+        } catch (const YAML::Exception& e) {
+            logger->error("Failed to load the CPakfile of '{}': {}",
+                          cpak::identityToString(dependency), e.what());
+            return std::make_tuple(std::nullopt, make_error_code(errc::invalidCPakFile));
+        }
+    }
+
+    return std::make_tuple(std::nullopt, make_error_code(errc::noCPakFileAtPath));
+}
+
+
+std::optional<std::vector<std::string>>
+cpak::management::findSparseDirectories(const CPakFile& cpakfile) noexcept {
+    std::set<string> directories;
+    auto everything = false;
+    const auto addPath = [&](std::string_view path, bool isDirectory) {
+        // Globs need everything below the part before the first wildcard.
+        auto directory       = string(path);
+        const auto pattern   = directory.find_first_of("*?[{");
+        const auto recursive = directory.find("**") != string::npos;
+        if (pattern != string::npos) {
+            directory.erase(pattern);
+            isDirectory = false;
+        }
+
+        const auto slash = directory.rfind('/');
+        if (!isDirectory) directory.erase(slash == string::npos ? 0 : slash);
+
+        // Files at the top are always checked out, and paths outside of the
+        // project are not ours to check out.
+        directory = fs::path(directory).lexically_normal().generic_string();
+        while (directory.ends_with('/')) directory.pop_back();
+        if (directory.empty() || directory == ".") {
+            everything = everything || (pattern != string::npos && recursive);
+            return;
+        }
+
+        if (directory.starts_with("..") || fs::path(directory).is_absolute()) return;
+
+        directories.insert(directory);
+    };
+
+    const auto addPaths = [&](const auto& accessibles, bool isDirectory) {
+        for (const auto& accessible : accessibles)
+            addPath(accessible.stored.str(), isDirectory);
+    };
+
+    for (const auto& target : cpakfile.targets) {
+        addPaths(target.sources, false);
+        if (target.search == std::nullopt) continue;
+
+        addPaths(target.search->include, true);
+        addPaths(target.search->system, true);
+        addPaths(target.search->library, true);
+    }
+
+    if (cpakfile.install != std::nullopt)
+        for (const auto& file : cpakfile.install->files) addPath(file.glob, false);
+
+    if (everything) return std::nullopt;
+    return vector<string>(directories.begin(), directories.end());
+}
+
+
+std::string
+cpak::management::vendoredArchiveURL(const cpak::Dependency& dependency,
+                                     const std::filesystem::path& vendorPath) noexcept {
+    const auto extension = archiveExtension(dependency.remote->archive);
+    return fmt::format("file://{}/{{gpid}}/{{name}}-{{version}}{}",
+                       fs::absolute(vendorPath).generic_string(), extension);
+}
+
+
+/// @brief   Downloads the objects a checkout left out of its mirror.
+/// @details Mirrors fetch without blobs and checkouts only download the ones
+///          they check out. Copying the history to another repository needs
+///          all of them, and the remote won't send them lazily on its behalf.
+/// @param   dependencyPath The path of the checkout.
+/// @return  True if the checkout has every object of its history.
+bool
+fetchMissingObjects(const std::filesystem::path& dependencyPath) noexcept {
+    const auto [objects, listed] = readGit(
+        { "-C", dependencyPath, "rev-list", "--objects", "--missing=print", "HEAD" });
+    if (!listed) return false;
+    if (!objects.starts_with('?') && objects.find("\n?") == string::npos) return true;
+
+    const auto commit = std::get<0>(readGit({ "-C", dependencyPath, "rev-parse", "HEAD" }));
+    const auto remoteURL = std::get<0>(
+        readGit({ "-C", dependencyPath, "config", "--get", "remote.origin.url" }));
+    spdlog::get("cpak")->debug("Fetching the objects '{}' left out",
+                               dependencyPath.c_str());
+
+    // The refetch ignores the objects the mirror has and the filter it uses.
+    std::lock_guard<std::mutex> lock(mirrorMutex(findMirrorPath(remoteURL)));
+    return runGit({ "-C", dependencyPath, "fetch", "--quiet", "--refetch",
+                    "--no-filter", "--no-tags", "origin", commit });
+}
+
+
+/// @brief   Copies the source archive a checkout was extracted from into a
+///          vendor directory.
+/// @details The archive is downloaded again, as only its digest is kept. It
+///          must match the digest of the checkout, so the lockfile still holds.
+/// @param   dependency The dependency to vendor.
+/// @param   digest The digest of the archive the checkout was extracted from.
+/// @param   vendorPath The vendor directory.
+/// @return  The status code for the operation.
+std::error_code
+vendorArchive(const cpak::Dependency& dependency,
+              const string& digest,
+              const std::filesystem::path& vendorPath) noexcept {
+    auto logger = spdlog::get("cpak");
+    if (dependency.remote == std::nullopt || dependency.remote->archive.empty()) {
+        logger->error("'{}' was downloaded as an archive, but its remote has none",
+                      cpak::identityToString(dependency));
+        return cpak::make_error_code(cpak::errc::vendorFailed);
+    }
+
+    const auto url         = findArchiveURL(dependency);
+    const auto archivePath = vendorPath / dependency.gpid /
+        fmt::format("{}-{}{}", dependency.name, dependency.semv.str(),
+                    archiveExtension(dependency.remote->archive));
+    const auto partialPath = fs::path(archivePath.string() + ".partial");
+
+    std::error_code status;
+    fs::create_directories(archivePath.parent_path(), status);
+    if (status) return cpak::make_error_code(cpak::errc::vendorFailed);
+
+    logger->info("Vendoring '{}' from '{}'", cpak::identityToString(dependency), url);
+    auto downloaded = false;
+    try {
+        subprocess::Popen download(
+            vector<string>{ "curl", "--fail", "--silent", "--show-error",
+                            "--location", "--output", partialPath.string(), url });
+        downloaded = download.wait() == 0;
+    } catch (const std::exception& e) {
+        logger->error("Failed to run curl: {}", e.what());
+    }
+
+    const auto [block, hashResult] = util::hashFile<util::Blake3>(partialPath);
+    if (!downloaded || hashResult.value() != cpak::errc::success ||
+        util::digestToString(block) != digest) {
+        logger->error("Archive '{}' does not match the checkout of '{}'", url,
+                      cpak::identityToString(dependency));
+        fs::remove(partialPath, status);
+        return cpak::make_error_code(cpak::errc::vendorFailed);
+    }
+
+    fs::rename(partialPath, archivePath, status);
+    if (status) return cpak::make_error_code(cpak::errc::vendorFailed);
+    return cpak::make_error_code(cpak::errc::success);
+}
+
+
+std::error_code
+cpak::management::vendorDependency(const cpak::Dependency& dependency,
+                                   const std::filesystem::path& dependencyPath,
+                                   const std::filesystem::path& vendorPath) noexcept {
+    // Checkouts extracted from an archive have no history to copy.
+    if (const auto digest = readArchiveDigest(dependencyPath); digest != std::nullopt)
+        return vendorArchive(dependency, *digest, vendorPath);
+
+    // Laid out like a remote, so the vendor directory can be used as one.
+    auto logger           = spdlog::get("cpak");
+    const auto repository = vendorPath / dependency.gpid / (dependency.name + ".git");
+    if (!fs::exists(repository)) {
+        logger->debug("Creating vendored repository '{}'", repository.c_str());
+        std::error_code status;
+        fs::create_directories(repository, status);
+        if (status || !runGit({ "init", "--bare", "--quiet", repository }))
+            return make_error_code(errc::vendorFailed);
+    }
+
+    // Only the history of the checked out commit is copied, under the name
+    // the version is looked up by.
+    const auto reference = dependency.versionIsBranch
+        ? "refs/heads/" + dependency.semv.prerelease()
+        : "refs/tags/" + dependency.semv.str();
+    logger->info("Vendoring '{}'", cpak::identityToString(dependency));
+    if (!fetchMissingObjects(dependencyPath) ||
+        !runGit({ "-C", repository, "fetch", "--quiet", "--no-tags",
+                  dependencyPath, "+HEAD:" + reference }))
+        return make_error_code(errc::vendorFailed);
+
+    return make_error_code(errc::success);
+}
+
+
+std::tuple<std::optional<cpak::LockedDependency>, std::error_code>
+cpak::management::lockDependency(
+    const std::filesystem::path& dependencyPath) noexcept {
+    if (auto digest = readArchiveDigest(dependencyPath); digest != std::nullopt)
+        return std::make_tuple(LockedDependency{ .archive = std::move(*digest) },
+                               make_error_code(errc::success));
+
+    const auto [revision, found] = readGit(
+        { "-C", dependencyPath, "show", "-s", "--format=%H%n%T", "HEAD" });
+    const auto separator = revision.find('\n');
+    if (!found || separator == string::npos)
+        return std::make_tuple(std::nullopt,
+                               make_error_code(errc::gitRemoteVersionNotFound));
+
+    return std::make_tuple(
+        LockedDependency{ .commit = revision.substr(0, separator),
+                          .tree   = ::util::trim(revision.substr(separator + 1)) },
+        make_error_code(errc::success));
+}
+
+
+std::tuple<std::optional<cpak::Lockfile>, std::error_code>
+cpak::management::loadLockfile(
+    const std::filesystem::path& lockfilePath) noexcept {
+    if (!std::filesystem::exists(lockfilePath))
+        return { std::nullopt, make_error_code(errc::pathDoesNotExist) };
+
+    try {
+        const auto node = YAML::LoadFile(lockfilePath);
+        return { node.IsNull() ? Lockfile{} : node.as<Lockfile>(),
+                 make_error_code(errc::success) };
+    } catch (const YAML::Exception& e) {
+        spdlog::get("cpak")->error(fmt::format(fmt::fg(fmt::terminal_color::bright_red),
+            "Error at line {}, column {} of {}: {}", e.mark.line + 1,
+            e.mark.column + 1, lockfilePath.c_str(), e.msg));
+        return { std::nullopt, make_error_code(errc::invalidLockfile) };
+    }
+}
+
+
+std::error_code
+cpak::management::saveLockfile(const std::filesystem::path& lockfilePath,
+                               const Lockfile& lockfile) noexcept {
+    // Leave the file alone when nothing changed.
+    const auto [existing, result] = loadLockfile(lockfilePath);
+    if (existing == lockfile) return make_error_code(errc::success);
+    if (existing == std::nullopt && lockfile.dependencies.empty())
+        return make_error_code(errc::success);
+
+    YAML::Node node;
+    node = lockfile;
+
+    YAML::Emitter emitter;
+    emitter.SetIndent(2);
+    emitter << node;
+
+    std::ofstream lockfileStream(lockfilePath);
+    lockfileStream << "# Generated by cpak, do not edit.\n"
+                   << emitter.c_str() << "\n";
+    if (!lockfileStream.good())
+        return make_error_code(errc::failure);
+
+    spdlog::get("cpak")->info("Wrote '{}'", lockfilePath.c_str());
+    return make_error_code(errc::success);
 }
 
 
@@ -1,5 +1,7 @@
 #pragma once
 #include "cpakfile.hpp"
+#include "lockfile.hpp"
+#include "workspace.hpp"
 
 namespace cpak::management {
 
@@ -13,17 +15,60 @@ loadCPakFile(const std::filesystem::path& projectPath,
              const std::vector<std::string>& options) noexcept;
 
 
+std::tuple<std::optional<Workspace>, std::error_code>
+loadWorkspace(const std::filesystem::path& workspacePath) noexcept;
+
+
+std::tuple<std::optional<Lockfile>, std::error_code>
+loadLockfile(const std::filesystem::path& lockfilePath) noexcept;
+
+
+std::error_code
+saveLockfile(const std::filesystem::path& lockfilePath,
+             const Lockfile& lockfile) noexcept;
+
+
 std::tuple<std::optional<CPakFile>, std::error_code>
-loadDependency(const Dependency& dependency) noexcept;
+loadDependency(const Dependency& dependency,
+               const LockedDependency* locked = nullptr) noexcept;
 
 
 std::tuple<std::optional<CPakFile>, std::error_code>
 cloneDependency(const Dependency& dependency,
-                const std::string& dependencyPath) noexcept;
+                const std::string& dependencyPath,
+                const LockedDependency* locked = nullptr) noexcept;
+
+
+std::tuple<std::optional<CPakFile>, std::error_code>
+readDependencyCPakFile(const Dependency& dependency,
+                       const LockedDependency* locked = nullptr) noexcept;
+
+
+std::tuple<std::vector<version>, std::error_code>
+listVersions(const Dependency& dependency, bool remote) noexcept;
+
+
+std::error_code
+vendorDependency(const Dependency& dependency,
+                 const std::filesystem::path& dependencyPath,
+                 const std::filesystem::path& vendorPath) noexcept;
+
+
+std::string
+vendoredArchiveURL(const Dependency& dependency,
+                   const std::filesystem::path& vendorPath) noexcept;
+
+
+std::tuple<std::optional<LockedDependency>, std::error_code>
+lockDependency(const std::filesystem::path& dependencyPath) noexcept;
 
 
 std::tuple<std::filesystem::path, std::error_code>
 findDependencyPath(const Dependency& dependency) noexcept;
 
 
+std::optional<std::vector<std::string>>
+findSparseDirectories(const CPakFile& cpakfile) noexcept;
+
+
 } // namespace cpak::management
\ No newline at end of file
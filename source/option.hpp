@@ -47,27 +47,163 @@ validateBuildOptionSchema(const YAML::Node& node) {
 }
 
 
+/// @brief Maps the names of build options to the options themselves.
+using OptionTable = std::unordered_map<std::string_view, const BuildOption*>;
+
+
+/// @brief   Creates the lookup table for a list of build options.
+/// @details The table refers to the options, so they must outlive it. When
+///          names repeat, the first option with the name wins.
+/// @param   options The options to create the table for.
+/// @return  The lookup table for the options.
+inline OptionTable
+makeOptionTable(const std::vector<BuildOption>& options) noexcept {
+    OptionTable table;
+    table.reserve(options.size());
+    for (const auto& option : options) table.emplace(option.name, &option);
+    return table;
+}
+
+
+/// @brief   A string split into literal text and references to build options.
+/// @details References have the form \c ${OPTION_NAME}, where the name is
+///          made of upper case letters and underscores. Anything else is kept
+///          as literal text.
+struct OptionTemplate {
+    struct Segment {
+        std::string text;
+        bool isOption;
+    };
+
+    std::vector<Segment> segments;
+
+    /// @brief  Splits the given string into its segments in a single pass.
+    /// @param  source The string to compile.
+    /// @return The compiled template.
+    static OptionTemplate
+    compile(std::string_view source) noexcept {
+        OptionTemplate compiled;
+        const auto addLiteral = [&](std::string_view text) {
+            if (text.empty()) return;
+            if (!compiled.segments.empty() && !compiled.segments.back().isOption)
+                compiled.segments.back().text += text;
+            else
+                compiled.segments.push_back({ std::string(text), false });
+        };
+
+        std::size_t literalStart = 0;
+        std::size_t position     = 0;
+        while ((position = source.find("${", position)) != std::string_view::npos) {
+            const auto nameStart = position + 2;
+            const auto nameEnd   = source.find('}', nameStart);
+            if (nameEnd == std::string_view::npos) break;
+
+            const auto name    = source.substr(nameStart, nameEnd - nameStart);
+            const auto isValid = !name.empty() &&
+                std::all_of(name.begin(), name.end(), [](char character) {
+                    return (character >= 'A' && character <= 'Z') || character == '_';
+                });
+
+            // Not a reference, the '$' is literal text.
+            if (!isValid) {
+                position += 1;
+                continue;
+            }
+
+            addLiteral(source.substr(literalStart, position - literalStart));
+            compiled.segments.push_back({ std::string(name), true });
+            literalStart = position = nameEnd + 1;
+        }
+
+        addLiteral(source.substr(literalStart));
+        return compiled;
+    }
+
+    /// @brief   Gets the compiled template for the given string.
+    /// @details Templates are cached per thread, since the same flags and
+    ///          paths tend to repeat across the targets of a project.
+    /// @param   source The string to get the template for.
+    /// @return  The compiled template.
+    static const OptionTemplate&
+    cached(const std::string& source) noexcept {
+        constexpr std::size_t kMaxCachedTemplates = 1 << 12;
+
+        thread_local std::unordered_map<std::string, OptionTemplate> templates;
+        if (auto found = templates.find(source); found != templates.end())
+            return found->second;
+
+        if (templates.size() >= kMaxCachedTemplates) templates.clear();
+        return templates.emplace(source, compile(source)).first->second;
+    }
+
+    /// @brief   Renders the template with the given options.
+    /// @details References to unknown options are kept as they are.
+    /// @param   options The options to render with.
+    /// @param   referenced Receives the name and value of every option used.
+    /// @return  The rendered string.
+    std::string
+    render(const OptionTable& options,
+           std::map<std::string, std::string>& referenced) const noexcept {
+        std::string rendered;
+        for (const auto& segment : segments) {
+            if (!segment.isOption) {
+                rendered += segment.text;
+                continue;
+            }
+
+            const auto option = options.find(segment.text);
+            if (option == options.end()) {
+                rendered += "${";
+                rendered += segment.text;
+                rendered += '}';
+                continue;
+            }
+
+            referenced[option->second->name] = option->second->value;
+            rendered += option->second->value;
+        }
+
+        return rendered;
+    }
+};
+
+
+/// @brief   Interpolates the given argument with the given options.
+/// @details Option values are inserted as they are, references inside of
+///          them are not interpolated again.
+/// @param   argument The argument to interpolate with the options.
+/// @param   options The lookup table of the options to interpolate with.
+/// @param   referenced Receives the name and value of every option used.
+inline void
+interpolateOptions(std::string& argument,
+                   const OptionTable& options,
+                   std::map<std::string, std::string>& referenced) noexcept {
+    // Most arguments reference nothing, skip them without compiling.
+    if (argument.find("${") == std::string::npos) return;
+    argument = OptionTemplate::cached(argument).render(options, referenced);
+}
+
+
 /// @brief Interpolates the given argument with the given options.
 /// @param argument The argument to interpolate with the options.
 /// @param options The options to interpolate with.
+/// @param referenced Receives the name and value of every option used.
 inline void
 interpolateOptions(std::string& argument,
-                   const std::vector<BuildOption>& options) noexcept {
-    // Looking to match ${OPTION_NAME}.
-    static std::regex optionRegex("\\$\\{([A-Z_]+)\\}");
-
-    // Match all the options in the argument.
-    std::smatch match;
-    while (std::regex_search(argument, match, optionRegex)) {
-        const auto& option = std::find_if(
-            options.begin(), options.end(), [&match](const auto& option) {
-                return option.name == match[1].str();
-            });
+                   const std::vector<BuildOption>& options,
+                   std::map<std::string, std::string>& referenced) noexcept {
+    interpolateOptions(argument, makeOptionTable(options), referenced);
+}
 
-        if (option == options.end()) continue;
 
-        argument.replace(match.position(), match.length(), option->value);
-    }
+/// @brief Interpolates the given argument with the given options.
+/// @param argument The argument to interpolate with the options.
+/// @param options The options to interpolate with.
+inline void
+interpolateOptions(std::string& argument,
+                   const std::vector<BuildOption>& options) noexcept {
+    std::map<std::string, std::string> referenced;
+    interpolateOptions(argument, options, referenced);
 }
 
 
@@ -1,7 +1,11 @@
+#include "cache.hpp"
+#include "configuration.hpp"
 #include "cpakfile.hpp"
 #include "errorcode.hpp"
 #include "pipeline.hpp"
+#include "registry.hpp"
 #include "utilities/logging.hpp"
+#include "utilities/threadpool.hpp"
 #include "glob/glob.h"
 
 
@@ -13,21 +17,20 @@ using std::string;
 using std::string_view;
 using std::vector;
 
-using BuildQueue = std::queue<std::function<std::error_code()>>;
-using DependencyCache = std::unordered_map<std::string_view, const cpak::CPakFile*>;
-using InterfaceCache = std::unordered_map<std::string_view, const cpak::BuildTarget*>;
-using LibraryCache = std::unordered_map<std::string_view, const cpak::CPakFile*>;
+using BuildQueue = std::queue<cpak::BuildTask>;
+using InterfaceCache = std::unordered_map<cpak::InternedString, const cpak::BuildTarget*>;
+using LibraryCache = std::unordered_map<cpak::InternedString, const cpak::CPakFile*>;
 
 // Referenced from application.cpp
 // Will need to rework how things are shared between compilation units.
+extern std::shared_ptr<Configuration> config;
 extern BuildQueue buildQueue;
-extern DependencyCache dependencyCache;
 extern InterfaceCache interfaceCache;
 extern LibraryCache libraryCache;
 
 
 void reserveAndAppendFormatted(vector<string>& into,
-                               const Accessibles<string>& from,
+                               const Accessibles<InternedString>& from,
                                const char* pattern = "{}") noexcept {
     if (from.empty()) return;
 
@@ -59,8 +62,8 @@ executeInShell(const vector<string>& arguments) {
 
 
 void
-copyIfAccessible(Accessibles<string>& lhs,
-           const Accessibles<string>& rhs,
+copyIfAccessible(Accessibles<InternedString>& lhs,
+           const Accessibles<InternedString>& rhs,
            const BuildTarget* target) noexcept {
     std::copy_if(
         rhs.begin(),
@@ -79,12 +82,15 @@ copyInterfacePropertiesToTarget(const BuildTarget& interface,
     auto tgtPtr = &target;
     target.name = interface.name;
     target.type = interface.type;
+    target.referencedOptions.insert(interface.referencedOptions.begin(),
+                                    interface.referencedOptions.end());
     copyIfAccessible(target.defines, interface.defines, tgtPtr);
     copyIfAccessible(target.libraries, interface.libraries, tgtPtr);
     copyIfAccessible(target.sources, interface.sources, tgtPtr);
     copyIfAccessible(target.options, interface.options, tgtPtr);
     if (interface.search != std::nullopt) {
-        if (target.search == std::nullopt) target.search = SearchPaths();
+        if (target.search == std::nullopt)
+            target.search = makeSearchPaths(target.defines.get_allocator());
         copyIfAccessible(target.search->include, interface.search->include, tgtPtr);
         copyIfAccessible(target.search->system, interface.search->system, tgtPtr);
         copyIfAccessible(target.search->library, interface.search->library, tgtPtr);
@@ -94,28 +100,31 @@ copyInterfacePropertiesToTarget(const BuildTarget& interface,
 
 std::tuple<BuildTarget, std::error_code>
 flattenInterfaceTarget(const vector<BuildTarget>& targets,
-                       const BuildTarget& interface) noexcept {
-    BuildTarget target;
+                       const BuildTarget& interface,
+                       const AccessiblesAllocator<InternedString>& allocator) noexcept {
+    auto target = makeBuildTarget(allocator);
     std::error_code status;
     for (const auto& inherited : interface.interfaces) {
         if (!interfaceCache.contains(inherited.stored)) {
             status = make_error_code(errc::interfaceNotFound);
-            return std::make_tuple(target, status);
+            return std::make_tuple(std::move(target), status);
         }
 
-        std::tie(target, status) =
-            flattenInterfaceTarget(targets, *interfaceCache[inherited.stored]);
+        std::tie(target, status) = flattenInterfaceTarget(
+            targets, *interfaceCache[inherited.stored], allocator);
     }
 
     copyInterfacePropertiesToTarget(interface, target);
-    return std::make_tuple(target, status);
+    return std::make_tuple(std::move(target), status);
 }
 
 
 inline std::tuple<BuildTarget, std::error_code>
 constructConsolidatedTarget(const vector<BuildTarget>& targets,
                             const BuildTarget& from) noexcept {
-    return flattenInterfaceTarget(targets, from);
+    // Everything copied while flattening is released with the target.
+    const AccessiblesAllocator<InternedString> allocator(utilities::makeArena(4 * 1024));
+    return flattenInterfaceTarget(targets, from, allocator);
 }
 
 
@@ -158,7 +167,7 @@ gatherLinkingArguments(const CPakFile& cpakfile,
 
     auto size = objects.size() +
                 target.libraries.size() +
-                (dependencyCache.size() * 2) +
+                (ProjectRegistry::shared().size() * 2) +
                 5; // g++, binaries, libaries, options, output.
 
     if (target.search != std::nullopt)
@@ -173,13 +182,12 @@ gatherLinkingArguments(const CPakFile& cpakfile,
 
     // If we're linking a dependency, we'll automatically add it's binary and
     // library paths to the linking command.
-    for (const auto& iter : dependencyCache) {
-        const auto& dependency = iter.second;
+    ProjectRegistry::shared().forEach([&](auto, const CPakFile& dependency) {
         arguments.emplace_back(
-            fmt::format("-L {}", dependency->binaryBuildPath().c_str()));
+            fmt::format("-L {}", dependency.binaryBuildPath().c_str()));
         arguments.emplace_back(
-            fmt::format("-L {}", dependency->libraryBuildPath().c_str()));
-    }
+            fmt::format("-L {}", dependency.libraryBuildPath().c_str()));
+    });
 
     if (target.search != std::nullopt)
         reserveAndAppendFormatted(arguments, target.search->library, "-L {}");
@@ -189,6 +197,82 @@ gatherLinkingArguments(const CPakFile& cpakfile,
 }
 
 
+vector<fs::path>
+gatherLibrarySearchPaths(const BuildTarget& target) noexcept {
+    vector<fs::path> searchPaths;
+    ProjectRegistry::shared().forEach([&](auto, const CPakFile& dependency) {
+        searchPaths.emplace_back(dependency.binaryBuildPath());
+        searchPaths.emplace_back(dependency.libraryBuildPath());
+    });
+
+    if (target.search != std::nullopt)
+        for (const auto& path : target.search->library)
+            searchPaths.emplace_back(path.stored.str());
+
+    return searchPaths;
+}
+
+
+vector<fs::path>
+gatherLinkingInputs(const BuildTarget& target,
+                    const vector<string>& objects,
+                    const vector<fs::path>& searchPaths) noexcept {
+    vector<fs::path> inputs(objects.begin(), objects.end());
+    inputs.reserve(objects.size() + target.libraries.size());
+
+    // Resolve libraries the same way the linker would, first match wins.
+    // System libraries outside the search paths are only keyed by name.
+    for (const auto& library : target.libraries) {
+        for (const auto& searchPath : searchPaths) {
+            const auto dynlibPath =
+                searchPath / fmt::format("lib{}.so", library.stored);
+            const auto archivePath =
+                searchPath / fmt::format("lib{}.a", library.stored);
+            if (fs::exists(dynlibPath)) {
+                inputs.emplace_back(dynlibPath);
+                break;
+            }
+
+            if (fs::exists(archivePath)) {
+                inputs.emplace_back(archivePath);
+                break;
+            }
+        }
+    }
+
+    return inputs;
+}
+
+
+std::error_code
+linkWithCache(const vector<string>& arguments,
+              const vector<fs::path>& inputs,
+              const fs::path& outputPath) noexcept {
+    auto logger = spdlog::get("cpak");
+    auto [key, result] = cache::linkCacheKey(arguments, inputs);
+    if (result.value() == errc::success) {
+        result = cache::restoreLinkOutput(key, outputPath);
+        if (result.value() == errc::success) {
+            logger->info("Restored '{}' from link cache", outputPath.c_str());
+            return result;
+        }
+    }
+
+    result = executeInShell(arguments);
+    if (result.value() != errc::success || key.empty())
+        return result; // Let the caller handle the error.
+
+    // Failing to populate the cache should never fail the build.
+    const auto level = config != nullptr
+        ? config->cache.compressionLevel
+        : CacheConfiguration().compressionLevel;
+    if (cache::storeLinkOutput(key, outputPath, level).value() != errc::success)
+        logger->warn("Failed to cache '{}'", outputPath.c_str());
+
+    return result;
+}
+
+
 std::error_code
 cpak::queueForBuild(const CPakFile& cpakfile,
                     const BuildTarget& target) noexcept {
@@ -209,11 +293,18 @@ cpak::queueForBuild(const CPakFile& cpakfile,
     auto objects   = vector<string>();
     objects.reserve(target.sources.size());
 
+    // Objects are shared by every configuration of the target that compiles
+    // them the same way.
+    const auto fingerprint = cache::targetFingerprint(consolidated, arguments);
+    const auto objectsPath = cpakfile.objectBuildPath(fingerprint);
+    if (!fs::exists(objectsPath)) fs::create_directories(objectsPath);
+    logger->debug("Target '{}' has fingerprint {}", target.name.c_str(),
+                  fingerprint);
+
     for (const auto& source : target.sources) {
-        const auto sourcePath = cpakfile.projectPath / source.stored;
+        const auto sourcePath = cpakfile.projectPath / source.stored.str();
         const auto objectPath =
-            cpakfile.objectBuildPath() /
-            fmt::format("{}.o", sourcePath.filename().c_str());
+            objectsPath / fmt::format("{}.o", sourcePath.filename().c_str());
 
         logger->debug("Checking if source exists: {}", sourcePath.c_str());
         if (!fs::exists(sourcePath))
@@ -231,24 +322,25 @@ cpak::queueForBuild(const CPakFile& cpakfile,
 
         // We can add to the copied vector, allowing us to still mutate it
         // outside of the lambda.
-        buildQueue.push([=]() mutable -> std::error_code {
+        buildQueue.push({ .execute = [=]() mutable -> std::error_code {
             arguments.emplace_back(fmt::format("-c {}", sourcePath.c_str()));
             arguments.emplace_back(fmt::format("-o {}", objectPath.c_str()));
             return executeInShell(arguments);
-        });
+        } });
 
         logger->debug("Queued for compilation: {}", sourcePath.string());
     }
 
 
     arguments = gatherLinkingArguments(cpakfile, consolidated, objects);
-    buildQueue.push([=]() mutable -> std::error_code {
+    const auto searchPaths = gatherLibrarySearchPaths(consolidated);
+    const auto link = [=]() mutable -> std::error_code {
         string outputName;
         fs::path outputPath;
 
         switch (consolidated.type) {
         case TargetType::Executable:
-            outputPath = cpakfile.binaryBuildPath() / consolidated.name;
+            outputPath = cpakfile.binaryBuildPath() / consolidated.name.str();
             arguments.emplace_back(fmt::format("-o {}", outputPath.c_str()));
             break;
         case TargetType::StaticLibrary:
@@ -266,14 +358,110 @@ cpak::queueForBuild(const CPakFile& cpakfile,
         default: assert(false && "Invalid target type");
         }
 
-        return executeInShell(arguments);
-    });
+        // Inputs are resolved now, dependencies were built by earlier tasks.
+        const auto inputs =
+            gatherLinkingInputs(consolidated, objects, searchPaths);
+        return linkWithCache(arguments, inputs, outputPath);
+    };
+
+    buildQueue.push({ .execute = link, .waitsForQueued = true });
 
     logger->debug("Queued for Linking: {}", target.name.c_str());
     return result;
 }
 
 
+std::tuple<vector<InternedString>, std::error_code>
+cpak::selectTargets(CPakFile& cpakfile, const vector<string>& names) noexcept {
+    auto& targets    = cpakfile.targets;
+    const auto table = makeOptionTable(cpakfile.options);
+
+    // Names are the only thing interpolated for every target, they're needed
+    // to resolve references.
+    std::unordered_map<InternedString, std::size_t> indices;
+    for (auto index = 0u; index < targets.size(); ++index) {
+        auto name = targets[index].name.str();
+        std::map<string, string> referenced;
+        interpolateOptions(name, table, referenced);
+        indices.emplace(name, index);
+    }
+
+    vector<bool> selected(targets.size());
+    vector<std::size_t> pending;
+    const auto select = [&](InternedString name) {
+        const auto iter = indices.find(name);
+        if (iter == indices.end()) return false;
+        if (!selected[iter->second]) pending.push_back(iter->second);
+
+        selected[iter->second] = true;
+        return true;
+    };
+
+    auto logger = spdlog::get("cpak");
+    for (const auto& name : names) {
+        if (select(name)) continue;
+
+        logger->error("Project has no target named '{}'", name);
+        return { vector<InternedString>{}, make_error_code(errc::buildTargetNotFound) };
+    }
+
+    vector<InternedString> unresolved;
+    while (!pending.empty()) {
+        auto& target = targets[pending.back()];
+        pending.pop_back();
+
+        interpolateOptions(target, table);
+        for (const auto& inherited : target.interfaces)
+            if (!select(inherited.stored)) unresolved.push_back(inherited.stored);
+        for (const auto& library : target.libraries)
+            if (!select(library.stored)) unresolved.push_back(library.stored);
+    }
+
+    // Keep the project order, the targets that moved point their accessibles
+    // at their new place.
+    std::size_t kept = 0;
+    for (auto index = 0u; index < targets.size(); ++index) {
+        if (!selected[index]) continue;
+        if (kept != index) {
+            targets[kept] = std::move(targets[index]);
+            assignTargetToAccessibles(targets[kept]);
+        }
+
+        ++kept;
+    }
+
+    logger->info("Selected {} of {} targets", kept, targets.size());
+    targets.erase(targets.begin() + kept, targets.end());
+    return { unresolved, make_error_code(errc::success) };
+}
+
+
+bool
+providesAny(const CPakFile& cpakfile,
+            const vector<InternedString>& names) noexcept {
+    for (const auto& target : cpakfile.targets)
+        if (std::find(names.begin(), names.end(), target.name) != names.end())
+            return true;
+
+    for (const auto& dependency : cpakfile.dependencies) {
+        const auto* loaded = ProjectRegistry::shared().get(dependency);
+        if (loaded != nullptr && providesAny(*loaded, names)) return true;
+    }
+
+    return false;
+}
+
+
+void
+cpak::selectDependencies(CPakFile& cpakfile,
+                         const vector<InternedString>& names) noexcept {
+    std::erase_if(cpakfile.dependencies, [&](const Dependency& dependency) {
+        const auto* loaded = ProjectRegistry::shared().get(dependency);
+        return loaded == nullptr || !providesAny(*loaded, names);
+    });
+}
+
+
 std::error_code
 cpak::queueForBuild(const CPakFile& cpakfile) noexcept {
     auto logger      = spdlog::get("cpak");
@@ -282,19 +470,19 @@ cpak::queueForBuild(const CPakFile& cpakfile) noexcept {
 
     const auto binariesPath  = cpakfile.binaryBuildPath();
     const auto librariesPath = cpakfile.libraryBuildPath();
-    const auto objectsPath   = cpakfile.objectBuildPath();
     if (!fs::exists(binariesPath)) fs::create_directories(binariesPath);
     if (!fs::exists(librariesPath)) fs::create_directories(librariesPath);
-    if (!fs::exists(objectsPath)) fs::create_directories(objectsPath);
 
+    // A dependency shared by several dependents is only queued by the first.
+    auto& registry = ProjectRegistry::shared();
     for (const auto& dependency : cpakfile.dependencies) {
-        const auto cpakid = identityToString(dependency);
-        const auto iter   = dependencyCache.find(cpakid);
-        if (iter == dependencyCache.end())
+        const auto handle = registry.find(dependency);
+        if (registry.get(handle) == nullptr)
             return make_error_code(
                 errc::failure); // Let the caller handle the error.
 
-        queueStatus = cpak::queueForBuild(*iter->second);
+        if (!registry.claimBuild(handle)) continue;
+        queueStatus = cpak::queueForBuild(*registry.get(handle));
         if (queueStatus.value() != errc::success)
             return queueStatus; // Let the caller handle the error.
     }
@@ -313,17 +501,62 @@ cpak::executeBuild() noexcept {
     auto logger = spdlog::get("cpak");
     logger->info("Executing build queue with {} tasks", buildQueue.size());
 
+    // Compile tasks are handed to the pool as they come, every link task waits
+    // for the tasks before it and then runs on this thread.
+    auto& pool = utilities::ThreadPool::shared();
+    vector<std::future<std::error_code>> running;
+    const auto waitForRunning = [&running]() {
+        auto status = make_error_code(errc::success);
+        for (auto& future : running) {
+            const auto result = future.get();
+            if (status.value() == errc::success) status = result;
+        }
+
+        running.clear();
+        return status;
+    };
+
     while (!buildQueue.empty()) {
-        auto& task = buildQueue.front();
+        auto task = std::move(buildQueue.front());
+        buildQueue.pop();
+
+        if (!task.waitsForQueued) {
+            running.push_back(pool.submit(std::move(task.execute)));
+            continue;
+        }
 
-        const auto result = task();
+        auto result = waitForRunning();
         if (result.value() != errc::success)
             return result; // Let the caller handle the error.
 
-        buildQueue.pop();
+        result = task.execute();
+        if (result.value() != errc::success)
+            return result; // Let the caller handle the error.
     }
 
-    return make_error_code(errc::success);
+    return waitForRunning();
+}
+
+
+/// @brief  Copies a file into an install location unless it is already there.
+/// @param  from The file to install.
+/// @param  to Where to install the file.
+/// @return True if the file was copied, false if it was up to date.
+bool
+installFile(const fs::path& from, const fs::path& to) noexcept {
+    // Verify existing installs by content, the hashes are cached so
+    // reinstalling an unchanged project reads nothing twice.
+    auto& hashes = cache::FileHashCache::shared();
+    if (fs::exists(to)) {
+        const auto [installed, installedResult] = hashes.hash(to);
+        const auto [built, builtResult]         = hashes.hash(from);
+        if (installedResult.value() == errc::success &&
+            builtResult.value() == errc::success && installed == built)
+            return false;
+    }
+
+    fs::copy_file(from, to, fs::copy_options::overwrite_existing);
+    return true;
 }
 
 
@@ -342,8 +575,8 @@ installTarget(const BuildTarget& target,
         const auto fileName = fmt::format("lib{}.a", targetName);
         const auto libPath = libraryBuildPath / fileName;
         const auto installPath = libraryInstallPath / fileName;
-        fs::copy_file(libPath, installPath);
-        logger->info("Installed archive '{}'", installPath.c_str());
+        if (installFile(libPath, installPath))
+            logger->info("Installed archive '{}'", installPath.c_str());
     }
 
     if (target.type == TargetType::DynamicLibrary) {
@@ -355,8 +588,8 @@ installTarget(const BuildTarget& target,
 
         const auto binPath = binaryBuildPath / fileName;
         const auto installPath = binaryInstallPath / fileName;
-        fs::copy_file(binPath, installPath);
-        logger->info("Installed dynlib '{}'", installPath.c_str());
+        if (installFile(binPath, installPath))
+            logger->info("Installed dynlib '{}'", installPath.c_str());
     }
 
     if (target.type == TargetType::Executable) {
@@ -368,8 +601,8 @@ installTarget(const BuildTarget& target,
 
         const auto binPath = binaryBuildPath / fileName;
         const auto installPath = binaryInstallPath / fileName;
-        fs::copy_file(binPath, installPath);
-        logger->info("Installed executable '{}'", installPath.c_str());
+        if (installFile(binPath, installPath))
+            logger->info("Installed executable '{}'", installPath.c_str());
     }
 }
 
@@ -405,20 +638,21 @@ installFiles(FileType type,
              const fs::path& includeInstallPath) noexcept {
     auto logger = spdlog::get("cpak");
     for (const auto& file : files) {
+        auto installed = false;
         switch (type) {
         case FileType::Header:
-            fs::copy_file(file, includeInstallPath / file.filename());
+            installed = installFile(file, includeInstallPath / file.filename());
             break;
         case FileType::Archive:
-            fs::copy_file(file, libraryInstallPath / file.filename());
+            installed = installFile(file, libraryInstallPath / file.filename());
             break;
         case FileType::Dynlib:
         case FileType::Binary:
-            fs::copy_file(file, binaryInstallPath / file.filename());
+            installed = installFile(file, binaryInstallPath / file.filename());
             break;
         }
 
-        logger->info("Installed file '{}'", file.c_str());
+        if (installed) logger->info("Installed file '{}'", file.c_str());
     }
 }
 
@@ -454,13 +688,12 @@ interanlInstallProject(const CPakFile& cpakfile,
 
     // Install dependencies of the project.
     for (const auto& nestedDependency : cpakfile.dependencies) {
-        const auto cpakid = identityToString(nestedDependency);
-        const auto iter   = dependencyCache.find(cpakid);
-        if (iter == dependencyCache.end())
+        const auto* loaded = ProjectRegistry::shared().get(nestedDependency);
+        if (loaded == nullptr)
             return make_error_code(errc::failure);
 
         interanlInstallProject(
-            *iter->second,
+            *loaded,
             binaryInstallPath,
             libraryInstallPath,
             includeInstallPath);
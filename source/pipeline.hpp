@@ -5,6 +5,39 @@
 namespace cpak {
 
 
+/// @brief   A task in the build queue.
+/// @details Compiling only reads the sources of a target, so compile tasks
+///          run alongside each other. Linking needs the outputs of the tasks
+///          queued before it, so a link task waits for all of them first.
+struct BuildTask {
+    std::function<std::error_code()> execute;
+    bool waitsForQueued{ false };
+};
+
+
+/// @brief   Narrows a project down to the targets needed to build the given
+///          ones.
+/// @details The selection is closed over the interfaces and libraries that
+///          the selected targets reference and the project provides itself.
+///          Only the selected targets are interpolated, every other target is
+///          dropped from the project without being looked at.
+/// @param   cpakfile The project to narrow down, with its options not yet
+///          interpolated.
+/// @param   names The names of the targets to build.
+/// @return  The interfaces and libraries referenced by the selection that the
+///          project does not provide, and the status code for the operation.
+std::tuple<std::vector<InternedString>, std::error_code>
+selectTargets(CPakFile& cpakfile, const std::vector<std::string>& names) noexcept;
+
+
+/// @brief  Drops the dependencies that provide none of the given targets.
+/// @param  cpakfile The project whose dependencies are loaded.
+/// @param  names The interfaces and libraries the project needs.
+void
+selectDependencies(CPakFile& cpakfile,
+                   const std::vector<InternedString>& names) noexcept;
+
+
 /// @brief  Queues the given project for building.
 /// @param  cpakfile The project that needs to be built.
 /// @return The status code for the operation.
@@ -0,0 +1,77 @@
+#include "registry.hpp"
+
+
+using cpak::CPakFile;
+using cpak::Identity;
+using cpak::ProjectHandle;
+using cpak::ProjectRegistry;
+
+
+ProjectRegistry&
+ProjectRegistry::shared() noexcept {
+    static ProjectRegistry registry;
+    return registry;
+}
+
+
+std::tuple<ProjectHandle, bool>
+ProjectRegistry::reserve(const Identity& identity) noexcept {
+    const auto next = ProjectHandle(entries_.size());
+    const auto [iter, reserved] =
+        handles_.try_emplace(identityToString(identity), next);
+    if (reserved) entries_.emplace_back();
+
+    return std::make_tuple(iter->second, reserved);
+}
+
+
+const CPakFile&
+ProjectRegistry::store(ProjectHandle handle, CPakFile&& cpakfile) noexcept {
+    auto& entry = entries_[handle];
+    entry.cpakfile.emplace(std::move(cpakfile));
+    return *entry.cpakfile;
+}
+
+
+ProjectHandle
+ProjectRegistry::find(const Identity& identity) const noexcept {
+    const auto iter = handles_.find(identityToString(identity));
+    return iter != handles_.end() ? iter->second : kNoProject;
+}
+
+
+const CPakFile*
+ProjectRegistry::get(ProjectHandle handle) const noexcept {
+    if (handle >= entries_.size()) return nullptr;
+
+    const auto& entry = entries_[handle];
+    return entry.cpakfile != std::nullopt ? &*entry.cpakfile : nullptr;
+}
+
+
+const CPakFile*
+ProjectRegistry::get(const Identity& identity) const noexcept {
+    return get(find(identity));
+}
+
+
+bool
+ProjectRegistry::claimBuild(ProjectHandle handle) noexcept {
+    if (get(handle) == nullptr) return false;
+
+    auto& entry = entries_[handle];
+    return !std::exchange(entry.claimed, true);
+}
+
+
+std::size_t
+ProjectRegistry::size() const noexcept {
+    return entries_.size();
+}
+
+
+void
+ProjectRegistry::clear() noexcept {
+    handles_.clear();
+    entries_.clear();
+}
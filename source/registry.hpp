@@ -0,0 +1,101 @@
+#pragma once
+#include <deque>
+#include "cpakfile.hpp"
+#include "utilities/noncopyable.hpp"
+
+namespace cpak {
+
+
+/// @brief A stable reference to a project owned by the registry.
+using ProjectHandle = std::uint32_t;
+
+
+/// @brief   Owns every project loaded while resolving the dependency graph.
+/// @details Each project is loaded once, no matter how many projects depend on
+///          it, and keeps its handle and its address for the lifetime of the
+///          registry. Dependencies don't carry options of their own, so a
+///          project is always built with its default option set and its CPakID
+///          alone identifies it. The registry is not thread safe, it is filled
+///          by the thread that walks the graph.
+class ProjectRegistry : public util::NonCopyable {
+    public:
+    static constexpr ProjectHandle kNoProject =
+        std::numeric_limits<ProjectHandle>::max();
+
+    /// @brief  Gets the registry shared by the whole process.
+    /// @return The shared registry.
+    static ProjectRegistry&
+    shared() noexcept;
+
+    /// @brief   Reserves a handle for the project with the given identity.
+    /// @details A reserved project is not available until it is stored, this
+    ///          lets the graph be walked without loading a project twice.
+    /// @param   identity The identity of the project.
+    /// @return  The handle of the project, and whether this call reserved it.
+    std::tuple<ProjectHandle, bool>
+    reserve(const Identity& identity) noexcept;
+
+    /// @brief  Stores a loaded project under its reserved handle.
+    /// @param  handle The handle reserved for the project.
+    /// @param  cpakfile The loaded project.
+    /// @return The project owned by the registry.
+    const CPakFile&
+    store(ProjectHandle handle, CPakFile&& cpakfile) noexcept;
+
+    /// @brief  Finds the handle of the project with the given identity.
+    /// @param  identity The identity of the project.
+    /// @return The handle of the project, or \c kNoProject if not reserved.
+    ProjectHandle
+    find(const Identity& identity) const noexcept;
+
+    /// @brief  Gets a stored project.
+    /// @param  handle The handle of the project.
+    /// @return The project, or null if it is not stored.
+    const CPakFile*
+    get(ProjectHandle handle) const noexcept;
+
+    /// @brief  Gets the stored project with the given identity.
+    /// @param  identity The identity of the project.
+    /// @return The project, or null if it is not stored.
+    const CPakFile*
+    get(const Identity& identity) const noexcept;
+
+    /// @brief   Claims the right to queue the build of a project.
+    /// @details Only the first claim succeeds, so the build of a project is
+    ///          queued once regardless of how many projects depend on it.
+    /// @param   handle The handle of the project.
+    /// @return  True for the first claim of a stored project.
+    bool
+    claimBuild(ProjectHandle handle) noexcept;
+
+    /// @brief  Gets the number of reserved projects.
+    /// @return The number of projects in the registry.
+    std::size_t
+    size() const noexcept;
+
+    /// @brief Calls the given function with every stored project.
+    /// @param function The function to call with the handle and the project.
+    template<typename TFunction>
+    void
+    forEach(TFunction&& function) const {
+        for (auto handle = 0u; handle < entries_.size(); ++handle)
+            if (entries_[handle].cpakfile != std::nullopt)
+                function(ProjectHandle(handle), *entries_[handle].cpakfile);
+    }
+
+    /// @brief Releases every project, invalidating all handles.
+    void
+    clear() noexcept;
+
+    private:
+    struct Entry {
+        std::optional<CPakFile> cpakfile;
+        bool claimed{ false };
+    };
+
+    std::unordered_map<InternedString, ProjectHandle> handles_;
+    std::deque<Entry> entries_;
+};
+
+
+} // namespace cpak
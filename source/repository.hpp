@@ -7,12 +7,16 @@ namespace cpak {
 /// @brief   Contains information for pulling from a repository.
 /// @details Because not all projects will be hosted on GitHub, we need to
 ///          support other repositories. This struct contains the information
-///          needed to pull from those other repositories.
+///          needed to pull from those other repositories. Tagged versions are
+///          downloaded as source archives instead of cloned when an archive
+///          URL is given, \c {gpid}, \c {name} and \c {version} in it are
+///          replaced with those of the dependency.
 struct Repository {
     std::string address;
     std::string username;
     std::string email;
     std::string password;
+    std::string archive;
 };
 
 
@@ -39,6 +43,10 @@ validateRepositorySchema(const YAML::Node& node) {
     if (node["password"] && !node["password"].IsScalar())
         throw YAML::Exception(node.Mark(),
                               "Repository password must be a string.");
+
+    if (node["archive"] && !node["archive"].IsScalar())
+        throw YAML::Exception(node.Mark(),
+                              "Repository archive must be a string.");
 }
 
 
@@ -55,6 +63,7 @@ struct YAML::convert<cpak::Repository> {
         node["username"] = rhs.username;
         node["email"]    = rhs.email;
         node["password"] = rhs.password;
+        if (!rhs.archive.empty()) node["archive"] = rhs.archive;
 
         return node;
     }
@@ -67,6 +76,7 @@ struct YAML::convert<cpak::Repository> {
         if (node["username"]) rhs.username = node["username"].as<std::string>();
         if (node["email"]) rhs.email = node["email"].as<std::string>();
         if (node["password"]) rhs.password = node["password"].as<std::string>();
+        if (node["archive"]) rhs.archive = node["archive"].as<std::string>();
         return true;
     }
 };
\ No newline at end of file
@@ -0,0 +1,453 @@
+#include "application.hpp"
+#include "cache.hpp"
+#include "errorcode.hpp"
+#include "snapshot.hpp"
+#include "utilities/hasher.hpp"
+
+
+namespace fs   = std::filesystem;
+namespace app  = cpak::application;
+namespace util = cpak::utilities;
+
+using cpak::AccessLevel;
+using cpak::Accessibles;
+using cpak::AccessiblesAllocator;
+using cpak::BuildOption;
+using cpak::BuildTarget;
+using cpak::CPakFile;
+using cpak::Dependency;
+using cpak::FileType;
+using cpak::Identity;
+using cpak::Install;
+using cpak::InstallFile;
+using cpak::InternedString;
+using cpak::ProjectInfo;
+using cpak::Repository;
+using cpak::SearchPaths;
+using cpak::TargetType;
+using util::Hash128;
+using std::string;
+using std::string_view;
+using std::vector;
+
+
+constexpr string_view kSnapshotMagic = "CPKS";
+
+
+/// @brief Appends the fields of the model to a snapshot buffer.
+struct SnapshotWriter {
+    vector<std::uint8_t> buffer;
+
+    void
+    write(std::uint64_t value) noexcept {
+        // Variable length, seven bits at a time.
+        for (; value >= 0x80; value >>= 7)
+            buffer.push_back(static_cast<std::uint8_t>(value | 0x80));
+        buffer.push_back(static_cast<std::uint8_t>(value));
+    }
+
+    void
+    write(string_view value) noexcept {
+        write(static_cast<std::uint64_t>(value.size()));
+        buffer.insert(buffer.end(), value.begin(), value.end());
+    }
+
+    void
+    write(const std::optional<string>& value) noexcept {
+        write(static_cast<std::uint64_t>(value.has_value()));
+        if (value.has_value()) write(string_view(*value));
+    }
+
+    void
+    write(const vector<string>& values) noexcept {
+        write(static_cast<std::uint64_t>(values.size()));
+        for (const auto& value : values) write(string_view(value));
+    }
+
+    void
+    write(const Accessibles<InternedString>& values) noexcept {
+        write(static_cast<std::uint64_t>(values.size()));
+        for (const auto& value : values) {
+            write(value.stored.view());
+            write(static_cast<std::uint64_t>(value.level));
+        }
+    }
+
+    void
+    write(const Identity& identity) noexcept {
+        write(string_view(identity.name));
+        write(string_view(identity.gpid));
+        write(string_view(identity.semv.str()));
+        write(static_cast<std::uint64_t>(identity.isMapped));
+        write(static_cast<std::uint64_t>(identity.versionIsBranch));
+    }
+
+    void
+    write(const Repository& repository) noexcept {
+        write(string_view(repository.address));
+        write(string_view(repository.username));
+        write(string_view(repository.email));
+        write(string_view(repository.password));
+        write(string_view(repository.archive));
+    }
+};
+
+
+/// @brief   Reads the fields of the model back out of a snapshot.
+/// @details Every read is bounds checked, a failed read leaves the reader in
+///          a failed state and yields empty values from then on.
+struct SnapshotReader {
+    const std::uint8_t* current;
+    const std::uint8_t* end;
+    AccessiblesAllocator<InternedString> allocator;
+    bool failed{ false };
+
+    std::uint64_t
+    readNumber() noexcept {
+        std::uint64_t value = 0;
+        for (auto shift = 0u; shift < 64; shift += 7) {
+            if (current == end) break;
+
+            const auto byte = *current++;
+            value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) return value;
+        }
+
+        failed = true;
+        return 0;
+    }
+
+    std::size_t
+    readCount() noexcept {
+        // Every element takes at least a byte, which bounds absurd counts.
+        const auto count = readNumber();
+        if (count > static_cast<std::uint64_t>(end - current)) {
+            failed = true;
+            return 0;
+        }
+
+        return static_cast<std::size_t>(count);
+    }
+
+    bool
+    readBool() noexcept {
+        return readNumber() != 0;
+    }
+
+    string
+    readString() noexcept {
+        const auto size = readCount();
+        if (failed) return string();
+
+        string value(reinterpret_cast<const char*>(current), size);
+        current += size;
+        return value;
+    }
+
+    std::optional<string>
+    readOptionalString() noexcept {
+        if (!readBool()) return std::nullopt;
+        return readString();
+    }
+
+    vector<string>
+    readStrings() noexcept {
+        vector<string> values(readCount());
+        for (auto& value : values) value = readString();
+        return values;
+    }
+
+    Accessibles<InternedString>
+    readAccessibles(BuildTarget* owner) noexcept {
+        Accessibles<InternedString> values(readCount(), allocator);
+        for (auto& value : values) {
+            value.stored = readString();
+            value.level  = static_cast<AccessLevel>(
+                std::min<std::uint64_t>(readNumber(), 2));
+            value.owner  = owner;
+        }
+
+        return values;
+    }
+
+    void
+    readIdentity(Identity& identity) noexcept {
+        identity.name = readString();
+        identity.gpid = readString();
+
+        const auto semv = readString();
+        try {
+            if (!failed) identity.semv = cpak::version::parse(semv);
+        } catch (const std::exception&) {
+            failed = true;
+        }
+
+        identity.isMapped        = readBool();
+        identity.versionIsBranch = readBool();
+    }
+
+    Repository
+    readRepository() noexcept {
+        Repository repository;
+        repository.address  = readString();
+        repository.username = readString();
+        repository.email    = readString();
+        repository.password = readString();
+        repository.archive  = readString();
+        return repository;
+    }
+};
+
+
+/// @brief  Gets the path of the snapshot stored under the given key.
+/// @param  key The key of the snapshot.
+/// @return The path of the snapshot.
+fs::path
+snapshotPath(string_view key) noexcept {
+    return cpak::cache::cacheRootPath() / "snapshots" / string(key);
+}
+
+
+/// @brief  Gets the version of cpak the snapshots are written by.
+/// @return The version of cpak as a string.
+string
+snapshotVersion() noexcept {
+    return fmt::format("{}.{}.{}-{}+{}/{}", app::kMajor, app::kMinor,
+                       app::kPatch, app::kPrerelease, app::kBuildMeta,
+                       cpak::snapshot::kFormatVersion);
+}
+
+
+string
+cpak::snapshot::snapshotKey(string_view contentDigest) noexcept {
+    Hash128 hash(snapshotVersion());
+    Hash128::update(hash, string_view("\0", 1));
+    Hash128::update(hash, contentDigest);
+
+    Hash128::block_t block;
+    Hash128::finalize(hash, block);
+    return ::util::digestToString(block);
+}
+
+
+vector<std::uint8_t>
+cpak::snapshot::encodeCPakFile(const CPakFile& cpakfile) noexcept {
+    SnapshotWriter writer;
+    writer.buffer.insert(writer.buffer.end(), kSnapshotMagic.begin(),
+                         kSnapshotMagic.end());
+    writer.write(string_view(snapshotVersion()));
+
+    const auto& project = cpakfile.project;
+    writer.write(static_cast<const Identity&>(project));
+    writer.write(project.authors);
+    writer.write(project.description);
+    writer.write(project.license);
+    writer.write(project.homePage);
+    writer.write(project.issuesPage);
+
+    writer.write(static_cast<std::uint64_t>(cpakfile.options.size()));
+    for (const auto& option : cpakfile.options) {
+        writer.write(option.desc);
+        writer.write(string_view(option.name));
+        writer.write(string_view(option.value));
+    }
+
+    writer.write(static_cast<std::uint64_t>(cpakfile.repositories.size()));
+    for (const auto& repository : cpakfile.repositories)
+        writer.write(repository);
+
+    writer.write(static_cast<std::uint64_t>(cpakfile.dependencies.size()));
+    for (const auto& dependency : cpakfile.dependencies) {
+        writer.write(static_cast<const Identity&>(dependency));
+        writer.write(dependency.constraint.has_value()
+                         ? std::optional<string>(dependency.constraint->str())
+                         : std::nullopt);
+        writer.write(static_cast<std::uint64_t>(dependency.remote.has_value()));
+        if (dependency.remote.has_value()) writer.write(*dependency.remote);
+    }
+
+    writer.write(static_cast<std::uint64_t>(cpakfile.targets.size()));
+    for (const auto& target : cpakfile.targets) {
+        writer.write(target.name.view());
+        writer.write(static_cast<std::uint64_t>(
+            static_cast<std::int64_t>(target.type) + 1));
+        writer.write(target.defines);
+        writer.write(target.interfaces);
+        writer.write(target.libraries);
+        writer.write(target.sources);
+        writer.write(target.options);
+        writer.write(static_cast<std::uint64_t>(target.search.has_value()));
+        if (target.search.has_value()) {
+            writer.write(target.search->include);
+            writer.write(target.search->system);
+            writer.write(target.search->library);
+        }
+    }
+
+    writer.write(static_cast<std::uint64_t>(cpakfile.install.has_value()));
+    if (cpakfile.install.has_value()) {
+        writer.write(cpakfile.install->targets);
+        writer.write(static_cast<std::uint64_t>(cpakfile.install->files.size()));
+        for (const auto& file : cpakfile.install->files) {
+            writer.write(string_view(file.glob));
+            writer.write(static_cast<std::uint64_t>(file.type));
+        }
+
+        writer.write(static_cast<std::uint64_t>(cpakfile.install->global));
+    }
+
+    return writer.buffer;
+}
+
+
+std::optional<CPakFile>
+cpak::snapshot::decodeCPakFile(const std::uint8_t* data,
+                               std::size_t size) noexcept {
+    if (size < kSnapshotMagic.size() ||
+        string_view(reinterpret_cast<const char*>(data),
+                    kSnapshotMagic.size()) != kSnapshotMagic)
+        return std::nullopt;
+
+    SnapshotReader reader{
+        .current   = data + kSnapshotMagic.size(),
+        .end       = data + size,
+        .allocator = AccessiblesAllocator<InternedString>(::util::makeArena(size)),
+    };
+    if (reader.readString() != snapshotVersion()) return std::nullopt;
+
+    CPakFile cpakfile;
+    auto& project = cpakfile.project;
+    reader.readIdentity(project);
+    project.authors     = reader.readStrings();
+    project.description = reader.readOptionalString();
+    project.license     = reader.readOptionalString();
+    project.homePage    = reader.readOptionalString();
+    project.issuesPage  = reader.readOptionalString();
+
+    cpakfile.options.resize(reader.readCount());
+    for (auto& option : cpakfile.options) {
+        option.desc  = reader.readOptionalString();
+        option.name  = reader.readString();
+        option.value = reader.readString();
+    }
+
+    cpakfile.repositories.resize(reader.readCount());
+    for (auto& repository : cpakfile.repositories)
+        repository = reader.readRepository();
+
+    cpakfile.dependencies.resize(reader.readCount());
+    for (auto& dependency : cpakfile.dependencies) {
+        reader.readIdentity(dependency);
+        if (const auto constraint = reader.readOptionalString()) {
+            dependency.constraint = cpak::VersionConstraint::parse(*constraint);
+            reader.failed = reader.failed || !dependency.constraint.has_value();
+        }
+
+        if (reader.readBool()) dependency.remote = reader.readRepository();
+    }
+
+    // Targets are sized up front so their addresses are final before the
+    // accessibles take them as their owner.
+    cpakfile.targets.resize(reader.readCount());
+    for (auto& target : cpakfile.targets) {
+        target.name       = reader.readString();
+        target.type       = static_cast<TargetType>(
+            static_cast<std::int64_t>(std::min<std::uint64_t>(
+                reader.readNumber(), 4)) - 1);
+        target.defines    = reader.readAccessibles(&target);
+        target.interfaces = reader.readAccessibles(&target);
+        target.libraries  = reader.readAccessibles(&target);
+        target.sources    = reader.readAccessibles(&target);
+        target.options    = reader.readAccessibles(&target);
+        if (reader.readBool()) {
+            target.search          = SearchPaths();
+            target.search->include = reader.readAccessibles(&target);
+            target.search->system  = reader.readAccessibles(&target);
+            target.search->library = reader.readAccessibles(&target);
+        }
+    }
+
+    if (reader.readBool()) {
+        cpakfile.install          = Install();
+        cpakfile.install->targets = reader.readStrings();
+        cpakfile.install->files.resize(reader.readCount());
+        for (auto& file : cpakfile.install->files) {
+            file.glob = reader.readString();
+            file.type = static_cast<FileType>(
+                std::min<std::uint64_t>(reader.readNumber(), 3));
+        }
+
+        cpakfile.install->global = reader.readBool();
+    }
+
+    if (reader.failed || reader.current != reader.end) return std::nullopt;
+    return cpakfile;
+}
+
+
+std::tuple<std::optional<CPakFile>, std::error_code>
+cpak::snapshot::loadSnapshot(string_view key) noexcept {
+    const auto path = snapshotPath(key);
+    std::optional<CPakFile> cpakfile;
+#if defined(__unix__) || defined(__APPLE__)
+    const auto descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (descriptor < 0)
+        return std::make_tuple(cpakfile, make_error_code(errc::cacheMiss));
+
+    struct stat info;
+    const auto size = ::fstat(descriptor, &info) == 0
+        ? static_cast<std::size_t>(info.st_size)
+        : 0;
+    auto* mapping = size != 0
+        ? ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0)
+        : MAP_FAILED;
+    ::close(descriptor);
+
+    if (mapping == MAP_FAILED)
+        return std::make_tuple(cpakfile, make_error_code(errc::cacheMiss));
+
+    cpakfile = decodeCPakFile(static_cast<const std::uint8_t*>(mapping), size);
+    ::munmap(mapping, size);
+#else
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream.is_open())
+        return std::make_tuple(cpakfile, make_error_code(errc::cacheMiss));
+
+    const vector<std::uint8_t> contents(std::istreambuf_iterator<char>(stream),
+                                        {});
+    cpakfile = decodeCPakFile(contents.data(), contents.size());
+#endif
+
+    return std::make_tuple(cpakfile, cpakfile.has_value()
+        ? make_error_code(errc::success)
+        : make_error_code(errc::cacheMiss));
+}
+
+
+std::error_code
+cpak::snapshot::storeSnapshot(string_view key,
+                              const CPakFile& cpakfile) noexcept {
+    std::error_code error;
+    const auto path = snapshotPath(key);
+    fs::create_directories(path.parent_path(), error);
+    if (error) return make_error_code(errc::cacheStoreFailed);
+
+    // Write next to the snapshot and rename, so readers never see partial
+    // snapshots.
+    auto temporaryPath = path;
+    temporaryPath += fmt::format(
+        ".{}.tmp", std::chrono::steady_clock::now().time_since_epoch().count());
+
+    const auto encoded = encodeCPakFile(cpakfile);
+    std::ofstream stream(temporaryPath, std::ios::binary | std::ios::trunc);
+    stream.write(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+    stream.close();
+
+    if (stream) fs::rename(temporaryPath, path, error);
+    if (!stream || error) {
+        fs::remove(temporaryPath, error);
+        return make_error_code(errc::cacheStoreFailed);
+    }
+
+    return make_error_code(errc::success);
+}
\ No newline at end of file
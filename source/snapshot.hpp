@@ -0,0 +1,54 @@
+#pragma once
+#include "cpakfile.hpp"
+
+namespace cpak::snapshot {
+
+
+/// @brief Version of the snapshot encoding, bumped whenever the model changes.
+constexpr std::uint32_t kFormatVersion = 3;
+
+
+/// @brief   Computes the snapshot key of a CPakFile.
+/// @details The key covers the digest of the file contents, the snapshot
+///          format and the version of cpak that decoded it, so upgrading cpak
+///          never reuses a snapshot written by another version.
+/// @param   contentDigest The digest of the CPakFile contents.
+/// @return  The key of the snapshot.
+std::string
+snapshotKey(std::string_view contentDigest) noexcept;
+
+
+/// @brief   Encodes a decoded CPakFile into a compact binary snapshot.
+/// @details Only the model read from the file is encoded, paths and other
+///          state set up during the build are not.
+/// @param   cpakfile The CPakFile to encode.
+/// @return  The encoded snapshot.
+std::vector<std::uint8_t>
+encodeCPakFile(const CPakFile& cpakfile) noexcept;
+
+
+/// @brief  Decodes a binary snapshot back into a CPakFile.
+/// @param  data The start of the snapshot.
+/// @param  size The size of the snapshot.
+/// @return The decoded CPakFile, or nothing if the snapshot is malformed.
+std::optional<CPakFile>
+decodeCPakFile(const std::uint8_t* data, std::size_t size) noexcept;
+
+
+/// @brief   Loads the snapshot stored under the given key.
+/// @details The snapshot is mapped into memory and decoded in place.
+/// @param   key The key computed by \c snapshotKey.
+/// @return  The CPakFile and the status code, \c cacheMiss if not stored.
+std::tuple<std::optional<CPakFile>, std::error_code>
+loadSnapshot(std::string_view key) noexcept;
+
+
+/// @brief  Stores a snapshot of the CPakFile under the given key.
+/// @param  key The key computed by \c snapshotKey.
+/// @param  cpakfile The freshly decoded CPakFile.
+/// @return The status code for the operation.
+std::error_code
+storeSnapshot(std::string_view key, const CPakFile& cpakfile) noexcept;
+
+
+} // namespace cpak::snapshot
\ No newline at end of file
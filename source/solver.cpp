@@ -0,0 +1,747 @@
+#include "solver.hpp"
+#include "errorcode.hpp"
+
+
+namespace solver = cpak::solver;
+
+using cpak::version;
+using std::string;
+using std::vector;
+
+
+namespace {
+
+
+constexpr auto kNone = std::numeric_limits<std::size_t>::max();
+constexpr auto kRoot = std::size_t(0);
+
+
+/// @brief One flag for every version of a package, in the order the package
+///        lists them.
+using VersionSet = vector<bool>;
+
+
+/// @brief   A statement about the version selected for a package.
+/// @details A positive term holds when a version in the set is selected, a
+///          negative term holds when none of them is, including when the
+///          package isn't selected at all.
+struct Term {
+    std::size_t package;
+    bool positive;
+    VersionSet versions;
+};
+
+
+enum class Cause { Root, Dependency, NoVersions, Derived };
+
+
+/// @brief A set of terms that can't all hold at once.
+struct Incompatibility {
+    vector<Term> terms;
+    Cause cause;
+
+    // The incompatibilities a derived incompatibility follows from.
+    std::size_t left{ kNone };
+    std::size_t right{ kNone };
+
+    // What a dependency incompatibility is about.
+    std::size_t dependency{ kNone };
+    string constraint;
+};
+
+
+/// @brief A term that was decided or derived while solving.
+struct Assignment {
+    Term term;
+    std::size_t level;
+    std::size_t cause; // kNone for decisions.
+};
+
+
+struct Package {
+    string name;
+    vector<version> versions; // Highest first.
+    std::size_t preferred{ kNone };
+    std::size_t decision{ kNone };
+    vector<std::size_t> incompatibilities;
+    vector<std::size_t> assignments;
+};
+
+
+bool
+isSubset(const VersionSet& lhs, const VersionSet& rhs) noexcept {
+    for (auto index = 0u; index < lhs.size(); ++index)
+        if (lhs[index] && !rhs[index]) return false;
+    return true;
+}
+
+
+bool
+isDisjoint(const VersionSet& lhs, const VersionSet& rhs) noexcept {
+    for (auto index = 0u; index < lhs.size(); ++index)
+        if (lhs[index] && rhs[index]) return false;
+    return true;
+}
+
+
+bool
+isEmpty(const VersionSet& versions) noexcept {
+    return std::none_of(versions.begin(), versions.end(),
+                        [](bool accepted) { return accepted; });
+}
+
+
+Term
+negate(Term term) noexcept {
+    term.positive = !term.positive;
+    return term;
+}
+
+
+Term
+intersect(const Term& lhs, const Term& rhs) noexcept {
+    auto result = lhs;
+    for (auto index = 0u; index < lhs.versions.size(); ++index) {
+        const bool left = lhs.versions[index], right = rhs.versions[index];
+        if (lhs.positive && rhs.positive) result.versions[index] = left && right;
+        else if (lhs.positive) result.versions[index] = left && !right;
+        else if (rhs.positive) result.versions[index] = right && !left;
+        else result.versions[index] = left || right;
+    }
+
+    result.positive = lhs.positive || rhs.positive;
+    return result;
+}
+
+
+Term
+unite(const Term& lhs, const Term& rhs) noexcept {
+    return negate(intersect(negate(lhs), negate(rhs)));
+}
+
+
+/// @brief  Checks whether every selection allowed by lhs also satisfies rhs.
+bool
+satisfies(const Term& lhs, const Term& rhs) noexcept {
+    if (lhs.positive && rhs.positive) return isSubset(lhs.versions, rhs.versions);
+    if (lhs.positive) return isDisjoint(lhs.versions, rhs.versions);
+    if (rhs.positive) return false; // lhs allows not selecting the package.
+    return isSubset(rhs.versions, lhs.versions);
+}
+
+
+/// @brief  Checks whether no selection allowed by lhs satisfies rhs.
+bool
+contradicts(const Term& lhs, const Term& rhs) noexcept {
+    if (lhs.positive && rhs.positive) return isDisjoint(lhs.versions, rhs.versions);
+    if (lhs.positive) return isSubset(lhs.versions, rhs.versions);
+    if (rhs.positive) return isSubset(rhs.versions, lhs.versions);
+    return false;
+}
+
+
+/// @brief  Checks whether a term holds for any selection.
+bool
+isAny(const Term& term) noexcept {
+    return !term.positive && isEmpty(term.versions);
+}
+
+
+class Solver {
+public:
+    Solver(const string& root,
+           const vector<solver::Requirement>& requirements,
+           const solver::PackageSource& source)
+        : source_(source), rootRequirements_(requirements) {
+        packages_.push_back({ .name = root, .versions = { version() } });
+    }
+
+    std::error_code
+    solve(solver::Selection& selection) noexcept {
+        // The root has to be selected.
+        addIncompatibility({ .terms = { { kRoot, false, { true } } },
+                             .cause = Cause::Root });
+
+        auto next = std::optional<std::size_t>(kRoot);
+        while (next != std::nullopt) {
+            auto result = propagate(*next);
+            if (result.value() != cpak::errc::success) return result;
+
+            std::tie(next, result) = choosePackageVersion();
+            if (result.value() != cpak::errc::success) return result;
+        }
+
+        for (auto package = kRoot + 1; package < packages_.size(); ++package) {
+            const auto& selected = packages_[package];
+            if (selected.decision != kNone)
+                selection[selected.name] = selected.versions[selected.decision];
+        }
+
+        return cpak::make_error_code(cpak::errc::success);
+    }
+
+    /// @brief   Writes out why the root could not be selected.
+    /// @details Follows the derivation of the incompatibility that failed the
+    ///          solve. Incompatibilities that are used more than once are
+    ///          numbered so later lines can refer back to them.
+    vector<string>
+    explain() const noexcept {
+        vector<string> lines;
+        if (failure_ == kNone) return lines;
+
+        std::map<std::size_t, std::size_t> references;
+        countReferences(failure_, references);
+
+        std::map<std::size_t, std::size_t> numbers;
+        visit(failure_, references, numbers, lines);
+        return lines;
+    }
+
+private:
+    enum class Relation { Satisfied, AlmostSatisfied, Contradicted, Inconclusive };
+
+    std::tuple<std::size_t, std::error_code>
+    findPackage(const string& name) noexcept {
+        for (auto package = kRoot + 1; package < packages_.size(); ++package)
+            if (packages_[package].name == name)
+                return { package, cpak::make_error_code(cpak::errc::success) };
+
+        auto [versions, result] = source_.versions(name);
+        if (result.value() != cpak::errc::success) return { kNone, result };
+
+        std::sort(versions.begin(), versions.end(), std::greater<>());
+        versions.erase(std::unique(versions.begin(), versions.end()), versions.end());
+
+        Package package{ .name = name, .versions = std::move(versions) };
+        const auto preferred = source_.preferred
+            ? source_.preferred(name)
+            : std::nullopt;
+        if (preferred != std::nullopt) {
+            const auto iter = std::find(package.versions.begin(),
+                                        package.versions.end(), *preferred);
+            if (iter != package.versions.end())
+                package.preferred = iter - package.versions.begin();
+        }
+
+        packages_.push_back(std::move(package));
+        return { packages_.size() - 1, cpak::make_error_code(cpak::errc::success) };
+    }
+
+    VersionSet
+    accepted(std::size_t package, const cpak::VersionConstraint& constraint) const {
+        const auto& versions = packages_[package].versions;
+        VersionSet result(versions.size());
+        for (auto index = 0u; index < versions.size(); ++index)
+            result[index] = constraint.acceptsVersion(versions[index]);
+        return result;
+    }
+
+    std::size_t
+    addIncompatibility(Incompatibility incompatibility, bool track = true) {
+        // Terms that always hold don't constrain anything, and the root is
+        // always selected so it only matters on its own.
+        std::erase_if(incompatibility.terms, isAny);
+        if (incompatibility.cause == Cause::Derived && incompatibility.terms.size() > 1)
+            std::erase_if(incompatibility.terms, [](const Term& term) {
+                return term.package == kRoot && term.positive;
+            });
+
+        const auto index = incompatibilities_.size();
+        incompatibilities_.push_back(std::move(incompatibility));
+        if (track) trackIncompatibility(index);
+        return index;
+    }
+
+    void
+    trackIncompatibility(std::size_t index) {
+        for (const auto& term : incompatibilities_[index].terms)
+            packages_[term.package].incompatibilities.push_back(index);
+    }
+
+    Term
+    anyVersion(std::size_t package) const {
+        return { package, false, VersionSet(packages_[package].versions.size()) };
+    }
+
+    /// @brief  Gets what the assignments before the given one say about a
+    ///         package.
+    Term
+    current(std::size_t package, std::size_t before = kNone) const {
+        auto term = anyVersion(package);
+        for (const auto index : packages_[package].assignments) {
+            if (index >= before) break;
+            term = intersect(term, assignments_[index].term);
+        }
+
+        return term;
+    }
+
+    Relation
+    relation(const Incompatibility& incompatibility, Term& unsatisfied) const {
+        auto found = false;
+        for (const auto& term : incompatibility.terms) {
+            const auto known = current(term.package);
+            if (satisfies(known, term)) continue;
+            if (contradicts(known, term)) return Relation::Contradicted;
+            if (found) return Relation::Inconclusive;
+
+            unsatisfied = term;
+            found       = true;
+        }
+
+        return found ? Relation::AlmostSatisfied : Relation::Satisfied;
+    }
+
+    void
+    assign(Term term, std::size_t cause) {
+        packages_[term.package].assignments.push_back(assignments_.size());
+        assignments_.push_back({ std::move(term), level_, cause });
+    }
+
+    void
+    decide(std::size_t package, std::size_t versionIndex) {
+        VersionSet versions(packages_[package].versions.size());
+        versions[versionIndex] = true;
+
+        ++level_;
+        packages_[package].decision = versionIndex;
+        assign({ package, true, std::move(versions) }, kNone);
+    }
+
+    void
+    backtrack(std::size_t level) {
+        while (!assignments_.empty() && assignments_.back().level > level) {
+            auto& package = packages_[assignments_.back().term.package];
+            if (assignments_.back().cause == kNone) package.decision = kNone;
+
+            package.assignments.pop_back();
+            assignments_.pop_back();
+        }
+
+        level_ = level;
+    }
+
+    /// @brief  Finds the first assignment after which the term holds.
+    /// @return The index of the assignment, or kNone if it always holds.
+    std::size_t
+    findSatisfier(const Term& term) const {
+        auto known = anyVersion(term.package);
+        for (const auto index : packages_[term.package].assignments) {
+            known = intersect(known, assignments_[index].term);
+            if (satisfies(known, term)) return index;
+        }
+
+        return kNone;
+    }
+
+    static bool
+    isFailure(const Incompatibility& incompatibility) noexcept {
+        const auto& terms = incompatibility.terms;
+        return terms.empty() || (terms.size() == 1 && terms[0].positive &&
+                                 terms[0].package == kRoot);
+    }
+
+    /// @brief   Learns why an incompatibility is satisfied.
+    /// @details Derives incompatibilities until one is found that is only
+    ///          satisfied because of a decision, then backtracks to before
+    ///          that decision.
+    /// @return  The incompatibility to propagate from, and whether solving
+    ///          failed instead.
+    std::tuple<std::size_t, bool>
+    resolveConflict(std::size_t conflict) {
+        auto index = conflict;
+        while (!isFailure(incompatibilities_[index])) {
+            const auto terms = incompatibilities_[index].terms;
+
+            // The satisfier is the assignment that made the incompatibility
+            // hold, the previous level is where it held except for that.
+            auto satisfier = kNone, termIndex = kNone;
+            std::size_t previousLevel = 1;
+            vector<std::size_t> satisfiers(terms.size());
+            for (auto term = 0u; term < terms.size(); ++term) {
+                satisfiers[term] = findSatisfier(terms[term]);
+                if (satisfiers[term] == kNone) continue;
+                if (satisfier == kNone || satisfiers[term] > satisfier) {
+                    satisfier = satisfiers[term];
+                    termIndex = term;
+                }
+            }
+
+            if (satisfier == kNone) break; // Holds no matter what.
+
+            for (auto term = 0u; term < terms.size(); ++term)
+                if (term != termIndex && satisfiers[term] != kNone)
+                    previousLevel = std::max(previousLevel,
+                                             assignments_[satisfiers[term]].level);
+
+            const auto& term     = terms[termIndex];
+            const auto assigned  = assignments_[satisfier];
+            auto known = anyVersion(term.package);
+            for (const auto before : packages_[term.package].assignments) {
+                if (before >= satisfier) break;
+                known = intersect(known, assignments_[before].term);
+                if (satisfies(intersect(known, assigned.term), term)) {
+                    previousLevel = std::max(previousLevel, assignments_[before].level);
+                    break;
+                }
+            }
+
+            if (assigned.cause == kNone || previousLevel < assigned.level) {
+                if (index != conflict) trackIncompatibility(index);
+                backtrack(previousLevel);
+                return { index, false };
+            }
+
+            // Replace the satisfier's package by what caused the satisfier.
+            Incompatibility prior{ .cause = Cause::Derived,
+                                   .left  = index,
+                                   .right = assigned.cause };
+            const auto merge = [&](const Term& added) {
+                for (auto& existing : prior.terms) {
+                    if (existing.package != added.package) continue;
+                    existing = intersect(existing, added);
+                    return;
+                }
+
+                prior.terms.push_back(added);
+            };
+
+            for (const auto& other : terms)
+                if (other.package != term.package) merge(other);
+            for (const auto& other : incompatibilities_[assigned.cause].terms)
+                if (other.package != term.package) merge(other);
+            if (!satisfies(assigned.term, term))
+                merge(unite(term, negate(assigned.term)));
+
+            index = addIncompatibility(std::move(prior), false);
+        }
+
+        return { index, true };
+    }
+
+    std::error_code
+    propagate(std::size_t package) {
+        vector<std::size_t> changed{ package };
+        while (!changed.empty()) {
+            const auto next = changed.back();
+            changed.pop_back();
+
+            // Newer incompatibilities are more specific, so they go first.
+            const auto incompatibilities = packages_[next].incompatibilities;
+            for (auto iter = incompatibilities.rbegin();
+                 iter != incompatibilities.rend(); ++iter) {
+                Term unsatisfied;
+                const auto found = relation(incompatibilities_[*iter], unsatisfied);
+                if (found == Relation::AlmostSatisfied) {
+                    changed.push_back(unsatisfied.package);
+                    assign(negate(std::move(unsatisfied)), *iter);
+                    continue;
+                }
+
+                if (found != Relation::Satisfied) continue;
+
+                const auto [cause, failed] = resolveConflict(*iter);
+                if (failed) {
+                    failure_ = cause;
+                    return cpak::make_error_code(cpak::errc::versionConflict);
+                }
+
+                relation(incompatibilities_[cause], unsatisfied);
+                changed = { unsatisfied.package };
+                assign(negate(std::move(unsatisfied)), cause);
+                break;
+            }
+        }
+
+        return cpak::make_error_code(cpak::errc::success);
+    }
+
+    std::tuple<vector<solver::Requirement>, std::error_code>
+    requirementsOf(std::size_t package, std::size_t versionIndex) {
+        if (package == kRoot)
+            return { rootRequirements_, cpak::make_error_code(cpak::errc::success) };
+
+        const auto key  = std::make_pair(package, versionIndex);
+        const auto iter = requirements_.find(key);
+        if (iter != requirements_.end())
+            return { iter->second, cpak::make_error_code(cpak::errc::success) };
+
+        const auto& selected = packages_[package];
+        auto [requirements, result] = source_.requirements(
+            selected.name, selected.versions[versionIndex]);
+        if (result.value() == cpak::errc::success)
+            requirements_[key] = requirements;
+
+        return { requirements, result };
+    }
+
+    /// @brief   Picks a version of a package that is required but undecided.
+    /// @details The package with the fewest versions left goes first, since
+    ///          it is the most likely to conflict. The preferred version is
+    ///          picked if it is allowed, the highest one otherwise.
+    /// @return  The package to propagate from, or nothing once every
+    ///          required package has a version.
+    std::tuple<std::optional<std::size_t>, std::error_code>
+    choosePackageVersion() {
+        auto chosen = kNone;
+        auto choices = std::numeric_limits<std::size_t>::max();
+        for (auto package = kRoot; package < packages_.size(); ++package) {
+            if (packages_[package].decision != kNone) continue;
+
+            const auto known = current(package);
+            if (!known.positive) continue;
+
+            const auto count = std::size_t(
+                std::count(known.versions.begin(), known.versions.end(), true));
+            if (count < choices) {
+                chosen  = package;
+                choices = count;
+            }
+        }
+
+        if (chosen == kNone)
+            return { std::nullopt, cpak::make_error_code(cpak::errc::success) };
+
+        const auto known = current(chosen);
+        if (choices == 0) {
+            addIncompatibility({ .terms = { known }, .cause = Cause::NoVersions });
+            return { chosen, cpak::make_error_code(cpak::errc::success) };
+        }
+
+        const auto preferred = packages_[chosen].preferred;
+        const auto versionIndex = preferred != kNone && known.versions[preferred]
+            ? preferred
+            : std::size_t(std::find(known.versions.begin(), known.versions.end(), true) -
+                          known.versions.begin());
+
+        auto [requirements, result] = requirementsOf(chosen, versionIndex);
+        if (result.value() != cpak::errc::success)
+            return { std::nullopt, result };
+
+        // Don't decide on a version whose requirements are known to conflict.
+        auto conflicts = false;
+        VersionSet selected(packages_[chosen].versions.size());
+        selected[versionIndex] = true;
+        for (const auto& [name, constraint] : requirements) {
+            const auto [dependency, found] = findPackage(name);
+            if (found.value() != cpak::errc::success)
+                return { std::nullopt, found };
+            if (dependency == chosen) continue;
+
+            const auto index = addIncompatibility({
+                .terms      = { { chosen, true, selected },
+                                { dependency, false, accepted(dependency, constraint) } },
+                .cause      = Cause::Dependency,
+                .dependency = dependency,
+                .constraint = constraint.str(),
+            });
+
+            const auto& terms = incompatibilities_[index].terms;
+            conflicts = conflicts || std::all_of(terms.begin(), terms.end(),
+                [&](const Term& term) {
+                    return term.package == chosen ||
+                           satisfies(current(term.package), term);
+                });
+        }
+
+        if (!conflicts) decide(chosen, versionIndex);
+        return { chosen, cpak::make_error_code(cpak::errc::success) };
+    }
+
+    string
+    describeVersions(std::size_t package, const VersionSet& versions) const {
+        const auto& name = packages_[package].name;
+        const auto& all  = packages_[package].versions;
+        if (package == kRoot) return name;
+
+        const auto count = std::count(versions.begin(), versions.end(), true);
+        if (count == 0) return fmt::format("no versions of {}", name);
+        if (count > 1 && count == std::ptrdiff_t(all.size()))
+            return fmt::format("every version of {}", name);
+
+        // Runs of versions are written as ranges, lowest first. Versions are
+        // listed highest first, so runs are walked backwards.
+        string ranges;
+        for (auto lowest = all.size(); lowest-- > 0;) {
+            if (!versions[lowest]) continue;
+
+            auto highest = lowest;
+            while (highest > 0 && versions[highest - 1]) --highest;
+
+            if (count == 1)
+                return fmt::format("{}@{}", name, all[lowest].str());
+
+            if (!ranges.empty()) ranges += " || ";
+            if (lowest == highest)
+                ranges += all[lowest].str();
+            else if (lowest == all.size() - 1)
+                ranges += fmt::format("<={}", all[highest].str());
+            else if (highest == 0)
+                ranges += fmt::format(">={}", all[lowest].str());
+            else
+                ranges += fmt::format(">={} <={}", all[lowest].str(),
+                                      all[highest].str());
+            lowest = highest;
+        }
+
+        return fmt::format("{} {}", name, ranges);
+    }
+
+    string
+    describe(const Term& term) const {
+        return term.positive
+            ? describeVersions(term.package, term.versions)
+            : fmt::format("not {}", describeVersions(term.package, term.versions));
+    }
+
+    string
+    describe(std::size_t index) const {
+        const auto& incompatibility = incompatibilities_[index];
+        const auto& terms           = incompatibility.terms;
+        switch (incompatibility.cause) {
+        case Cause::Dependency: {
+            const auto& dependent = packages_[incompatibility.dependency].name;
+            const auto matches    = terms.size() == 2 && !isEmpty(terms[1].versions);
+            return fmt::format("{} depends on {} {}{}",
+                               describe(terms[0]), dependent, incompatibility.constraint,
+                               matches ? "" : ", which matches no versions");
+        }
+        case Cause::NoVersions:
+            return fmt::format("no versions of {} are left",
+                               packages_[terms[0].package].name);
+        default: break;
+        }
+
+        if (isFailure(incompatibility)) return "version solving failed";
+        if (terms.size() == 1)
+            return terms[0].positive
+                ? fmt::format("{} is forbidden", describe(terms[0]))
+                : fmt::format("{} is required", describe(negate(terms[0])));
+
+        if (terms.size() == 2 && terms[0].positive != terms[1].positive) {
+            const auto& positive = terms[0].positive ? terms[0] : terms[1];
+            const auto& negative = terms[0].positive ? terms[1] : terms[0];
+            return fmt::format("{} requires {}", describe(positive),
+                               describe(negate(negative)));
+        }
+
+        if (terms.size() == 2 && terms[0].positive)
+            return fmt::format("{} is incompatible with {}", describe(terms[0]),
+                               describe(terms[1]));
+
+        string described;
+        for (const auto& term : terms)
+            described += (described.empty() ? "" : ", ") + describe(term);
+        return fmt::format("one of {} must be false", described);
+    }
+
+    bool
+    isDerived(std::size_t index) const noexcept {
+        return index != kNone && incompatibilities_[index].cause == Cause::Derived;
+    }
+
+    void
+    countReferences(std::size_t index,
+                    std::map<std::size_t, std::size_t>& references) const {
+        if (!isDerived(index)) return;
+        for (const auto cause : { incompatibilities_[index].left,
+                                  incompatibilities_[index].right }) {
+            if (references[cause]++ == 0) countReferences(cause, references);
+        }
+    }
+
+    void
+    visit(std::size_t index,
+          const std::map<std::size_t, std::size_t>& references,
+          std::map<std::size_t, std::size_t>& numbers,
+          vector<string>& lines,
+          bool numbered = false) const {
+        const auto write = [&](string line) {
+            const auto count = references.find(index);
+            if (numbered || (count != references.end() && count->second > 1)) {
+                numbers[index] = numbers.size() + 1;
+                line += fmt::format(" ({})", numbers[index]);
+            }
+
+            lines.push_back(std::move(line));
+        };
+
+        const auto reference = [&](std::size_t cause) {
+            const auto number = numbers.find(cause);
+            return number == numbers.end()
+                ? describe(cause)
+                : fmt::format("{} ({})", describe(cause), number->second);
+        };
+
+        // Solving can fail on an external incompatibility alone, which has no
+        // causes to explain.
+        if (!isDerived(index)) {
+            write(fmt::format("Because {}, version solving failed.", describe(index)));
+            return;
+        }
+
+        const auto left  = incompatibilities_[index].left;
+        const auto right = incompatibilities_[index].right;
+        if (isDerived(left) && isDerived(right)) {
+            const auto leftNumbered  = numbers.contains(left);
+            const auto rightNumbered = numbers.contains(right);
+            if (leftNumbered && rightNumbered) {
+                write(fmt::format("Because {} and {}, {}.", reference(left),
+                                  reference(right), describe(index)));
+            } else if (leftNumbered || rightNumbered) {
+                const auto known = leftNumbered ? left : right;
+                visit(leftNumbered ? right : left, references, numbers, lines);
+                write(fmt::format("And because {}, {}.", reference(known),
+                                  describe(index)));
+            } else {
+                visit(left, references, numbers, lines, true);
+                visit(right, references, numbers, lines);
+                write(fmt::format("And because {}, {}.", reference(left),
+                                  describe(index)));
+            }
+        } else if (isDerived(left) || isDerived(right)) {
+            const auto derived  = isDerived(left) ? left : right;
+            const auto external = isDerived(left) ? right : left;
+            if (numbers.contains(derived)) {
+                write(fmt::format("Because {} and {}, {}.", describe(external),
+                                  reference(derived), describe(index)));
+            } else {
+                visit(derived, references, numbers, lines);
+                write(fmt::format("And because {}, {}.", describe(external),
+                                  describe(index)));
+            }
+        } else {
+            write(fmt::format("Because {} and {}, {}.", describe(left),
+                              describe(right), describe(index)));
+        }
+    }
+
+    const solver::PackageSource& source_;
+    const vector<solver::Requirement>& rootRequirements_;
+
+    vector<Package> packages_;
+    vector<Incompatibility> incompatibilities_;
+    vector<Assignment> assignments_;
+    std::map<std::pair<std::size_t, std::size_t>, vector<solver::Requirement>>
+        requirements_;
+    std::size_t level_{ 0 };
+    std::size_t failure_{ kNone };
+};
+
+
+} // namespace
+
+
+std::tuple<solver::Selection, std::error_code>
+solver::resolve(const std::string& root,
+                const std::vector<Requirement>& requirements,
+                const PackageSource& source,
+                std::vector<std::string>* explanation) noexcept {
+    Selection selection;
+    Solver solver(root, requirements, source);
+    const auto result = solver.solve(selection);
+    if (result.value() == errc::versionConflict && explanation != nullptr)
+        *explanation = solver.explain();
+
+    return std::make_tuple(selection, result);
+}
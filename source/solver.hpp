@@ -0,0 +1,53 @@
+#pragma once
+#include "constraint.hpp"
+
+namespace cpak::solver {
+
+
+/// @brief A package and the versions of it that are accepted.
+struct Requirement {
+    std::string package;
+    VersionConstraint constraint;
+};
+
+
+/// @brief   Where the solver learns about the packages it is resolving.
+/// @details The solver only asks for the versions of a package once it is
+///          required, and for the requirements of a version once it tries to
+///          select it.
+struct PackageSource {
+    /// @brief Lists the versions of a package that can be selected.
+    std::function<std::tuple<std::vector<version>, std::error_code>(
+        const std::string& package)> versions;
+
+    /// @brief Lists what a version of a package requires.
+    std::function<std::tuple<std::vector<Requirement>, std::error_code>(
+        const std::string& package, const version& semv)> requirements;
+
+    /// @brief The version to try first if it is accepted, e.g. a locked one.
+    std::function<std::optional<version>(const std::string& package)> preferred;
+};
+
+
+/// @brief The version selected for every package, by package.
+using Selection = std::map<std::string, version>;
+
+
+/// @brief   Selects one version of every package required by the root.
+/// @details Uses PubGrub: requirements become incompatibilities, and every
+///          conflict is turned into a new incompatibility explaining it, so a
+///          dead end is never visited twice. When no selection exists, the
+///          incompatibilities that led to it are written out as the reason.
+/// @param   root The name to use for the root in explanations.
+/// @param   requirements What the root requires.
+/// @param   source Where the versions and requirements of packages come from.
+/// @param   explanation Receives why nothing could be selected, line by line.
+/// @return  The selected versions and the status code for the operation.
+std::tuple<Selection, std::error_code>
+resolve(const std::string& root,
+        const std::vector<Requirement>& requirements,
+        const PackageSource& source,
+        std::vector<std::string>* explanation = nullptr) noexcept;
+
+
+} // namespace cpak::solver
@@ -23,24 +23,27 @@ enum struct TargetType {
 /// @remarks This is based on the options that are available in the GNU
 ///          toolchain.
 struct SearchPaths {
-    Accessibles<std::string> include;
-    Accessibles<std::string> system;
-    Accessibles<std::string> library;
+    Accessibles<InternedString> include;
+    Accessibles<InternedString> system;
+    Accessibles<InternedString> library;
 };
 
 
 /// @brief   Contains the build target information.
 /// @details ...
 struct BuildTarget {
-    Accessibles<std::string> defines;
-    Accessibles<std::string> interfaces;
-    Accessibles<std::string> libraries;
-    Accessibles<std::string> sources;
-    Accessibles<std::string> options;
+    Accessibles<InternedString> defines;
+    Accessibles<InternedString> interfaces;
+    Accessibles<InternedString> libraries;
+    Accessibles<InternedString> sources;
+    Accessibles<InternedString> options;
     std::optional<SearchPaths> search;
 
-    std::string name{ "INVALID" };
+    InternedString name{ "INVALID" };
     TargetType  type{ TargetType::Undefined };
+
+    /// @brief The options this target interpolated and the values they had.
+    std::map<std::string, std::string> referencedOptions;
 };
 
 
@@ -160,17 +163,19 @@ validateTargetSchema(const YAML::Node& node) {
 /// @param  level The access level to assign to the vector.
 /// @param  value The string to create the vector from.
 /// @param  delimiter How to split the string into values.
+/// @param  allocator The allocator of the created vector.
 /// @return The created vector.
-inline Accessibles<std::string>
+inline Accessibles<InternedString>
 accessiblesFromString(AccessLevel level,
                       std::string_view value,
-                      char delimiter = ' ') noexcept {
+                      char delimiter = ' ',
+                      const AccessiblesAllocator<InternedString>& allocator = {}) noexcept {
     // Split the string into vector of strings, then assign.
-    Accessibles<std::string> values;
+    Accessibles<InternedString> values(allocator);
     std::istringstream iss(value.data());
     std::string token;
     while (std::getline(iss, token, delimiter)) {
-        values.push_back(Accessible{
+        values.push_back(Accessible<InternedString>{
             .stored = token,
             .level = level,
         });
@@ -185,7 +190,7 @@ accessiblesFromString(AccessLevel level,
 /// @param  delimiter How to join the values into a string.
 /// @return The created string.
 inline std::string
-accessiblesToString(const Accessibles<std::string>& accessibles,
+accessiblesToString(const Accessibles<InternedString>& accessibles,
                     char delimiter = ' ') noexcept {
     std::ostringstream oss;
     for (const auto& value : accessibles)
@@ -195,14 +200,91 @@ accessiblesToString(const Accessibles<std::string>& accessibles,
 }
 
 
+/// @brief  Creates empty search paths that allocate with the given allocator.
+/// @param  allocator The allocator of the search paths.
+/// @return The created search paths.
+inline SearchPaths
+makeSearchPaths(const AccessiblesAllocator<InternedString>& allocator) noexcept {
+    return SearchPaths{
+        .include = Accessibles<InternedString>(allocator),
+        .system  = Accessibles<InternedString>(allocator),
+        .library = Accessibles<InternedString>(allocator),
+    };
+}
+
+
+/// @brief  Creates an empty target that allocates with the given allocator.
+/// @param  allocator The allocator of the target's properties.
+/// @return The created target.
+inline BuildTarget
+makeBuildTarget(const AccessiblesAllocator<InternedString>& allocator) noexcept {
+    return BuildTarget{
+        .defines    = Accessibles<InternedString>(allocator),
+        .interfaces = Accessibles<InternedString>(allocator),
+        .libraries  = Accessibles<InternedString>(allocator),
+        .sources    = Accessibles<InternedString>(allocator),
+        .options    = Accessibles<InternedString>(allocator),
+    };
+}
+
+
 inline void
-assignTargetToAccessibles(Accessibles<std::string>& accessibles,
+assignTargetToAccessibles(Accessibles<InternedString>& accessibles,
                           BuildTarget* target) noexcept {
     for (auto& accessible : accessibles)
         accessible.owner = target;
 }
 
 
+/// @brief Points the accessibles of the given target back at it.
+/// @param target The target whose accessibles are updated.
+inline void
+assignTargetToAccessibles(BuildTarget& target) noexcept {
+    assignTargetToAccessibles(target.defines, &target);
+    assignTargetToAccessibles(target.interfaces, &target);
+    assignTargetToAccessibles(target.libraries, &target);
+    assignTargetToAccessibles(target.sources, &target);
+    assignTargetToAccessibles(target.options, &target);
+    if (target.search != std::nullopt) {
+        assignTargetToAccessibles(target.search->include, &target);
+        assignTargetToAccessibles(target.search->system, &target);
+        assignTargetToAccessibles(target.search->library, &target);
+    }
+}
+
+
+/// @brief Interpolates the options referenced by the given target.
+/// @param target The target to interpolate, its referenced options are
+///               replaced by the ones it uses.
+/// @param table The options to interpolate, by name.
+inline void
+interpolateOptions(BuildTarget& target, const OptionTable& table) {
+    const auto interpolate = [&](InternedString& value) {
+        // Only strings that reference options need to be interned again.
+        if (value.view().find("${") == std::string_view::npos) return;
+
+        auto interpolated = value.str();
+        interpolateOptions(interpolated, table, target.referencedOptions);
+        value = interpolated;
+    };
+
+    // TODO: support interpolation of the target type.
+    target.referencedOptions.clear();
+    interpolate(target.name);
+    for (auto&& val : target.defines) interpolate(val.stored);
+    for (auto&& val : target.interfaces) interpolate(val.stored);
+    for (auto&& val : target.libraries) interpolate(val.stored);
+    for (auto&& val : target.sources) interpolate(val.stored);
+    for (auto&& val : target.options) interpolate(val.stored);
+
+    if (target.search != std::nullopt) {
+        for (auto&& val : target.search->include) interpolate(val.stored);
+        for (auto&& val : target.search->system) interpolate(val.stored);
+        for (auto&& val : target.search->library) interpolate(val.stored);
+    }
+}
+
+
 /// @brief  Converts the given target to a string.
 /// @param  target The target to convert to a string.
 /// @return The string representation of the target.
@@ -274,11 +356,11 @@ struct YAML::convert<cpak::SearchPaths> {
         cpak::validateSearchPathsSchema(node);
         cpak::SearchPaths paths;
         if (node["include"])
-            paths.include = node["include"].as<cpak::Accessibles<std::string>>();
+            paths.include = node["include"].as<cpak::Accessibles<cpak::InternedString>>();
         if (node["system"])
-            paths.system = node["system"].as<cpak::Accessibles<std::string>>();
+            paths.system = node["system"].as<cpak::Accessibles<cpak::InternedString>>();
         if (node["library"])
-            paths.library = node["library"].as<cpak::Accessibles<std::string>>();
+            paths.library = node["library"].as<cpak::Accessibles<cpak::InternedString>>();
         
         rhs = paths;
         return true;
@@ -343,7 +425,7 @@ struct YAML::convert<cpak::BuildTarget> {
             if (!node["sources"])
                 throw YAML::Exception(node.Mark(),
                                       "Target is missing sources.");
-            rhs.sources = node["sources"].as<cpak::Accessibles<std::string>>();
+            rhs.sources = node["sources"].as<cpak::Accessibles<cpak::InternedString>>();
             assignTargetToAccessibles(rhs.sources, target);
         }
 
@@ -369,23 +451,23 @@ struct YAML::convert<cpak::BuildTarget> {
                 rhs.options = accessiblesFromString(level, node["options"].as<std::string>());
                 assignTargetToAccessibles(rhs.options, target);
             } else if (node["options"].IsSequence()) {
-                rhs.options = node["options"].as<cpak::Accessibles<std::string>>();
+                rhs.options = node["options"].as<cpak::Accessibles<cpak::InternedString>>();
                 assignTargetToAccessibles(rhs.options, target);
             }
         }
 
         if (node["defines"]) {
-            rhs.defines = node["defines"].as<cpak::Accessibles<std::string>>();
+            rhs.defines = node["defines"].as<cpak::Accessibles<cpak::InternedString>>();
             assignTargetToAccessibles(rhs.defines, target);
         }
 
         if (node["libraries"]) {
-            rhs.libraries = node["libraries"].as<cpak::Accessibles<std::string>>();
+            rhs.libraries = node["libraries"].as<cpak::Accessibles<cpak::InternedString>>();
             assignTargetToAccessibles(rhs.libraries, target);
         }
 
         if (node["interfaces"]) {
-            rhs.interfaces = node["interfaces"].as<cpak::Accessibles<std::string>>();
+            rhs.interfaces = node["interfaces"].as<cpak::Accessibles<cpak::InternedString>>();
             assignTargetToAccessibles(rhs.interfaces, target);
         }
 
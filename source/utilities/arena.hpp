@@ -0,0 +1,88 @@
+#pragma once
+#include <memory_resource>
+#include "../common.hpp"
+
+namespace cpak::utilities {
+
+
+/// @brief   A monotonic arena for the model of a loaded project.
+/// @details Allocations are bumped out of large blocks and never released on
+///          their own, the blocks are all released at once when the arena is
+///          destroyed. An arena is not thread safe, it is meant to be filled
+///          by the thread that loads the project.
+using Arena = std::pmr::monotonic_buffer_resource;
+
+
+/// @brief  Creates a new arena.
+/// @param  initialSize The size of the first block of the arena.
+/// @return The shared arena.
+inline std::shared_ptr<Arena>
+makeArena(std::size_t initialSize = 16 * 1024) {
+    return std::make_shared<Arena>(initialSize);
+}
+
+
+/// @brief   An allocator that allocates from a shared arena.
+/// @details Unlike \c std::pmr::polymorphic_allocator, the allocator keeps its
+///          arena alive and moves along with the container that uses it, so a
+///          model allocated from an arena can be moved around and returned by
+///          value freely. Copies of a container are allocated from the heap
+///          instead, they can outlive the arena's project or be used from
+///          other threads. Without an arena the allocator uses the heap.
+/// @tparam  T The type of value to allocate.
+template<typename T>
+class ArenaAllocator {
+    public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap            = std::true_type;
+    using is_always_equal                        = std::false_type;
+
+    ArenaAllocator() noexcept = default;
+
+    explicit ArenaAllocator(std::shared_ptr<Arena> arena) noexcept
+        : arena_(std::move(arena))
+    { }
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept
+        : arena_(other.arena())
+    { }
+
+    T*
+    allocate(std::size_t count) {
+        if (arena_ == nullptr) return std::allocator<T>{}.allocate(count);
+        return static_cast<T*>(arena_->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void
+    deallocate(T* pointer, std::size_t count) noexcept {
+        // Arena memory is only released with the arena.
+        if (arena_ == nullptr) std::allocator<T>{}.deallocate(pointer, count);
+    }
+
+    ArenaAllocator
+    select_on_container_copy_construction() const noexcept {
+        return ArenaAllocator();
+    }
+
+    /// @brief  Gets the arena this allocator allocates from.
+    /// @return The arena, or null if the allocator uses the heap.
+    const std::shared_ptr<Arena>&
+    arena() const noexcept {
+        return arena_;
+    }
+
+    template<typename U>
+    friend bool
+    operator==(const ArenaAllocator& lhs, const ArenaAllocator<U>& rhs) noexcept {
+        return lhs.arena_ == rhs.arena();
+    }
+
+    private:
+    std::shared_ptr<Arena> arena_;
+};
+
+
+} // namespace cpak::utilities
@@ -1,17 +1,60 @@
 #pragma once
 #include "../cpakfile.hpp"
+#include "../errorcode.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define CPAK_CHECKSUM_SHANI 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+#define CPAK_CHECKSUM_ARMCRYPTO 1
+#include <arm_neon.h>
+#if defined(__linux__)
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+#if defined(__clang__)
+#define CPAK_CHECKSUM_ARMCRYPTO_TARGET __attribute__((target("crypto")))
+#else
+#define CPAK_CHECKSUM_ARMCRYPTO_TARGET __attribute__((target("+crypto")))
+#endif
+#endif
 
 namespace cpak::utilities {
 
 
+/// @brief Describes the implementations of the SHA-1 compression function.
+enum struct ChecksumBackend {
+    ePortable,
+    eShaNi,
+    eArmCrypto,
+};
+
+
 /// @brief   Structure for calculating a SHA-1 checksum.
 /// @details Given a string, this structure will calculate a SHA-1 checksum
 ///          for that string. This checksum will be used to differentiate the
-///          same project with different configurations.
+///          same project with different configurations. Input is compressed
+///          a full 64 byte chunk at a time, only a trailing partial chunk is
+///          buffered between updates. Chunks are compressed with the SHA
+///          extensions of the CPU when it has them, which is detected once at
+///          startup.
 struct Checksum {
-    using digest_t = std::array<std::uint32_t, 5>;
-    using chunk_t  = std::array<std::uint8_t, 64>;
-    using block_t  = std::array<std::uint8_t, 20>;
+    using digest_t   = std::array<std::uint32_t, 5>;
+    using chunk_t    = std::array<std::uint8_t, 64>;
+    using block_t    = std::array<std::uint8_t, 20>;
+    using compress_t = void (*)(digest_t&, const std::uint8_t*, std::size_t);
+
+    static constexpr std::size_t kChunkSize = 64;
 
     public:
     /// @brief Creates a new checksum from the given data.
@@ -47,7 +90,35 @@ struct Checksum {
     /// @param data The data to update the checksum with.
     static void
     update(Checksum& checksum, std::string_view data) noexcept {
-        for (const auto& byte : data) update(checksum, byte);
+        const auto* bytes   = reinterpret_cast<const std::uint8_t*>(data.data());
+        auto remaining      = data.size();
+        checksum.byteCount_ += remaining;
+
+        // Top up a partially filled chunk first.
+        if (checksum.blockOffset_ != 0) {
+            const auto count =
+                std::min(remaining, kChunkSize - checksum.blockOffset_);
+            std::memcpy(checksum.chunk_.data() + checksum.blockOffset_, bytes,
+                        count);
+            checksum.blockOffset_ += count;
+            bytes                 += count;
+            remaining             -= count;
+            if (checksum.blockOffset_ != kChunkSize) return;
+
+            processChunks(checksum, checksum.chunk_.data(), 1);
+            checksum.blockOffset_ = 0;
+        }
+
+        // Compress whole chunks straight from the input.
+        const auto chunks = remaining / kChunkSize;
+        if (chunks != 0) {
+            processChunks(checksum, bytes, chunks);
+            bytes     += chunks * kChunkSize;
+            remaining -= chunks * kChunkSize;
+        }
+
+        std::memcpy(checksum.chunk_.data(), bytes, remaining);
+        checksum.blockOffset_ = remaining;
     }
 
     /// @brief Finalizes the checksum and outputs the digest.
@@ -67,40 +138,66 @@ struct Checksum {
         }
     }
 
-    private:
-    static void
-    finalize(Checksum& checksum, digest_t& result) noexcept {
-        const auto& bitCount = checksum.byteCount_ * 8;
-        update(checksum, 0x80);
-        if (checksum.blockOffset_ > 56) {
-            while (checksum.blockOffset_ != 0) update(checksum, 0);
-            while (checksum.blockOffset_ < 56) update(checksum, 0);
-        } else {
-            while (checksum.blockOffset_ < 56) update(checksum, 0);
-        }
+    /// @brief  Gets the backends the current CPU can run.
+    /// @return The supported backends, the portable one always comes first.
+    static std::vector<ChecksumBackend>
+    supportedBackends() noexcept {
+        std::vector<ChecksumBackend> backends{ ChecksumBackend::ePortable };
+        if (cpuHasShaNi()) backends.push_back(ChecksumBackend::eShaNi);
+        if (cpuHasArmCrypto()) backends.push_back(ChecksumBackend::eArmCrypto);
+        return backends;
+    }
 
-        update(checksum, 0);
-        update(checksum, 0);
-        update(checksum, 0);
-        update(checksum, 0);
-        update(checksum, static_cast<std::uint8_t>((bitCount >> 24) & 0xFF));
-        update(checksum, static_cast<std::uint8_t>((bitCount >> 16) & 0xFF));
-        update(checksum, static_cast<std::uint8_t>((bitCount >> 8) & 0xFF));
-        update(checksum, static_cast<std::uint8_t>((bitCount >> 0) & 0xFF));
-        std::memcpy(result.data(), checksum.digest_.data(),
-                    5 * sizeof(std::uint32_t));
+    /// @brief  Gets the backend that is currently used for compression.
+    /// @return The active backend.
+    static ChecksumBackend
+    activeBackend() noexcept {
+        return activeBackend_;
     }
 
+    /// @brief   Switches the backend used for compression.
+    /// @details Meant for tests and benchmarks, this is not synchronized with
+    ///          checksums being computed on other threads.
+    /// @param   backend The backend to use.
+    /// @return  True if the backend is supported and now active.
+    static bool
+    selectBackend(ChecksumBackend backend) noexcept {
+        const auto backends = supportedBackends();
+        if (std::find(backends.begin(), backends.end(), backend) ==
+            backends.end())
+            return false;
+
+        activeBackend_ = backend;
+        compressor_    = compressorFor(backend);
+        return true;
+    }
+
+    private:
     static void
-    update(Checksum& checksum, std::uint8_t byte) noexcept {
-        constexpr std::uint32_t kChunkSize = 64;
+    finalize(Checksum& checksum, digest_t& result) noexcept {
+        constexpr std::size_t kLengthOffset = 56;
+
+        const auto bitCount = static_cast<std::uint64_t>(checksum.byteCount_) * 8;
+        auto& chunk         = checksum.chunk_;
+        auto offset         = checksum.blockOffset_;
+
+        // Pad with a single set bit, then zeros up to the length field.
+        chunk[offset++] = 0x80;
+        if (offset > kLengthOffset) {
+            std::memset(chunk.data() + offset, 0, kChunkSize - offset);
+            processChunks(checksum, chunk.data(), 1);
+            offset = 0;
+        }
 
-        checksum.byteCount_++;
-        checksum.chunk_[checksum.blockOffset_++] = byte;
-        if (checksum.blockOffset_ != kChunkSize) return;
+        std::memset(chunk.data() + offset, 0, kLengthOffset - offset);
+        for (auto index = 0u; index < 8; ++index)
+            chunk[kLengthOffset + index] =
+                static_cast<std::uint8_t>(bitCount >> (56 - index * 8));
 
+        processChunks(checksum, chunk.data(), 1);
         checksum.blockOffset_ = 0;
-        processChunk(checksum);
+        std::memcpy(result.data(), checksum.digest_.data(),
+                    5 * sizeof(std::uint32_t));
     }
 
     static std::uint32_t
@@ -108,69 +205,251 @@ struct Checksum {
         return (value << count) | (value >> (32 - count));
     }
 
+    static std::uint32_t
+    loadBigEndian(const std::uint8_t* bytes) noexcept {
+        return (static_cast<std::uint32_t>(bytes[0]) << 24) |
+               (static_cast<std::uint32_t>(bytes[1]) << 16) |
+               (static_cast<std::uint32_t>(bytes[2]) << 8) |
+               (static_cast<std::uint32_t>(bytes[3]) << 0);
+    }
+
     static void
-    processChunk(Checksum& checksum) noexcept {
+    compressPortable(digest_t& digest,
+                     const std::uint8_t* chunks,
+                     std::size_t count) noexcept {
         constexpr std::uint32_t kPrimeA = 0x5A827999;
         constexpr std::uint32_t kPrimeB = 0x6ED9EBA1;
         constexpr std::uint32_t kPrimeC = 0x8F1BBCDC;
         constexpr std::uint32_t kPrimeD = 0xCA62C1D6;
 
-        std::array<std::uint32_t, 80> w;
-        for (auto i = 0u; i < 16; ++i)
-            w[i] = (checksum.chunk_[i * 4 + 0] << 24) |
-                   (checksum.chunk_[i * 4 + 1] << 16) |
-                   (checksum.chunk_[i * 4 + 2] << 8) |
-                   (checksum.chunk_[i * 4 + 3] << 0);
-
-        for (auto i = 16u; i < 80; ++i)
-            w[i] = leftRotate(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
-
-        auto t = 0u;
-        auto f = 0u;
-        auto k = 0u;
-        auto a = checksum.digest_[0];
-        auto b = checksum.digest_[1];
-        auto c = checksum.digest_[2];
-        auto d = checksum.digest_[3];
-        auto e = checksum.digest_[4];
-        for (auto i = 0u; i < 80; ++i) {
-            if (i < 20) {
-                f = (b & c) | (~b & d);
-                k = kPrimeA;
-            } else if (i < 40) {
-                f = b ^ c ^ d;
-                k = kPrimeB;
-            } else if (i < 60) {
-                f = (b & c) | (b & d) | (c & d);
-                k = kPrimeC;
-            } else {
-                f = b ^ c ^ d;
-                k = kPrimeD;
+        for (; count != 0; --count, chunks += kChunkSize) {
+            // The message schedule only ever looks 16 words back.
+            std::array<std::uint32_t, 16> w;
+            for (auto i = 0u; i < 16; ++i) w[i] = loadBigEndian(chunks + i * 4);
+
+            auto a = digest[0];
+            auto b = digest[1];
+            auto c = digest[2];
+            auto d = digest[3];
+            auto e = digest[4];
+            const auto round = [&](std::uint32_t i, std::uint32_t f,
+                                   std::uint32_t k) {
+                if (i >= 16)
+                    w[i & 15] = leftRotate(w[(i - 3) & 15] ^ w[(i - 8) & 15] ^
+                                           w[(i - 14) & 15] ^ w[i & 15], 1);
+
+                const auto t = leftRotate(a, 5) + f + e + k + w[i & 15];
+                e = d;
+                d = c;
+                c = leftRotate(b, 30);
+                b = a;
+                a = t;
+            };
+
+            for (auto i = 0u; i < 20; ++i) round(i, (b & c) | (~b & d), kPrimeA);
+            for (auto i = 20u; i < 40; ++i) round(i, b ^ c ^ d, kPrimeB);
+            for (auto i = 40u; i < 60; ++i)
+                round(i, (b & c) | (b & d) | (c & d), kPrimeC);
+            for (auto i = 60u; i < 80; ++i) round(i, b ^ c ^ d, kPrimeD);
+
+            digest[0] += a;
+            digest[1] += b;
+            digest[2] += c;
+            digest[3] += d;
+            digest[4] += e;
+        }
+    }
+
+#if defined(CPAK_CHECKSUM_SHANI)
+    template<std::size_t Group>
+    __attribute__((target("sha,sse4.1"))) static void
+    shaNiGroup(__m128i& abcd,
+               __m128i (&e)[2],
+               __m128i (&message)[4]) noexcept {
+        // Each group runs four rounds while scheduling the words that later
+        // groups consume, the message registers rotate through the groups.
+        auto& current = message[Group % 4];
+        if constexpr (Group == 0) e[0] = _mm_add_epi32(e[0], current);
+        else
+            e[Group % 2] = _mm_sha1nexte_epu32(e[Group % 2], current);
+
+        e[(Group + 1) % 2] = abcd;
+        if constexpr (Group >= 3 && Group <= 18)
+            message[(Group + 1) % 4] =
+                _mm_sha1msg2_epu32(message[(Group + 1) % 4], current);
+
+        abcd = _mm_sha1rnds4_epu32(abcd, e[Group % 2], Group / 5);
+        if constexpr (Group >= 1 && Group <= 16)
+            message[(Group + 3) % 4] =
+                _mm_sha1msg1_epu32(message[(Group + 3) % 4], current);
+        if constexpr (Group >= 2 && Group <= 17)
+            message[(Group + 2) % 4] =
+                _mm_xor_si128(message[(Group + 2) % 4], current);
+    }
+
+    template<std::size_t... Groups>
+    __attribute__((target("sha,sse4.1"))) static void
+    shaNiRounds(__m128i& abcd,
+                __m128i (&e)[2],
+                __m128i (&message)[4],
+                std::index_sequence<Groups...>) noexcept {
+        (shaNiGroup<Groups>(abcd, e, message), ...);
+    }
+
+    __attribute__((target("sha,sse4.1"))) static void
+    compressShaNi(digest_t& digest,
+                  const std::uint8_t* chunks,
+                  std::size_t count) noexcept {
+        const auto byteSwap =
+            _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+
+        auto abcd = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&digest));
+        abcd      = _mm_shuffle_epi32(abcd, 0x1B);
+        auto e0   = _mm_set_epi32(static_cast<int>(digest[4]), 0, 0, 0);
+        for (; count != 0; --count, chunks += kChunkSize) {
+            const auto abcdSaved = abcd;
+            const auto eSaved    = e0;
+
+            __m128i message[4];
+            for (auto i = 0u; i < 4; ++i)
+                message[i] = _mm_shuffle_epi8(
+                    _mm_loadu_si128(
+                        reinterpret_cast<const __m128i*>(chunks + i * 16)),
+                    byteSwap);
+
+            __m128i e[2]{ e0, _mm_setzero_si128() };
+            shaNiRounds(abcd, e, message, std::make_index_sequence<20>());
+
+            // The last group leaves E in the odd register.
+            e0   = _mm_sha1nexte_epu32(e[0], eSaved);
+            abcd = _mm_add_epi32(abcd, abcdSaved);
+        }
+
+        abcd = _mm_shuffle_epi32(abcd, 0x1B);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&digest), abcd);
+        digest[4] = static_cast<std::uint32_t>(_mm_extract_epi32(e0, 3));
+    }
+#endif
+
+#if defined(CPAK_CHECKSUM_ARMCRYPTO)
+    CPAK_CHECKSUM_ARMCRYPTO_TARGET static void
+    compressArmCrypto(digest_t& digest,
+                      const std::uint8_t* chunks,
+                      std::size_t count) noexcept {
+        const std::array<std::uint32_t, 4> constants{ 0x5A827999, 0x6ED9EBA1,
+                                                      0x8F1BBCDC, 0xCA62C1D6 };
+
+        auto abcd = vld1q_u32(digest.data());
+        auto e    = digest[4];
+        for (; count != 0; --count, chunks += kChunkSize) {
+            const auto abcdSaved = abcd;
+            const auto eSaved    = e;
+
+            // Expand the whole schedule up front, four words per vector.
+            std::array<uint32x4_t, 20> w;
+            for (auto i = 0u; i < 4; ++i)
+                w[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(chunks + i * 16)));
+            for (auto i = 4u; i < 20; ++i)
+                w[i] = vsha1su1q_u32(vsha1su0q_u32(w[i - 4], w[i - 3], w[i - 2]),
+                                     w[i - 1]);
+
+            for (auto i = 0u; i < 20; ++i) {
+                const auto wk   = vaddq_u32(w[i], vdupq_n_u32(constants[i / 5]));
+                const auto next = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+                if (i < 5) abcd = vsha1cq_u32(abcd, e, wk);
+                else if (i >= 10 && i < 15) abcd = vsha1mq_u32(abcd, e, wk);
+                else abcd = vsha1pq_u32(abcd, e, wk);
+                e = next;
             }
 
-            t = leftRotate(a, 5) + f + e + k + w[i];
-            e = d;
-            d = c;
-            c = leftRotate(b, 30);
-            b = a;
-            a = t;
+            abcd = vaddq_u32(abcd, abcdSaved);
+            e   += eSaved;
+        }
+
+        vst1q_u32(digest.data(), abcd);
+        digest[4] = e;
+    }
+#endif
+
+    static bool
+    cpuHasShaNi() noexcept {
+#if defined(CPAK_CHECKSUM_SHANI)
+        constexpr unsigned kSse41Bit = 1u << 19;
+        constexpr unsigned kSsse3Bit = 1u << 9;
+        constexpr unsigned kShaBit   = 1u << 29;
+
+        unsigned eax, ebx, ecx, edx;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return false;
+        if ((ecx & kSse41Bit) == 0 || (ecx & kSsse3Bit) == 0) return false;
+        if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) return false;
+        return (ebx & kShaBit) != 0;
+#else
+        return false;
+#endif
+    }
+
+    static bool
+    cpuHasArmCrypto() noexcept {
+#if defined(CPAK_CHECKSUM_ARMCRYPTO) && defined(__linux__)
+        return (getauxval(AT_HWCAP) & HWCAP_SHA1) != 0;
+#elif defined(CPAK_CHECKSUM_ARMCRYPTO) && defined(__APPLE__)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    static compress_t
+    compressorFor(ChecksumBackend backend) noexcept {
+        switch (backend) {
+#if defined(CPAK_CHECKSUM_SHANI)
+        case ChecksumBackend::eShaNi: return &compressShaNi;
+#endif
+#if defined(CPAK_CHECKSUM_ARMCRYPTO)
+        case ChecksumBackend::eArmCrypto: return &compressArmCrypto;
+#endif
+        default: return &compressPortable;
         }
+    }
 
-        checksum.digest_[0] += a;
-        checksum.digest_[1] += b;
-        checksum.digest_[2] += c;
-        checksum.digest_[3] += d;
-        checksum.digest_[4] += e;
+    static ChecksumBackend
+    detectBackend() noexcept {
+        return supportedBackends().back();
+    }
+
+    static void
+    processChunks(Checksum& checksum,
+                  const std::uint8_t* chunks,
+                  std::size_t count) noexcept {
+        compressor_(checksum.digest_, chunks, count);
     }
 
     private:
+    inline static ChecksumBackend activeBackend_ = detectBackend();
+    inline static compress_t compressor_ = compressorFor(activeBackend_);
+
     chunk_t chunk_;
     digest_t digest_;
     std::size_t blockOffset_;
-    std::size_t byteCount_;
+    std::uint64_t byteCount_;
 };
 
 
+/// @brief  Converts a finalized digest into its hexadecimal representation.
+/// @param  block The digest to convert.
+/// @return The digest as a lowercase hexadecimal string.
+template<std::size_t Size>
+std::string
+digestToString(const std::array<std::uint8_t, Size>& block) noexcept {
+    std::ostringstream oss;
+    for (const auto& byte : block)
+        oss << std::hex << std::setfill('0') << std::setw(2)
+            << static_cast<int>(byte);
+
+    return oss.str();
+}
+
+
 /// @brief  Generates a checksum for the given CPakFile.
 /// @param  cpakfile The CPakFile to generate the checksum for.
 /// @return The generated checksum.
@@ -185,14 +464,7 @@ checksum(const CPakFile& cpakfile) noexcept {
 
     Checksum checksum(oss.str());
     Checksum::finalize(checksum, block);
-
-    oss.str("");
-    oss.clear();
-    for (const auto& byte : block)
-        oss << std::hex << std::setfill('0') << std::setw(2)
-            << static_cast<int>(byte);
-
-    return oss.str();
+    return digestToString(block);
 }
 
 
@@ -0,0 +1,327 @@
+#pragma once
+#include "../common.hpp"
+
+namespace cpak::utilities {
+
+
+/// @brief   A fast LZ77 codec for cache entries.
+/// @details The format is a sequence of independently compressed blocks in
+///          the spirit of LZ4: each sequence is a token holding the literal
+///          and match lengths, the literals, and a 16-bit back reference.
+///          Blocks are decoded one at a time so a restore never holds more
+///          than a single block in memory. The level controls how many
+///          earlier positions are searched for a match, level 1 only checks
+///          the most recent one.
+struct Compression {
+    static constexpr std::uint32_t kMaxLevel   = 9;
+    static constexpr std::size_t kBlockSize    = 1 << 18;
+    static constexpr std::size_t kWindowSize   = 1 << 16;
+    static constexpr std::size_t kMinMatch     = 4;
+    static constexpr std::uint32_t kStoredFlag = 0x80000000;
+    static constexpr std::string_view kMagic   = "CPKZ\x01";
+
+    using buffer_t = std::vector<std::uint8_t>;
+
+    public:
+    /// @brief  Compresses a block into the output buffer.
+    /// @param  source The start of the block.
+    /// @param  size The size of the block, at most \c kBlockSize.
+    /// @param  level The compression level, from 1 to \c kMaxLevel.
+    /// @param  output Where to append the compressed sequences.
+    static void
+    compressBlock(const std::uint8_t* source,
+                  std::size_t size,
+                  std::uint32_t level,
+                  buffer_t& output) noexcept {
+        constexpr std::uint32_t kHashBits = 16;
+
+        level = std::clamp(level, 1u, kMaxLevel);
+        std::vector<std::int32_t> table(1 << kHashBits, -1);
+        std::vector<std::int32_t> chain(level > 1 ? size : 0, -1);
+        const auto attempts = 1u << (level - 1);
+
+        std::size_t position = 0;
+        std::size_t anchor   = 0;
+        std::size_t misses   = 0;
+        while (position + kMinMatch <= size) {
+            const auto hash = hashOf(source + position, kHashBits);
+
+            std::size_t bestLength = 0;
+            std::size_t bestOffset = 0;
+            auto candidate         = table[hash];
+            for (auto tries = attempts; candidate >= 0 && tries > 0; --tries) {
+                const auto offset = position - candidate;
+                if (offset >= kWindowSize) break;
+
+                const auto length =
+                    matchLength(source + candidate, source + position,
+                                source + size);
+                if (length > bestLength) {
+                    bestLength = length;
+                    bestOffset = offset;
+                }
+
+                if (chain.empty()) break;
+                candidate = chain[candidate];
+            }
+
+            if (!chain.empty()) chain[position] = table[hash];
+            table[hash] = static_cast<std::int32_t>(position);
+
+            // Skip ahead faster through data that does not compress.
+            if (bestLength < kMinMatch) {
+                position += 1 + (level == 1 ? (misses++ >> 5) : 0);
+                continue;
+            }
+
+            writeSequence(source + anchor, position - anchor, bestOffset,
+                          bestLength, output);
+            position += bestLength;
+            anchor = position;
+            misses = 0;
+        }
+
+        // The final sequence only carries literals.
+        writeSequence(source + anchor, size - anchor, 0, 0, output);
+    }
+
+    /// @brief  Decompresses a block into the destination.
+    /// @param  source The start of the compressed block.
+    /// @param  size The size of the compressed block.
+    /// @param  destination Where to write the decompressed data.
+    /// @param  rawSize The expected size of the decompressed data.
+    /// @return True if the block was well formed, otherwise false.
+    static bool
+    decompressBlock(const std::uint8_t* source,
+                    std::size_t size,
+                    std::uint8_t* destination,
+                    std::size_t rawSize) noexcept {
+        const auto* input     = source;
+        const auto* inputEnd  = source + size;
+        auto* output          = destination;
+        const auto* outputEnd = destination + rawSize;
+        while (input < inputEnd) {
+            const auto token   = *input++;
+            auto literalLength = static_cast<std::size_t>(token >> 4);
+            if (!readLength(input, inputEnd, literalLength)) return false;
+            if (literalLength > static_cast<std::size_t>(inputEnd - input) ||
+                literalLength > static_cast<std::size_t>(outputEnd - output))
+                return false;
+
+            std::memcpy(output, input, literalLength);
+            input  += literalLength;
+            output += literalLength;
+            if (input == inputEnd) break;
+
+            if (inputEnd - input < 2) return false;
+            const auto offset = static_cast<std::size_t>(input[0]) |
+                                static_cast<std::size_t>(input[1]) << 8;
+            input += 2;
+
+            auto matchLength = static_cast<std::size_t>(token & 0x0F);
+            if (!readLength(input, inputEnd, matchLength)) return false;
+            matchLength += kMinMatch;
+
+            if (offset == 0 ||
+                offset > static_cast<std::size_t>(output - destination) ||
+                matchLength > static_cast<std::size_t>(outputEnd - output))
+                return false;
+
+            // Overlapping matches repeat the data, so copy byte by byte.
+            const auto* match = output - offset;
+            if (offset >= matchLength) std::memcpy(output, match, matchLength);
+            else
+                for (auto index = 0u; index < matchLength; ++index)
+                    output[index] = match[index];
+            output += matchLength;
+        }
+
+        return output == outputEnd;
+    }
+
+    /// @brief  Compresses the input stream into the output stream.
+    /// @param  input The stream to compress.
+    /// @param  output The stream to write the frame to.
+    /// @param  level The compression level, from 1 to \c kMaxLevel.
+    /// @return True if the frame was written, otherwise false.
+    static bool
+    compress(std::istream& input,
+             std::ostream& output,
+             std::uint32_t level) noexcept {
+        buffer_t raw(kBlockSize);
+        buffer_t compressed;
+        compressed.reserve(kBlockSize + kBlockSize / 255 + 16);
+
+        output.write(kMagic.data(), kMagic.size());
+        while (input) {
+            input.read(reinterpret_cast<char*>(raw.data()), raw.size());
+            const auto rawSize = static_cast<std::size_t>(input.gcount());
+            if (rawSize == 0) break;
+
+            compressed.clear();
+            compressBlock(raw.data(), rawSize, level, compressed);
+
+            // Keep incompressible blocks as they are.
+            if (compressed.size() >= rawSize) {
+                writeHeader(output, rawSize | kStoredFlag, rawSize);
+                output.write(reinterpret_cast<const char*>(raw.data()),
+                             rawSize);
+            } else {
+                writeHeader(output, compressed.size(), rawSize);
+                output.write(reinterpret_cast<const char*>(compressed.data()),
+                             compressed.size());
+            }
+        }
+
+        writeHeader(output, 0, 0);
+        return static_cast<bool>(output);
+    }
+
+    /// @brief  Decompresses a frame from the input stream into the output.
+    /// @param  input The stream holding the frame.
+    /// @param  output The stream to write the decompressed data to.
+    /// @return True if the frame was well formed, otherwise false.
+    static bool
+    decompress(std::istream& input, std::ostream& output) noexcept {
+        std::array<char, kMagic.size()> magic;
+        input.read(magic.data(), magic.size());
+        if (!input || std::string_view(magic.data(), magic.size()) != kMagic)
+            return false;
+
+        buffer_t compressed;
+        buffer_t raw;
+        while (true) {
+            std::uint32_t storedSize, rawSize;
+            if (!readHeader(input, storedSize, rawSize)) return false;
+            if (storedSize == 0) break;
+
+            const auto isStored = (storedSize & kStoredFlag) != 0;
+            storedSize &= ~kStoredFlag;
+            if (rawSize > kBlockSize || storedSize > 2 * kBlockSize)
+                return false;
+
+            compressed.resize(storedSize);
+            input.read(reinterpret_cast<char*>(compressed.data()), storedSize);
+            if (static_cast<std::size_t>(input.gcount()) != storedSize)
+                return false;
+
+            if (isStored) {
+                if (storedSize != rawSize) return false;
+                output.write(reinterpret_cast<const char*>(compressed.data()),
+                             storedSize);
+                continue;
+            }
+
+            raw.resize(rawSize);
+            if (!decompressBlock(compressed.data(), storedSize, raw.data(),
+                                 rawSize))
+                return false;
+            output.write(reinterpret_cast<const char*>(raw.data()), rawSize);
+        }
+
+        return static_cast<bool>(output);
+    }
+
+    private:
+    static std::uint32_t
+    hashOf(const std::uint8_t* data, std::uint32_t bits) noexcept {
+        constexpr std::uint32_t kPrime = 2654435761u;
+
+        std::uint32_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return (value * kPrime) >> (32 - bits);
+    }
+
+    static std::size_t
+    matchLength(const std::uint8_t* match,
+                const std::uint8_t* current,
+                const std::uint8_t* end) noexcept {
+        const auto* start = current;
+        while (current < end && *match == *current) {
+            ++match;
+            ++current;
+        }
+
+        return current - start;
+    }
+
+    static void
+    writeLength(std::size_t length, buffer_t& output) noexcept {
+        for (; length >= 255; length -= 255) output.push_back(255);
+        output.push_back(static_cast<std::uint8_t>(length));
+    }
+
+    static bool
+    readLength(const std::uint8_t*& input,
+               const std::uint8_t* end,
+               std::size_t& length) noexcept {
+        if (length != 15) return true;
+
+        std::uint8_t next;
+        do {
+            if (input == end) return false;
+            next    = *input++;
+            length += next;
+        } while (next == 255);
+        return true;
+    }
+
+    static void
+    writeSequence(const std::uint8_t* literals,
+                  std::size_t literalLength,
+                  std::size_t offset,
+                  std::size_t matchLength,
+                  buffer_t& output) noexcept {
+        const auto matchCode =
+            matchLength != 0 ? matchLength - kMinMatch : 0;
+        const auto token =
+            static_cast<std::uint8_t>(std::min<std::size_t>(literalLength, 15)
+                                          << 4 |
+                                      std::min<std::size_t>(matchCode, 15));
+
+        output.push_back(token);
+        if (literalLength >= 15) writeLength(literalLength - 15, output);
+        output.insert(output.end(), literals, literals + literalLength);
+        if (matchLength == 0) return;
+
+        output.push_back(static_cast<std::uint8_t>(offset & 0xFF));
+        output.push_back(static_cast<std::uint8_t>(offset >> 8));
+        if (matchCode >= 15) writeLength(matchCode - 15, output);
+    }
+
+    static void
+    writeHeader(std::ostream& output,
+                std::uint32_t storedSize,
+                std::uint32_t rawSize) noexcept {
+        std::array<char, 8> header;
+        for (auto index = 0u; index < 4; ++index) {
+            header[index]     = static_cast<char>(storedSize >> (index * 8));
+            header[index + 4] = static_cast<char>(rawSize >> (index * 8));
+        }
+
+        output.write(header.data(), header.size());
+    }
+
+    static bool
+    readHeader(std::istream& input,
+               std::uint32_t& storedSize,
+               std::uint32_t& rawSize) noexcept {
+        std::array<std::uint8_t, 8> header;
+        input.read(reinterpret_cast<char*>(header.data()), header.size());
+        if (input.gcount() != static_cast<std::streamsize>(header.size()))
+            return false;
+
+        storedSize = rawSize = 0;
+        for (auto index = 0u; index < 4; ++index) {
+            storedSize |= static_cast<std::uint32_t>(header[index])
+                       << (index * 8);
+            rawSize |= static_cast<std::uint32_t>(header[index + 4])
+                    << (index * 8);
+        }
+
+        return true;
+    }
+};
+
+
+} // namespace cpak::utilities
@@ -0,0 +1,262 @@
+#pragma once
+#include "hasher.hpp"
+#include "threadpool.hpp"
+
+namespace cpak::utilities {
+
+
+/// @brief The size of the chunks a file is split into for tree hashing.
+constexpr std::size_t kTreeChunkSize = 1 << 22;
+
+
+/// @brief   Hashes a single chunk of a file.
+/// @details Every chunk is read on its own, so any number of chunks from any
+///          number of files can be hashed concurrently.
+/// @tparam  HasherType The hash function to use.
+/// @param   path The file to read from.
+/// @param   offset Where the chunk starts.
+/// @param   length The size of the chunk.
+/// @return  The digest and the status code for the operation.
+template<Hasher HasherType>
+std::tuple<typename HasherType::block_t, std::error_code>
+hashFileChunk(const std::filesystem::path& path,
+              std::uint64_t offset,
+              std::size_t length) noexcept {
+    constexpr std::size_t kReadSize = 1 << 20;
+
+    thread_local std::vector<char> buffer(kReadSize);
+    HasherType hasher("");
+    typename HasherType::block_t block{};
+#if defined(__unix__) || defined(__APPLE__)
+    const auto descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (descriptor < 0)
+        return std::make_tuple(block, make_error_code(errc::pathDoesNotExist));
+
+    while (length != 0) {
+        const auto count = ::pread(descriptor, buffer.data(),
+                                   std::min(length, kReadSize),
+                                   static_cast<off_t>(offset));
+        if (count <= 0) {
+            ::close(descriptor);
+            return std::make_tuple(block, make_error_code(errc::failure));
+        }
+
+        HasherType::update(hasher, { buffer.data(),
+                                     static_cast<std::size_t>(count) });
+        offset += count;
+        length -= count;
+    }
+
+    ::close(descriptor);
+#else
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream.is_open())
+        return std::make_tuple(block, make_error_code(errc::pathDoesNotExist));
+
+    stream.seekg(offset);
+    while (length != 0) {
+        stream.read(buffer.data(), std::min(length, kReadSize));
+        const auto count = static_cast<std::size_t>(stream.gcount());
+        if (count == 0)
+            return std::make_tuple(block, make_error_code(errc::failure));
+
+        HasherType::update(hasher, { buffer.data(), count });
+        length -= count;
+    }
+#endif
+
+    HasherType::finalize(hasher, block);
+    return std::make_tuple(block, make_error_code(errc::success));
+}
+
+
+/// @brief  Combines the chunk digests of a file into its tree digest.
+/// @tparam HasherType The hash function to use.
+/// @param  size The size of the file.
+/// @param  first The digest of the first chunk.
+/// @param  last One past the digest of the last chunk.
+/// @return The tree digest of the file.
+template<Hasher HasherType, typename Iterator>
+typename HasherType::block_t
+combineChunkDigests(std::uint64_t size, Iterator first, Iterator last) noexcept {
+    std::array<char, 8> length;
+    for (auto index = 0u; index < length.size(); ++index)
+        length[index] = static_cast<char>(size >> (index * 8));
+
+    HasherType hasher({ length.data(), length.size() });
+    for (; first != last; ++first)
+        HasherType::update(hasher,
+                           { reinterpret_cast<const char*>(first->data()),
+                             first->size() });
+
+    typename HasherType::block_t block;
+    HasherType::finalize(hasher, block);
+    return block;
+}
+
+
+/// @brief   Generates a tree digest for the contents of a file.
+/// @details The file is split into \c kTreeChunkSize chunks which are hashed
+///          in parallel on the pool, the digest covers the size of the file
+///          and the digests of its chunks. This is a different digest than
+///          the one \c hashFile produces for the same contents.
+/// @tparam  HasherType The hash function to use, \c Hash128 by default.
+/// @param   path The file to generate the digest for.
+/// @param   pool The pool to hash the chunks on.
+/// @return  The digest and the status code for the operation.
+template<Hasher HasherType = Hash128>
+std::tuple<typename HasherType::block_t, std::error_code>
+hashFileTree(const std::filesystem::path& path,
+             ThreadPool& pool = ThreadPool::shared()) noexcept {
+    typename HasherType::block_t block{};
+
+    std::error_code error;
+    const auto size = std::filesystem::file_size(path, error);
+    if (error)
+        return std::make_tuple(block, make_error_code(errc::pathDoesNotExist));
+
+    const auto chunks = std::max<std::size_t>(
+        (size + kTreeChunkSize - 1) / kTreeChunkSize, 1);
+    std::vector<typename HasherType::block_t> digests(chunks);
+    std::vector<std::error_code> results(chunks);
+    pool.forEach(chunks, [&](std::size_t index) {
+        const auto offset = index * kTreeChunkSize;
+        const auto length = std::min<std::uint64_t>(size - offset, kTreeChunkSize);
+        std::tie(digests[index], results[index]) =
+            hashFileChunk<HasherType>(path, offset, length);
+    });
+
+    for (const auto& result : results)
+        if (result.value() != errc::success)
+            return std::make_tuple(block, result);
+
+    block = combineChunkDigests<HasherType>(size, digests.begin(), digests.end());
+    return std::make_tuple(block, make_error_code(errc::success));
+}
+
+
+/// @brief   Generates a fingerprint for the contents of a directory.
+/// @details Every regular file and symbolic link below the directory is
+///          covered by its relative path, whether it is executable, and its
+///          tree digest or link target. The chunks of all files are hashed in
+///          parallel on the pool. Git metadata and cpak build directories are
+///          skipped, so a dependency checkout under \c ~/.cpak keeps its
+///          fingerprint after it was built.
+/// @tparam  HasherType The hash function to use, \c Hash128 by default.
+/// @param   root The directory to fingerprint.
+/// @param   pool The pool to hash the chunks on.
+/// @return  The fingerprint and the status code for the operation.
+template<Hasher HasherType = Hash128>
+std::tuple<typename HasherType::block_t, std::error_code>
+fingerprintDirectory(const std::filesystem::path& root,
+                     ThreadPool& pool = ThreadPool::shared()) noexcept {
+    namespace fs = std::filesystem;
+
+    struct Entry {
+        std::string relativePath;
+        fs::path path;
+        fs::file_status status;
+        std::uint64_t size;
+        std::size_t firstChunk;
+    };
+
+    typename HasherType::block_t block{};
+    if (!fs::is_directory(root))
+        return std::make_tuple(block, make_error_code(errc::pathDoesNotExist));
+
+    std::error_code error;
+    std::vector<Entry> entries;
+    fs::recursive_directory_iterator iterator(root, error), end;
+    for (; !error && iterator != end; iterator.increment(error)) {
+        const auto status = iterator->symlink_status(error);
+        if (error) break;
+
+        const auto name = iterator->path().filename();
+        if (fs::is_directory(status) && (name == ".git" || name == ".cpak")) {
+            iterator.disable_recursion_pending();
+            continue;
+        }
+
+        if (!fs::is_regular_file(status) && !fs::is_symlink(status)) continue;
+        const auto size =
+            fs::is_regular_file(status) ? iterator->file_size(error) : 0;
+        if (error) break;
+
+        const auto relativePath = fs::relative(iterator->path(), root, error);
+        if (error) break;
+
+        entries.push_back({ relativePath.generic_string(), iterator->path(),
+                            status, size, 0 });
+    }
+
+    if (error) return std::make_tuple(block, make_error_code(errc::failure));
+    std::sort(entries.begin(), entries.end(),
+              [](const auto& left, const auto& right) {
+                  return left.relativePath < right.relativePath;
+              });
+
+    // Lay the chunks of every file out in one list so small files and large
+    // ones are spread over the pool alike.
+    std::vector<std::pair<std::size_t, std::size_t>> chunks;
+    for (auto index = 0u; index < entries.size(); ++index) {
+        auto& entry      = entries[index];
+        entry.firstChunk = chunks.size();
+        if (!fs::is_regular_file(entry.status)) continue;
+
+        const auto count = std::max<std::size_t>(
+            (entry.size + kTreeChunkSize - 1) / kTreeChunkSize, 1);
+        for (auto chunk = 0u; chunk < count; ++chunk)
+            chunks.emplace_back(index, chunk);
+    }
+
+    std::vector<typename HasherType::block_t> digests(chunks.size());
+    std::vector<std::error_code> results(chunks.size());
+    pool.forEach(chunks.size(), [&](std::size_t index) {
+        const auto& [entryIndex, chunk] = chunks[index];
+        const auto& entry = entries[entryIndex];
+        const auto offset = static_cast<std::uint64_t>(chunk) * kTreeChunkSize;
+        const auto length =
+            std::min<std::uint64_t>(entry.size - offset, kTreeChunkSize);
+        std::tie(digests[index], results[index]) =
+            hashFileChunk<HasherType>(entry.path, offset, length);
+    });
+
+    for (const auto& result : results)
+        if (result.value() != errc::success)
+            return std::make_tuple(block, result);
+
+    HasherType hasher("");
+    for (auto index = 0u; index < entries.size(); ++index) {
+        const auto& entry = entries[index];
+        HasherType::update(hasher, entry.relativePath);
+        HasherType::update(hasher, std::string_view("\0", 1));
+
+        if (fs::is_symlink(entry.status)) {
+            const auto target = fs::read_symlink(entry.path, error);
+            if (error) return std::make_tuple(block, make_error_code(errc::failure));
+
+            HasherType::update(hasher, "l");
+            HasherType::update(hasher, target.string());
+            continue;
+        }
+
+        const auto executable =
+            (entry.status.permissions() & fs::perms::owner_exec) != fs::perms::none;
+        HasherType::update(hasher, executable ? "x" : "f");
+
+        const auto lastChunk = index + 1 < entries.size()
+            ? entries[index + 1].firstChunk
+            : digests.size();
+        const auto digest = combineChunkDigests<HasherType>(
+            entry.size, digests.begin() + entry.firstChunk,
+            digests.begin() + lastChunk);
+        HasherType::update(hasher, { reinterpret_cast<const char*>(digest.data()),
+                                     digest.size() });
+    }
+
+    HasherType::finalize(hasher, block);
+    return std::make_tuple(block, make_error_code(errc::success));
+}
+
+
+} // namespace cpak::utilities
\ No newline at end of file
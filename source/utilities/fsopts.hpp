@@ -0,0 +1,88 @@
+#pragma once
+#include "../common.hpp"
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+namespace cpak::utilities {
+
+
+/// @brief   Describes how a file was placed by \c cloneFile.
+/// @details The cache prefers the cheapest option that leaves the destination
+///          independent of the source, falling back when the filesystem does
+///          not support it.
+enum struct CloneMethod {
+    eNone,
+    eReflink,
+    eHardlink,
+    eCopy,
+};
+
+
+/// @brief  Attempts to create a copy-on-write clone of the source file.
+/// @param  from The file to clone.
+/// @param  to The path of the clone, must not exist.
+/// @return True if the filesystem cloned the file, otherwise false.
+inline bool
+reflinkFile(const std::filesystem::path& from,
+            const std::filesystem::path& to) noexcept {
+#if defined(__linux__) && defined(FICLONE)
+    const auto source = ::open(from.c_str(), O_RDONLY | O_CLOEXEC);
+    if (source < 0) return false;
+
+    const auto target =
+        ::open(to.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (target < 0) {
+        ::close(source);
+        return false;
+    }
+
+    const auto cloned = ::ioctl(target, FICLONE, source) == 0;
+    ::close(source);
+    ::close(target);
+
+    std::error_code error;
+    if (!cloned) {
+        std::filesystem::remove(to, error);
+        return false;
+    }
+
+    const auto permissions = std::filesystem::status(from, error).permissions();
+    std::filesystem::permissions(to, permissions, error);
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+/// @brief  Places a file at the destination as cheaply as possible.
+/// @param  from The file to place.
+/// @param  to The destination path, replaced if it already exists.
+/// @param  allowHardlink Whether the destination may share the source inode.
+/// @return The method that was used, or \c eNone if nothing worked.
+inline CloneMethod
+cloneFile(const std::filesystem::path& from,
+          const std::filesystem::path& to,
+          bool allowHardlink = true) noexcept {
+    std::error_code error;
+    std::filesystem::remove(to, error);
+    if (reflinkFile(from, to))
+        return CloneMethod::eReflink;
+
+    if (allowHardlink) {
+        std::filesystem::create_hard_link(from, to, error);
+        if (!error) return CloneMethod::eHardlink;
+    }
+
+    std::filesystem::copy_file(from, to, error);
+    if (!error) return CloneMethod::eCopy;
+    return CloneMethod::eNone;
+}
+
+
+} // namespace cpak::utilities
@@ -0,0 +1,493 @@
+#pragma once
+#include <bit>
+#include <concepts>
+#include "checksum.hpp"
+
+namespace cpak::utilities {
+
+
+/// @brief   Describes a streaming hash function usable by cpak.
+/// @details A hasher is constructed from its first piece of input, updated
+///          with any number of further pieces and finalized into a fixed size
+///          byte array. \c Checksum is the SHA-1 hasher and keeps the names of
+///          existing build directories stable, \c Hash128 is the fast choice
+///          for change detection and cache keys that never leave the machine,
+///          \c Blake3 is the choice for anything that must resist collisions.
+template<typename Type>
+concept Hasher = std::constructible_from<Type, std::string_view> &&
+    requires(Type& hasher,
+             std::string_view data,
+             typename Type::block_t& block) {
+        { std::tuple_size<typename Type::block_t>::value };
+        { Type::update(hasher, data) };
+        { Type::finalize(hasher, block) };
+    };
+
+
+/// @brief   Structure for calculating a 128-bit non-cryptographic hash.
+/// @details Implements MurmurHash3 x64_128 with a seed of zero. Input is mixed
+///          16 bytes at a time, only a trailing partial block is buffered
+///          between updates.
+struct Hash128 {
+    using block_t = std::array<std::uint8_t, 16>;
+
+    static constexpr std::size_t kBlockSize = 16;
+
+    public:
+    /// @brief Creates a new hash from the given data.
+    /// @param data The data to create the hash from.
+    explicit Hash128(std::string_view data) {
+        update(*this, data);
+    }
+
+    /// @brief Updates the hash with the given data.
+    /// @param hash The hash to update.
+    /// @param data The data to update the hash with.
+    static void
+    update(Hash128& hash, std::string_view data) noexcept {
+        const auto* bytes = reinterpret_cast<const std::uint8_t*>(data.data());
+        auto remaining    = data.size();
+        hash.byteCount_  += remaining;
+
+        if (hash.tailSize_ != 0) {
+            const auto count = std::min(remaining, kBlockSize - hash.tailSize_);
+            std::memcpy(hash.tail_.data() + hash.tailSize_, bytes, count);
+            hash.tailSize_ += count;
+            bytes          += count;
+            remaining      -= count;
+            if (hash.tailSize_ != kBlockSize) return;
+
+            mixBlock(hash, hash.tail_.data());
+            hash.tailSize_ = 0;
+        }
+
+        for (; remaining >= kBlockSize; remaining -= kBlockSize) {
+            mixBlock(hash, bytes);
+            bytes += kBlockSize;
+        }
+
+        std::memcpy(hash.tail_.data(), bytes, remaining);
+        hash.tailSize_ = remaining;
+    }
+
+    /// @brief Finalizes the hash and outputs the digest.
+    /// @param hash The hash to finalize.
+    /// @param result Where to store the digest.
+    static void
+    finalize(Hash128& hash, block_t& result) noexcept {
+        std::uint64_t k1 = 0;
+        std::uint64_t k2 = 0;
+        for (auto index = hash.tailSize_; index > 8; --index)
+            k2 = k2 << 8 | hash.tail_[index - 1];
+        for (auto index = std::min<std::size_t>(hash.tailSize_, 8); index > 0;
+             --index)
+            k1 = k1 << 8 | hash.tail_[index - 1];
+
+        auto h1 = hash.h1_;
+        auto h2 = hash.h2_;
+        if (hash.tailSize_ > 8) h2 ^= mixK2(k2);
+        if (hash.tailSize_ > 0) h1 ^= mixK1(k1);
+
+        h1 ^= hash.byteCount_;
+        h2 ^= hash.byteCount_;
+        h1 += h2;
+        h2 += h1;
+        h1  = finalMix(h1);
+        h2  = finalMix(h2);
+        h1 += h2;
+        h2 += h1;
+
+        for (auto index = 0u; index < 8; ++index) {
+            result[index]     = static_cast<std::uint8_t>(h1 >> (index * 8));
+            result[index + 8] = static_cast<std::uint8_t>(h2 >> (index * 8));
+        }
+    }
+
+    private:
+    static constexpr std::uint64_t kMultiplier1 = 0x87c37b91114253d5ULL;
+    static constexpr std::uint64_t kMultiplier2 = 0x4cf5ad432745937fULL;
+
+    static std::uint64_t
+    mixK1(std::uint64_t k1) noexcept {
+        return std::rotl(k1 * kMultiplier1, 31) * kMultiplier2;
+    }
+
+    static std::uint64_t
+    mixK2(std::uint64_t k2) noexcept {
+        return std::rotl(k2 * kMultiplier2, 33) * kMultiplier1;
+    }
+
+    static std::uint64_t
+    finalMix(std::uint64_t value) noexcept {
+        value ^= value >> 33;
+        value *= 0xff51afd7ed558ccdULL;
+        value ^= value >> 33;
+        value *= 0xc4ceb9fe1a85ec53ULL;
+        value ^= value >> 33;
+        return value;
+    }
+
+    static void
+    mixBlock(Hash128& hash, const std::uint8_t* block) noexcept {
+        std::uint64_t k1, k2;
+        std::memcpy(&k1, block, sizeof(k1));
+        std::memcpy(&k2, block + 8, sizeof(k2));
+        if constexpr (std::endian::native == std::endian::big) {
+            k1 = byteSwap(k1);
+            k2 = byteSwap(k2);
+        }
+
+        hash.h1_ ^= mixK1(k1);
+        hash.h1_  = std::rotl(hash.h1_, 27) + hash.h2_;
+        hash.h1_  = hash.h1_ * 5 + 0x52dce729;
+        hash.h2_ ^= mixK2(k2);
+        hash.h2_  = std::rotl(hash.h2_, 31) + hash.h1_;
+        hash.h2_  = hash.h2_ * 5 + 0x38495ab5;
+    }
+
+    static std::uint64_t
+    byteSwap(std::uint64_t value) noexcept {
+        std::uint64_t result = 0;
+        for (auto index = 0u; index < 8; ++index, value >>= 8)
+            result = result << 8 | (value & 0xFF);
+        return result;
+    }
+
+    private:
+    std::array<std::uint8_t, kBlockSize> tail_{};
+    std::size_t tailSize_{ 0 };
+    std::uint64_t byteCount_{ 0 };
+    std::uint64_t h1_{ 0 };
+    std::uint64_t h2_{ 0 };
+};
+
+
+/// @brief   Structure for calculating a BLAKE3 hash.
+/// @details A portable implementation of the default hash mode with a 32 byte
+///          output. Input is split into 1 KiB chunks whose chaining values are
+///          merged into a binary tree as soon as both children are known, so
+///          memory use stays constant regardless of the input size.
+struct Blake3 {
+    using block_t = std::array<std::uint8_t, 32>;
+    using words_t = std::array<std::uint32_t, 8>;
+
+    static constexpr std::size_t kBlockSize = 64;
+    static constexpr std::size_t kChunkSize = 1024;
+
+    public:
+    /// @brief Creates a new hash from the given data.
+    /// @param data The data to create the hash from.
+    explicit Blake3(std::string_view data) {
+        resetChunk(*this, 0);
+        update(*this, data);
+    }
+
+    /// @brief Updates the hash with the given data.
+    /// @param hash The hash to update.
+    /// @param data The data to update the hash with.
+    static void
+    update(Blake3& hash, std::string_view data) noexcept {
+        const auto* bytes = reinterpret_cast<const std::uint8_t*>(data.data());
+        auto remaining    = data.size();
+        while (remaining != 0) {
+            // Only close a chunk once more input shows it is not the last.
+            if (hash.chunkLength_ == kChunkSize) {
+                const auto chunkOutput = chunkChainingValue(hash);
+                pushChainingValue(hash, chunkOutput, hash.chunkCounter_ + 1);
+                resetChunk(hash, hash.chunkCounter_ + 1);
+            }
+
+            if (hash.blockLength_ == kBlockSize) {
+                compressInPlace(hash.chunkValue_, hash.block_,
+                                hash.chunkCounter_, kBlockSize,
+                                chunkFlags(hash));
+                hash.blocksCompressed_++;
+                hash.blockLength_ = 0;
+            }
+
+            const auto count = std::min({ remaining,
+                                          kBlockSize - hash.blockLength_,
+                                          kChunkSize - hash.chunkLength_ });
+            std::memcpy(hash.block_.data() + hash.blockLength_, bytes, count);
+            hash.blockLength_ += count;
+            hash.chunkLength_ += count;
+            bytes             += count;
+            remaining         -= count;
+        }
+    }
+
+    /// @brief Finalizes the hash and outputs the digest.
+    /// @param hash The hash to finalize.
+    /// @param result Where to store the digest.
+    static void
+    finalize(Blake3& hash, block_t& result) noexcept {
+        auto value       = hash.chunkValue_;
+        auto block       = hash.block_;
+        auto blockLength = hash.blockLength_;
+        auto counter     = hash.chunkCounter_;
+        auto flags       = chunkFlags(hash) | kChunkEnd;
+        std::fill(block.begin() + blockLength, block.end(), 0);
+
+        // Fold the pending chaining values from the top of the stack down.
+        for (auto index = hash.stackSize_; index > 0; --index) {
+            const auto child = compress(value, block, counter, blockLength, flags);
+            value       = kInitialValue;
+            blockLength = kBlockSize;
+            counter     = 0;
+            flags       = kParent;
+
+            words_t left;
+            std::copy_n(child.begin(), 8, left.begin());
+            storeWords(hash.stack_[index - 1], block.data());
+            storeWords(left, block.data() + 32);
+        }
+
+        const auto output =
+            compress(value, block, counter, blockLength, flags | kRoot);
+        for (auto index = 0u; index < 8; ++index)
+            for (auto byte = 0u; byte < 4; ++byte)
+                result[index * 4 + byte] =
+                    static_cast<std::uint8_t>(output[index] >> (byte * 8));
+    }
+
+    private:
+    static constexpr std::uint32_t kChunkStart = 1 << 0;
+    static constexpr std::uint32_t kChunkEnd   = 1 << 1;
+    static constexpr std::uint32_t kParent     = 1 << 2;
+    static constexpr std::uint32_t kRoot       = 1 << 3;
+
+    static constexpr words_t kInitialValue = { 0x6A09E667, 0xBB67AE85,
+                                               0x3C6EF372, 0xA54FF53A,
+                                               0x510E527F, 0x9B05688C,
+                                               0x1F83D9AB, 0x5BE0CD19 };
+
+    static constexpr std::array<std::size_t, 16> kPermutation = {
+        2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8
+    };
+
+    static void
+    mix(std::array<std::uint32_t, 16>& state,
+        std::size_t a,
+        std::size_t b,
+        std::size_t c,
+        std::size_t d,
+        std::uint32_t x,
+        std::uint32_t y) noexcept {
+        state[a] = state[a] + state[b] + x;
+        state[d] = std::rotr(state[d] ^ state[a], 16);
+        state[c] = state[c] + state[d];
+        state[b] = std::rotr(state[b] ^ state[c], 12);
+        state[a] = state[a] + state[b] + y;
+        state[d] = std::rotr(state[d] ^ state[a], 8);
+        state[c] = state[c] + state[d];
+        state[b] = std::rotr(state[b] ^ state[c], 7);
+    }
+
+    static std::array<std::uint32_t, 16>
+    compress(const words_t& value,
+             const std::array<std::uint8_t, kBlockSize>& block,
+             std::uint64_t counter,
+             std::size_t blockLength,
+             std::uint32_t flags) noexcept {
+        std::array<std::uint32_t, 16> message;
+        for (auto index = 0u; index < 16; ++index)
+            message[index] = loadLittleEndian(block.data() + index * 4);
+
+        std::array<std::uint32_t, 16> state = {
+            value[0],         value[1],
+            value[2],         value[3],
+            value[4],         value[5],
+            value[6],         value[7],
+            kInitialValue[0], kInitialValue[1],
+            kInitialValue[2], kInitialValue[3],
+            static_cast<std::uint32_t>(counter),
+            static_cast<std::uint32_t>(counter >> 32),
+            static_cast<std::uint32_t>(blockLength),
+            flags
+        };
+
+        for (auto round = 0u; round < 7; ++round) {
+            mix(state, 0, 4, 8, 12, message[0], message[1]);
+            mix(state, 1, 5, 9, 13, message[2], message[3]);
+            mix(state, 2, 6, 10, 14, message[4], message[5]);
+            mix(state, 3, 7, 11, 15, message[6], message[7]);
+            mix(state, 0, 5, 10, 15, message[8], message[9]);
+            mix(state, 1, 6, 11, 12, message[10], message[11]);
+            mix(state, 2, 7, 8, 13, message[12], message[13]);
+            mix(state, 3, 4, 9, 14, message[14], message[15]);
+
+            auto permuted = message;
+            for (auto index = 0u; index < 16; ++index)
+                permuted[index] = message[kPermutation[index]];
+            message = permuted;
+        }
+
+        for (auto index = 0u; index < 8; ++index) {
+            state[index]     ^= state[index + 8];
+            state[index + 8] ^= value[index];
+        }
+
+        return state;
+    }
+
+    static void
+    compressInPlace(words_t& value,
+                    const std::array<std::uint8_t, kBlockSize>& block,
+                    std::uint64_t counter,
+                    std::size_t blockLength,
+                    std::uint32_t flags) noexcept {
+        const auto output = compress(value, block, counter, blockLength, flags);
+        std::copy_n(output.begin(), 8, value.begin());
+    }
+
+    static std::uint32_t
+    loadLittleEndian(const std::uint8_t* bytes) noexcept {
+        return (static_cast<std::uint32_t>(bytes[0]) << 0) |
+               (static_cast<std::uint32_t>(bytes[1]) << 8) |
+               (static_cast<std::uint32_t>(bytes[2]) << 16) |
+               (static_cast<std::uint32_t>(bytes[3]) << 24);
+    }
+
+    static void
+    storeWords(const words_t& words, std::uint8_t* bytes) noexcept {
+        for (auto index = 0u; index < 8; ++index)
+            for (auto byte = 0u; byte < 4; ++byte)
+                bytes[index * 4 + byte] =
+                    static_cast<std::uint8_t>(words[index] >> (byte * 8));
+    }
+
+    static std::uint32_t
+    chunkFlags(const Blake3& hash) noexcept {
+        return hash.blocksCompressed_ == 0 ? kChunkStart : 0;
+    }
+
+    static void
+    resetChunk(Blake3& hash, std::uint64_t counter) noexcept {
+        hash.chunkValue_       = kInitialValue;
+        hash.chunkCounter_     = counter;
+        hash.block_.fill(0);
+        hash.blockLength_      = 0;
+        hash.chunkLength_      = 0;
+        hash.blocksCompressed_ = 0;
+    }
+
+    static words_t
+    chunkChainingValue(Blake3& hash) noexcept {
+        auto value = hash.chunkValue_;
+        compressInPlace(value, hash.block_, hash.chunkCounter_,
+                        hash.blockLength_, chunkFlags(hash) | kChunkEnd);
+        return value;
+    }
+
+    static void
+    pushChainingValue(Blake3& hash,
+                      words_t value,
+                      std::uint64_t totalChunks) noexcept {
+        // Every trailing zero bit of the chunk count closes a finished subtree.
+        std::array<std::uint8_t, kBlockSize> block;
+        for (; (totalChunks & 1) == 0; totalChunks >>= 1) {
+            storeWords(hash.stack_[--hash.stackSize_], block.data());
+            storeWords(value, block.data() + 32);
+
+            auto parent = kInitialValue;
+            compressInPlace(parent, block, 0, kBlockSize, kParent);
+            value = parent;
+        }
+
+        hash.stack_[hash.stackSize_++] = value;
+    }
+
+    private:
+    words_t chunkValue_;
+    std::uint64_t chunkCounter_;
+    std::array<std::uint8_t, kBlockSize> block_;
+    std::size_t blockLength_;
+    std::size_t chunkLength_;
+    std::size_t blocksCompressed_;
+    std::array<words_t, 54> stack_;
+    std::size_t stackSize_{ 0 };
+};
+
+
+/// @brief   Generates a digest for the contents of a file.
+/// @details Large files are mapped into memory and hashed in place, smaller
+///          ones are read in large chunks. Neither path holds more than one
+///          chunk of the file in a buffer.
+/// @tparam  HasherType The hash function to use, SHA-1 by default.
+/// @param   path The file to generate the digest for.
+/// @return  The digest and the status code for the operation.
+template<Hasher HasherType = Checksum>
+std::tuple<typename HasherType::block_t, std::error_code>
+hashFile(const std::filesystem::path& path) noexcept {
+    constexpr std::size_t kReadSize     = 1 << 20;
+    constexpr std::size_t kMapThreshold = 1 << 22;
+
+    HasherType hasher("");
+    typename HasherType::block_t block{};
+#if defined(__unix__) || defined(__APPLE__)
+    const auto descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (descriptor < 0)
+        return std::make_tuple(block, make_error_code(errc::pathDoesNotExist));
+
+    struct stat info;
+    if (::fstat(descriptor, &info) != 0) {
+        ::close(descriptor);
+        return std::make_tuple(block, make_error_code(errc::failure));
+    }
+
+    const auto size = static_cast<std::size_t>(info.st_size);
+    auto* mapping   = size >= kMapThreshold
+        ? ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0)
+        : MAP_FAILED;
+
+    if (mapping != MAP_FAILED) {
+        ::madvise(mapping, size, MADV_SEQUENTIAL);
+        HasherType::update(hasher, { static_cast<const char*>(mapping), size });
+        ::munmap(mapping, size);
+    } else {
+        std::vector<char> buffer(std::min(size + 1, kReadSize));
+        ssize_t count;
+        while ((count = ::read(descriptor, buffer.data(), buffer.size())) > 0)
+            HasherType::update(hasher, { buffer.data(),
+                                         static_cast<std::size_t>(count) });
+
+        if (count < 0) {
+            ::close(descriptor);
+            return std::make_tuple(block, make_error_code(errc::failure));
+        }
+    }
+
+    ::close(descriptor);
+#else
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream.is_open())
+        return std::make_tuple(block, make_error_code(errc::pathDoesNotExist));
+
+    std::vector<char> buffer(kReadSize);
+    while (stream) {
+        stream.read(buffer.data(), buffer.size());
+        HasherType::update(hasher, { buffer.data(),
+                                     static_cast<std::size_t>(stream.gcount()) });
+    }
+#endif
+
+    HasherType::finalize(hasher, block);
+    return std::make_tuple(block, make_error_code(errc::success));
+}
+
+
+/// @brief  Hashes the given data in one go.
+/// @tparam HasherType The hash function to use.
+/// @param  data The data to hash.
+/// @return The digest as a lowercase hexadecimal string.
+template<Hasher HasherType>
+std::string
+hashToString(std::string_view data) noexcept {
+    HasherType hasher(data);
+    typename HasherType::block_t block;
+    HasherType::finalize(hasher, block);
+    return digestToString(block);
+}
+
+
+} // namespace cpak::utilities
\ No newline at end of file
@@ -0,0 +1,220 @@
+#pragma once
+#include <compare>
+#include <mutex>
+#include <unordered_set>
+#include "../common.hpp"
+#include "noncopyable.hpp"
+
+namespace cpak::utilities {
+
+
+/// @brief   A process wide table of interned strings.
+/// @details Every distinct string is stored once and never released, so the
+///          addresses handed out stay valid for the lifetime of the process.
+///          The table is split into shards, each with its own lock, so that
+///          concurrent loaders rarely contend with each other.
+class StringTable : public cpak::util::NonCopyable {
+    public:
+    /// @brief  Gets the table shared by the whole process.
+    /// @return The shared table.
+    static StringTable&
+    shared() noexcept {
+        static StringTable table;
+        return table;
+    }
+
+    /// @brief  Gets the interned empty string.
+    /// @return The empty string, which is never stored in a shard.
+    static const std::string&
+    empty() noexcept {
+        static const std::string value;
+        return value;
+    }
+
+    /// @brief  Interns the given string.
+    /// @param  value The string to intern.
+    /// @return The stable address of the interned copy of the string.
+    const std::string*
+    intern(std::string_view value) {
+        if (value.empty()) return &empty();
+
+        auto& shard = shards_[std::hash<std::string_view>{}(value) % shards_.size()];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto found = shard.strings.find(value);
+        if (found == shard.strings.end())
+            found = shard.strings.emplace(value).first;
+
+        return &*found;
+    }
+
+    /// @brief  Gets the number of distinct strings interned so far.
+    /// @return The number of interned strings, excluding the empty string.
+    std::size_t
+    size() noexcept {
+        std::size_t count = 0;
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            count += shard.strings.size();
+        }
+
+        return count;
+    }
+
+    private:
+    struct TransparentHash {
+        using is_transparent = void;
+
+        std::size_t
+        operator()(std::string_view value) const noexcept {
+            return std::hash<std::string_view>{}(value);
+        }
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_set<std::string, TransparentHash, std::equal_to<>> strings;
+    };
+
+    std::array<Shard, 16> shards_;
+};
+
+
+/// @brief   A handle to a string interned in the shared string table.
+/// @details Handles are a single pointer wide, copy without allocating, and
+///          compare and hash by address. They convert implicitly to a
+///          <tt>const std::string&</tt> so they can be used anywhere the model
+///          used to hand out owning strings.
+class InternedString {
+    public:
+    InternedString() noexcept
+        : value_(&StringTable::empty())
+    { }
+
+    InternedString(std::string_view value)
+        : value_(StringTable::shared().intern(value))
+    { }
+
+    InternedString(const std::string& value)
+        : InternedString(std::string_view(value))
+    { }
+
+    InternedString(const char* value)
+        : InternedString(std::string_view(value))
+    { }
+
+    /// @brief  Gets the interned string.
+    /// @return The interned string.
+    const std::string&
+    str() const noexcept {
+        return *value_;
+    }
+
+    /// @brief  Gets a view of the interned string.
+    /// @return A view that stays valid for the lifetime of the process.
+    std::string_view
+    view() const noexcept {
+        return *value_;
+    }
+
+    const char*
+    c_str() const noexcept {
+        return value_->c_str();
+    }
+
+    std::size_t
+    size() const noexcept {
+        return value_->size();
+    }
+
+    bool
+    empty() const noexcept {
+        return value_->empty();
+    }
+
+    /// @brief  Gets a hash of the handle.
+    /// @return The hash of the interned address, which is unique per string.
+    std::size_t
+    hash() const noexcept {
+        return std::hash<const std::string*>{}(value_);
+    }
+
+    operator const std::string&() const noexcept {
+        return *value_;
+    }
+
+    friend bool
+    operator==(InternedString lhs, InternedString rhs) noexcept {
+        return lhs.value_ == rhs.value_;
+    }
+
+    friend bool
+    operator==(InternedString lhs, std::string_view rhs) noexcept {
+        return lhs.view() == rhs;
+    }
+
+    friend bool
+    operator==(InternedString lhs, const std::string& rhs) noexcept {
+        return lhs.view() == rhs;
+    }
+
+    friend bool
+    operator==(InternedString lhs, const char* rhs) noexcept {
+        return lhs.view() == rhs;
+    }
+
+    friend std::strong_ordering
+    operator<=>(InternedString lhs, InternedString rhs) noexcept {
+        if (lhs.value_ == rhs.value_) return std::strong_ordering::equal;
+        return lhs.view().compare(rhs.view()) < 0
+             ? std::strong_ordering::less
+             : std::strong_ordering::greater;
+    }
+
+    friend std::ostream&
+    operator<<(std::ostream& stream, InternedString value) {
+        return stream << value.view();
+    }
+
+    private:
+    const std::string* value_;
+};
+
+
+} // namespace cpak::utilities
+
+
+template<>
+struct std::hash<cpak::utilities::InternedString> {
+    std::size_t
+    operator()(cpak::utilities::InternedString value) const noexcept {
+        return value.hash();
+    }
+};
+
+
+template<>
+struct fmt::formatter<cpak::utilities::InternedString>
+    : fmt::formatter<std::string_view> {
+    template<typename FormatContext>
+    auto
+    format(cpak::utilities::InternedString value, FormatContext& ctx) const {
+        return fmt::formatter<std::string_view>::format(value.view(), ctx);
+    }
+};
+
+
+template<>
+struct YAML::convert<cpak::utilities::InternedString> {
+    static Node
+    encode(cpak::utilities::InternedString rhs) {
+        return Node(rhs.str());
+    }
+
+    static bool
+    decode(const Node& node, cpak::utilities::InternedString& rhs) {
+        if (!node.IsScalar()) return false;
+        rhs = node.Scalar();
+        return true;
+    }
+};
@@ -9,7 +9,9 @@ namespace cpak::utilities {
 /// @return The trimmed string.
 inline std::string
 ltrim(std::string input) noexcept {
-    return input.substr(input.find_first_not_of(" \t\n\r\f\v"));
+    const auto start = input.find_first_not_of(" \t\n\r\f\v");
+    if (start == std::string::npos) return std::string();
+    return input.substr(start);
 }
 
 
@@ -95,4 +97,19 @@ splitString(std::string_view str,
 }
 
 
+/// @brief  Quotes a string so a POSIX shell reads it as a single word.
+/// @param  input The string to quote.
+/// @return The quoted string.
+inline std::string
+quoteShellArgument(std::string_view input) noexcept {
+    std::string quoted = "'";
+    for (const auto character : input) {
+        if (character == '\'') quoted += "'\\''";
+        else quoted += character;
+    }
+
+    return quoted + "'";
+}
+
+
 } // namespace cpak::utilities
\ No newline at end of file
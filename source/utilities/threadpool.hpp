@@ -0,0 +1,153 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <thread>
+#include "../common.hpp"
+#include "noncopyable.hpp"
+
+namespace cpak::utilities {
+
+
+/// @brief   A fixed size pool of worker threads.
+/// @details Tasks are run in the order they were submitted. Work that is split
+///          with \c forEach is also picked up by the calling thread, so it is
+///          safe to call from inside a task running on the same pool.
+class ThreadPool : public cpak::util::NonCopyable {
+    public:
+    /// @brief Creates a pool with the given number of workers.
+    /// @param threadCount The number of workers, at least one is created.
+    explicit ThreadPool(std::size_t threadCount = defaultThreadCount()) {
+        threadCount = std::max<std::size_t>(threadCount, 1);
+        workers_.reserve(threadCount);
+        for (auto index = 0u; index < threadCount; ++index)
+            workers_.emplace_back([this] { workerLoop(); });
+    }
+
+    /// @brief Finishes the queued tasks and joins the workers.
+    ~ThreadPool() override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+
+        condition_.notify_all();
+        for (auto& worker : workers_) worker.join();
+    }
+
+    /// @brief  Gets the pool shared by the whole process.
+    /// @return The shared pool, sized to the hardware concurrency.
+    static ThreadPool&
+    shared() noexcept {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    /// @brief  Gets the number of workers to use when none is given.
+    /// @return The hardware concurrency, or one if it is unknown.
+    static std::size_t
+    defaultThreadCount() noexcept {
+        return std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    /// @brief  Gets the number of workers in the pool.
+    /// @return The number of workers.
+    std::size_t
+    size() const noexcept {
+        return workers_.size();
+    }
+
+    /// @brief  Queues a task to run on the pool.
+    /// @param  function The task to run.
+    /// @return A future for the result of the task.
+    template<typename Function>
+    std::future<std::invoke_result_t<Function>>
+    submit(Function&& function) {
+        using result_t = std::invoke_result_t<Function>;
+
+        auto task = std::make_shared<std::packaged_task<result_t()>>(
+            std::forward<Function>(function));
+        auto future = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.emplace([task] { (*task)(); });
+        }
+
+        condition_.notify_one();
+        return future;
+    }
+
+    /// @brief   Calls the function for every index in [0, count) in parallel.
+    /// @details Indices are handed out one at a time to the workers and the
+    ///          calling thread, this returns once all of them are done.
+    /// @param   count The number of indices.
+    /// @param   function The function to call with each index.
+    template<typename Function>
+    void
+    forEach(std::size_t count, Function&& function) {
+        struct State {
+            std::atomic<std::size_t> next{ 0 };
+            std::atomic<std::size_t> done{ 0 };
+            std::mutex mutex;
+            std::condition_variable finished;
+        };
+
+        // Helpers that start after the work ran out never call the function,
+        // the counters they check are kept alive by the shared state.
+        auto state = std::make_shared<State>();
+        auto run   = [state, count, &function] {
+            std::size_t index;
+            while ((index = state->next.fetch_add(1)) < count) {
+                function(index);
+                if (state->done.fetch_add(1) + 1 == count) {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    state->finished.notify_all();
+                }
+            }
+        };
+
+        const auto helpers = std::min(count, workers_.size()) - (count != 0);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto index = 0u; index < helpers; ++index)
+                tasks_.emplace(run);
+        }
+
+        condition_.notify_all();
+        run();
+
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->finished.wait(lock, [&] { return state->done.load() == count; });
+    }
+
+    private:
+    void
+    workerLoop() noexcept {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                condition_.wait(lock, [this] {
+                    return stopping_ || !tasks_.empty();
+                });
+
+                if (tasks_.empty()) return;
+                task = std::move(tasks_.front());
+                tasks_.pop();
+            }
+
+            task();
+        }
+    }
+
+    private:
+    std::vector<std::thread> workers_;
+    std::queue<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    bool stopping_{ false };
+};
+
+
+} // namespace cpak::utilities
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+#include "common.hpp"
+
+namespace cpak {
+
+
+/// @brief   Contains the workspace information.
+/// @details A workspace lists the projects that are built together as one
+///          graph. Members are paths to project directories, relative to the
+///          directory the workspace file is in.
+struct Workspace {
+    std::vector<std::string> members;
+
+    // Not to be serialized.
+    // Used during the build process.
+    std::filesystem::path workspacePath;
+};
+
+
+inline void
+validateWorkspaceSchema(const YAML::Node& node) {
+    if (!node.IsMap())
+        throw YAML::ParserException(node.Mark(), "Workspace is not a map.");
+
+    if (!node["members"])
+        throw YAML::ParserException(node.Mark(), "Workspace must list its members.");
+
+    if (!node["members"].IsSequence())
+        throw YAML::ParserException(node["members"].Mark(), "Workspace members must be a sequence.");
+
+    if (node["members"].size() == 0)
+        throw YAML::ParserException(node["members"].Mark(), "Workspace members must not be empty.");
+
+    for (const auto& member : node["members"])
+        if (!member.IsScalar())
+            throw YAML::ParserException(member.Mark(), "Workspace member must be a path.");
+}
+
+
+} // namespace cpak
+
+
+template<>
+struct YAML::convert<cpak::Workspace> {
+    static Node
+    encode(const cpak::Workspace& rhs) {
+        Node node;
+        node["members"] = rhs.members;
+        return node;
+    }
+
+    static bool
+    decode(const YAML::Node& node, cpak::Workspace& rhs) {
+        cpak::validateWorkspaceSchema(node);
+        rhs.members = node["members"].as<std::vector<std::string>>();
+        return true;
+    }
+};
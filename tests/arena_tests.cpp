@@ -0,0 +1,74 @@
+#include "decoder.hpp"
+#include "utilities/arena.hpp"
+#include "gtest/gtest.h"
+
+using cpak::AccessiblesAllocator;
+using cpak::Accessibles;
+using cpak::InternedString;
+using cpak::utilities::makeArena;
+
+
+///////////////////////////////////////////////////////////////////////////////
+///////                      Arena Allocation Tests                     ///////
+///////////////////////////////////////////////////////////////////////////////
+TEST(ArenaTests, movesKeepTheArena) {
+    const AccessiblesAllocator<InternedString> allocator(makeArena());
+    Accessibles<InternedString> values(allocator);
+    values.push_back({ .stored = "-DVALUE=1" });
+
+    Accessibles<InternedString> moved;
+    moved = std::move(values);
+    EXPECT_EQ(moved.get_allocator(), allocator);
+    EXPECT_EQ(moved[0].stored, "-DVALUE=1");
+}
+
+TEST(ArenaTests, copiesUseTheHeap) {
+    Accessibles<InternedString> copy;
+    {
+        const AccessiblesAllocator<InternedString> allocator(makeArena());
+        Accessibles<InternedString> values(allocator);
+        values.push_back({ .stored = "source/main.cpp" });
+        copy = Accessibles<InternedString>(values);
+    }
+
+    EXPECT_EQ(copy.get_allocator().arena(), nullptr);
+    EXPECT_EQ(copy[0].stored, "source/main.cpp");
+}
+
+TEST(ArenaTests, containersKeepTheArenaAlive) {
+    auto arena = makeArena();
+    Accessibles<InternedString> values{ AccessiblesAllocator<InternedString>(arena) };
+    values.push_back({ .stored = "include" });
+    arena.reset();
+
+    values.push_back({ .stored = "source" });
+    EXPECT_NE(values.get_allocator().arena(), nullptr);
+    EXPECT_EQ(values[1].stored, "source");
+}
+
+TEST(ArenaTests, decodedTargetsShareAnArena) {
+    std::istringstream stream(R"(
+project:
+  name: sample
+  gpid: simtech
+  semv: 1.0.0
+
+targets:
+- name: first
+  type: executable
+  sources:
+  - source/first.cpp
+- name: second
+  type: executable
+  options: -O2 -Wall
+  sources:
+  - source/second.cpp
+)");
+
+    const auto cpakfile = cpak::decoder::decodeCPakFile(stream);
+    const auto arena    = cpakfile.targets[0].sources.get_allocator().arena();
+
+    ASSERT_NE(arena, nullptr);
+    EXPECT_EQ(cpakfile.targets[1].sources.get_allocator().arena(), arena);
+    EXPECT_EQ(cpakfile.targets[1].options.get_allocator().arena(), arena);
+}
@@ -0,0 +1,199 @@
+#include "cache.hpp"
+#include "errorcode.hpp"
+#include "gtest/gtest.h"
+
+
+struct LinkCacheTestFixture : public ::testing::Test {
+protected:
+    static void
+    SetUpTestCase() {
+        // Keep the cache out of the real home directory.
+        originalHome_ = std::getenv("HOME");
+        temporaryHome_ =
+            std::filesystem::temp_directory_path() / ".cachecpaktesting";
+        std::filesystem::create_directories(temporaryHome_);
+        setenv("HOME", temporaryHome_.c_str(), 1);
+
+        objectPath_ = temporaryHome_ / "main.cpp.o";
+        outputPath_ = temporaryHome_ / "testexe";
+        writeFile(objectPath_, "object contents");
+    }
+
+    static void
+    TearDownTestCase() {
+        setenv("HOME", originalHome_.c_str(), 1);
+        std::filesystem::remove_all(temporaryHome_);
+    }
+
+    static void
+    writeFile(const std::filesystem::path& path, std::string_view contents) {
+        std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+        stream << contents;
+    }
+
+    inline static std::string originalHome_;
+    inline static std::filesystem::path temporaryHome_;
+    inline static std::filesystem::path objectPath_;
+    inline static std::filesystem::path outputPath_;
+};
+
+
+/////////////////////////////////////////////////////////////////////////////
+///////                      Positive Cache Tests                     ///////
+/////////////////////////////////////////////////////////////////////////////
+TEST_F(LinkCacheTestFixture, keyIsStableForSameInputs) {
+    const std::vector<std::string> arguments{ "g++", "main.cpp.o" };
+    const auto [first, firstResult]   =
+        cpak::cache::linkCacheKey(arguments, { objectPath_ });
+    const auto [second, secondResult] =
+        cpak::cache::linkCacheKey(arguments, { objectPath_ });
+
+    ASSERT_EQ(firstResult.value(), cpak::errc::success);
+    ASSERT_EQ(secondResult.value(), cpak::errc::success);
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(first.size(), 32);
+}
+
+TEST_F(LinkCacheTestFixture, keyChangesWithArgumentsAndContents) {
+    const std::vector<std::string> arguments{ "g++", "main.cpp.o" };
+    const auto [original, _] =
+        cpak::cache::linkCacheKey(arguments, { objectPath_ });
+    const auto [withFlag, __] =
+        cpak::cache::linkCacheKey({ "g++", "-O2", "main.cpp.o" },
+                                  { objectPath_ });
+
+    writeFile(objectPath_, "changed object contents");
+    const auto [withContents, ___] =
+        cpak::cache::linkCacheKey(arguments, { objectPath_ });
+    writeFile(objectPath_, "object contents");
+
+    EXPECT_NE(original, withFlag);
+    EXPECT_NE(original, withContents);
+}
+
+TEST_F(LinkCacheTestFixture, canRestoreStoredOutput) {
+    const auto key = std::string(40, 'a');
+    writeFile(outputPath_, "linked binary");
+
+    auto result = cpak::cache::storeLinkOutput(key, outputPath_);
+    ASSERT_EQ(result.value(), cpak::errc::success) << result.message();
+
+    std::filesystem::remove(outputPath_);
+    result = cpak::cache::restoreLinkOutput(key, outputPath_);
+    ASSERT_EQ(result.value(), cpak::errc::success) << result.message();
+
+    std::ifstream stream(outputPath_);
+    std::string contents(std::istreambuf_iterator<char>(stream), {});
+    EXPECT_EQ(contents, "linked binary");
+}
+
+TEST_F(LinkCacheTestFixture, canRestoreCompressedOutput) {
+    const auto key = std::string(40, 'c');
+    writeFile(outputPath_, std::string(10000, 'x'));
+    std::filesystem::permissions(outputPath_,
+                                 std::filesystem::perms::owner_all);
+
+    auto result = cpak::cache::storeLinkOutput(key, outputPath_, 1);
+    ASSERT_EQ(result.value(), cpak::errc::success) << result.message();
+
+    std::filesystem::remove(outputPath_);
+    result = cpak::cache::restoreLinkOutput(key, outputPath_);
+    ASSERT_EQ(result.value(), cpak::errc::success) << result.message();
+
+    std::ifstream stream(outputPath_);
+    std::string contents(std::istreambuf_iterator<char>(stream), {});
+    EXPECT_EQ(contents, std::string(10000, 'x'));
+    EXPECT_EQ(std::filesystem::status(outputPath_).permissions(),
+              std::filesystem::perms::owner_all);
+}
+
+TEST_F(LinkCacheTestFixture, fingerprintOnlyCoversReferencedOptions) {
+    cpak::BuildTarget target;
+    target.name = "app";
+    target.type = cpak::TargetType::Executable;
+    target.referencedOptions["OPT_LEVEL"] = "2";
+
+    const std::vector<std::string> arguments{ "g++", "-O2" };
+    const auto original = cpak::cache::targetFingerprint(target, arguments);
+    EXPECT_EQ(original.size(), 32);
+    EXPECT_EQ(cpak::cache::targetFingerprint(target, arguments), original);
+
+    // The referenced option values, the flags and the toolchain all count.
+    auto other = target;
+    other.referencedOptions["OPT_LEVEL"] = "3";
+    EXPECT_NE(cpak::cache::targetFingerprint(other, arguments), original);
+    EXPECT_NE(cpak::cache::targetFingerprint(target, { "g++", "-O3" }),
+              original);
+    EXPECT_NE(cpak::cache::targetFingerprint(target, { "clang++", "-O2" }),
+              original);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+///////                      Negative Cache Tests                     ///////
+/////////////////////////////////////////////////////////////////////////////
+TEST_F(LinkCacheTestFixture, cannotRestoreUnknownKey) {
+    const auto result =
+        cpak::cache::restoreLinkOutput(std::string(40, 'b'), outputPath_);
+    EXPECT_EQ(result.value(), (int)cpak::errc::cacheMiss);
+    EXPECT_EQ(result.message(), cpak::errc::kCacheMissMessage);
+}
+
+TEST_F(LinkCacheTestFixture, cannotKeyMissingInput) {
+    const auto [key, result] = cpak::cache::linkCacheKey(
+        { "g++" }, { temporaryHome_ / "missing.o" });
+    EXPECT_EQ(result.value(), (int)cpak::errc::pathDoesNotExist);
+    EXPECT_TRUE(key.empty());
+}
+
+/////////////////////////////////////////////////////////////////////////////
+///////                    Positive File Hash Tests                   ///////
+/////////////////////////////////////////////////////////////////////////////
+TEST_F(LinkCacheTestFixture, fileHashesSurviveSaveAndLoad) {
+    const auto storePath = temporaryHome_ / "filehashes";
+    const auto filePath  = temporaryHome_ / "stable.o";
+    writeFile(filePath, "stable contents");
+
+    std::string digest;
+    {
+        cpak::cache::FileHashCache hashes(storePath, std::chrono::seconds(0));
+        auto [first, result] = hashes.hash(filePath);
+        ASSERT_EQ(result.value(), cpak::errc::success);
+
+        const auto [second, _] = hashes.hash(filePath);
+        EXPECT_EQ(first, second);
+        EXPECT_EQ(hashes.readCount(), 1);
+        ASSERT_EQ(hashes.save().value(), cpak::errc::success);
+        digest = first;
+    }
+
+    cpak::cache::FileHashCache reloaded(storePath, std::chrono::seconds(0));
+    const auto [loaded, result] = reloaded.hash(filePath);
+    ASSERT_EQ(result.value(), cpak::errc::success);
+    EXPECT_EQ(loaded, digest);
+    EXPECT_EQ(reloaded.readCount(), 0);
+}
+
+TEST_F(LinkCacheTestFixture, fileHashesNoticeChangedFiles) {
+    const auto filePath = temporaryHome_ / "changing.o";
+    writeFile(filePath, "first contents");
+
+    cpak::cache::FileHashCache hashes(temporaryHome_ / "changinghashes",
+                                      std::chrono::seconds(0));
+    const auto [before, _] = hashes.hash(filePath);
+    writeFile(filePath, "second, longer contents");
+    const auto [after, __] = hashes.hash(filePath);
+
+    EXPECT_NE(before, after);
+    EXPECT_EQ(hashes.readCount(), 2);
+}
+
+TEST_F(LinkCacheTestFixture, fileHashesRereadRacyFiles) {
+    const auto filePath = temporaryHome_ / "racy.o";
+    writeFile(filePath, "just written");
+
+    // Written moments ago, so the stamp cannot prove it stays unchanged.
+    cpak::cache::FileHashCache hashes(temporaryHome_ / "racyhashes");
+    hashes.hash(filePath);
+    hashes.hash(filePath);
+    EXPECT_EQ(hashes.readCount(), 2);
+}
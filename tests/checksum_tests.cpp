@@ -1,7 +1,20 @@
+#include <chrono>
 #include <sstream>
-#include "utilities/checksum.hpp"
+#include "utilities/hasher.hpp"
 #include "gtest/gtest.h"
 
+using cpak::utilities::Checksum;
+
+
+std::string
+digestOf(std::string_view data) {
+    Checksum checksum(data);
+    Checksum::block_t block;
+    Checksum::finalize(checksum, block);
+    return cpak::utilities::digestToString(block);
+}
+
+
 TEST(ChecksumTests, canReplicateChecksum) {
     cpak::utilities::Checksum actual("cpaktest");
     cpak::utilities::Checksum::block_t block;
@@ -13,4 +26,110 @@ TEST(ChecksumTests, canReplicateChecksum) {
             << static_cast<int>(byte);
 
     ASSERT_EQ("0616799c9f15a2672f71be3772e6a7d2a06289d1", oss.str());
-}
\ No newline at end of file
+}
+
+TEST(ChecksumTests, canReplicateReferenceVectors) {
+    EXPECT_EQ(digestOf(""), "da39a3ee5e6b4b0d3255bfef95601890afd80709");
+    EXPECT_EQ(digestOf("abc"), "a9993e364706816aba3e25717850c26c9cd0d89d");
+    EXPECT_EQ(
+        digestOf("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"),
+        "84983e441c3bd26ebaae4aa1f95129e5e54670f1");
+    EXPECT_EQ(digestOf(std::string(1000000, 'a')),
+              "34aa973cd4c4daa4f61eeb2bdbad27316534016f");
+}
+
+TEST(ChecksumTests, canUpdateAcrossChunkBoundaries) {
+    std::string data;
+    for (auto index = 0; index < 1000; ++index)
+        data += static_cast<char>(index * 31);
+
+    // Every split point, including ones inside the padding chunk.
+    const auto expected = digestOf(data);
+    for (auto split : { 1u, 55u, 56u, 63u, 64u, 65u, 127u, 128u, 999u }) {
+        Checksum checksum(std::string_view(data).substr(0, split));
+        Checksum::update(checksum, std::string_view(data).substr(split));
+
+        Checksum::block_t block;
+        Checksum::finalize(checksum, block);
+        EXPECT_EQ(cpak::utilities::digestToString(block), expected)
+            << "split at " << split;
+    }
+}
+
+TEST(ChecksumTests, canHashFile) {
+    const auto path =
+        std::filesystem::temp_directory_path() / ".checksumcpaktesting";
+    for (auto size : { std::size_t(0), std::size_t(100), std::size_t(5 << 20) }) {
+        const auto data = std::string(size, 'z');
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << data;
+
+        const auto [block, result] = cpak::utilities::hashFile(path);
+        ASSERT_EQ(result.value(), cpak::errc::success) << result.message();
+        EXPECT_EQ(cpak::utilities::digestToString(block), digestOf(data))
+            << "size " << size;
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST(ChecksumTests, allBackendsProduceIdenticalDigests) {
+    std::string data;
+    for (auto index = 0; index < 100000; ++index)
+        data += static_cast<char>(index * 131 + (index >> 7));
+
+    const auto original = Checksum::activeBackend();
+    ASSERT_TRUE(
+        Checksum::selectBackend(cpak::utilities::ChecksumBackend::ePortable));
+
+    std::vector<std::string> expected;
+    const auto sizes = { 0u, 3u, 55u, 56u, 64u, 119u, 128u, 1000u, 100000u };
+    for (auto size : sizes)
+        expected.push_back(digestOf(std::string_view(data).substr(0, size)));
+
+    for (auto backend : Checksum::supportedBackends()) {
+        ASSERT_TRUE(Checksum::selectBackend(backend));
+
+        auto index = 0u;
+        for (auto size : sizes)
+            EXPECT_EQ(digestOf(std::string_view(data).substr(0, size)),
+                      expected[index++])
+                << "backend " << static_cast<int>(backend) << ", size " << size;
+        EXPECT_EQ(digestOf(std::string(1000000, 'a')),
+                  "34aa973cd4c4daa4f61eeb2bdbad27316534016f");
+    }
+
+    Checksum::selectBackend(original);
+}
+
+TEST(ChecksumTests, cannotSelectUnsupportedBackend) {
+    const auto backends = Checksum::supportedBackends();
+    for (auto backend : { cpak::utilities::ChecksumBackend::eShaNi,
+                          cpak::utilities::ChecksumBackend::eArmCrypto }) {
+        const auto supported = std::find(backends.begin(), backends.end(),
+                                         backend) != backends.end();
+        if (supported) continue;
+
+        const auto original = Checksum::activeBackend();
+        EXPECT_FALSE(Checksum::selectBackend(backend));
+        EXPECT_EQ(Checksum::activeBackend(), original);
+    }
+}
+
+TEST(ChecksumTests, cannotHashMissingFile) {
+    const auto [block, result] =
+        cpak::utilities::hashFile("/nonexistent/path/to/file");
+    EXPECT_EQ(result.value(), (int)cpak::errc::pathDoesNotExist);
+}
+
+// Run with --gtest_also_run_disabled_tests to measure throughput.
+TEST(ChecksumTests, DISABLED_benchmarkThroughput) {
+    const auto data = std::string(256 << 20, 'x');
+    const auto start = std::chrono::steady_clock::now();
+    const auto digest = digestOf(data);
+    const auto elapsed = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start);
+
+    std::cout << "SHA-1 (backend " << static_cast<int>(Checksum::activeBackend())
+              << "): " << data.size() / elapsed.count() / 1e9
+              << " GB/s (" << digest << ")" << std::endl;
+}
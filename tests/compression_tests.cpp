@@ -0,0 +1,78 @@
+#include <random>
+#include <sstream>
+#include "utilities/compression.hpp"
+#include "gtest/gtest.h"
+
+using cpak::utilities::Compression;
+
+
+std::string
+roundTrip(const std::string& data, std::uint32_t level, std::size_t& stored) {
+    std::istringstream raw(data);
+    std::stringstream compressed;
+    EXPECT_TRUE(Compression::compress(raw, compressed, level));
+    stored = compressed.str().size();
+
+    std::ostringstream restored;
+    EXPECT_TRUE(Compression::decompress(compressed, restored));
+    return restored.str();
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+///////                    Positive Compression Tests                   ///////
+///////////////////////////////////////////////////////////////////////////////
+TEST(CompressionTests, canRoundTripEmptyInput) {
+    std::size_t stored;
+    EXPECT_EQ(roundTrip("", 1, stored), "");
+}
+
+TEST(CompressionTests, canRoundTripRepetitiveInputAtEveryLevel) {
+    std::string data;
+    for (auto index = 0; index < 100000; ++index)
+        data += "symbol_" + std::to_string(index % 977) + ";";
+
+    for (auto level = 1u; level <= Compression::kMaxLevel; ++level) {
+        std::size_t stored;
+        EXPECT_EQ(roundTrip(data, level, stored), data) << "level " << level;
+        EXPECT_LT(stored, data.size() / 3) << "level " << level;
+    }
+}
+
+TEST(CompressionTests, canRoundTripIncompressibleInput) {
+    std::mt19937 generator(42);
+    std::string data(3 * Compression::kBlockSize + 17, '\0');
+    for (auto& byte : data) byte = static_cast<char>(generator());
+
+    std::size_t stored;
+    EXPECT_EQ(roundTrip(data, 1, stored), data);
+    EXPECT_LT(stored, data.size() + 64);
+}
+
+TEST(CompressionTests, canRoundTripOverlappingMatches) {
+    const auto data = std::string(70000, 'a') + "b" + std::string(300, 'a');
+
+    std::size_t stored;
+    EXPECT_EQ(roundTrip(data, 3, stored), data);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+///////                    Negative Compression Tests                   ///////
+///////////////////////////////////////////////////////////////////////////////
+TEST(CompressionTests, cannotDecompressWithoutMagic) {
+    std::istringstream compressed("not a compressed frame");
+    std::ostringstream restored;
+    EXPECT_FALSE(Compression::decompress(compressed, restored));
+}
+
+TEST(CompressionTests, cannotDecompressTruncatedFrame) {
+    std::istringstream raw(std::string(5000, 'x'));
+    std::stringstream compressed;
+    ASSERT_TRUE(Compression::compress(raw, compressed, 1));
+
+    const auto frame = compressed.str();
+    std::istringstream truncated(frame.substr(0, frame.size() - 9));
+    std::ostringstream restored;
+    EXPECT_FALSE(Compression::decompress(truncated, restored));
+}
@@ -0,0 +1,235 @@
+#include "decoder.hpp"
+#include "gtest/gtest.h"
+
+using namespace cpak;
+
+
+static CPakFile
+decode(const std::string& contents) {
+    std::istringstream stream(contents);
+    return decoder::decodeCPakFile(stream);
+}
+
+
+static std::string
+dump(const CPakFile& cpakfile) {
+    return YAML::Dump(YAML::Node(cpakfile));
+}
+
+
+static constexpr std::string_view kCPakFile = R"(
+project:
+  name: sample
+  gpid: simtech
+  semv: 1.0.0-alpha+dev
+  desc: A sample project.
+  authors:
+  - johndoe
+
+options:
+- name: MY_CUSTOM_OPTION
+  desc: "This is a custom option."
+  value: 1.0
+
+repositories:
+- &gitlab
+  address: https://gitlab.com/
+  username: johndoe
+  email: johndoe@gmail.com
+  password: $SECRET_PASSWORD
+
+dependencies:
+- simtech/other@2.0.0
+- cpakid: simtech/example@1.0.0
+  remote: *gitlab
+
+targets:
+- name: simtech::base
+  type: static library
+  options: !private >
+    -m64 -std=c++17 -Wall
+  defines:
+  - BASE=1
+  - !protected INTERNAL=1
+  search:
+    include:
+    - include
+    library: []
+  sources: &sources
+    - src/base.cpp
+    - !private src/base.hpp
+- name: simtech::interface
+  type: interface
+  interfaces:
+  - simtech::base
+- name: simtech::exe
+  type: executable
+  libraries:
+  - base
+  sources: *sources
+
+install:
+  targets:
+  - simtech::exe
+  files:
+  - !header include/*.hpp
+  global: yes
+)";
+
+
+///////////////////////////////////////////////////////////////////////////////
+///////                    Positive Decoding Tests                      ///////
+///////////////////////////////////////////////////////////////////////////////
+TEST(DecoderTests, decodesLikeTheConverters) {
+    const auto expected = YAML::Load(std::string(kCPakFile)).as<CPakFile>();
+    const auto decoded  = decode(std::string(kCPakFile));
+
+    EXPECT_EQ(dump(decoded), dump(expected));
+    ASSERT_EQ(decoded.targets.size(), 3);
+    EXPECT_EQ(decoded.targets[2].sources.size(), 2);
+    EXPECT_TRUE(decoded.targets[0].sources[1].isPrivate());
+    EXPECT_TRUE(decoded.targets[0].options[0].isPrivate());
+    EXPECT_TRUE(decoded.install->global);
+    ASSERT_TRUE(decoded.dependencies[1].remote.has_value());
+    EXPECT_EQ(decoded.dependencies[1].remote->username, "johndoe");
+}
+
+TEST(DecoderTests, accessiblesPointAtTheirTarget) {
+    const auto decoded = decode(std::string(kCPakFile));
+    for (const auto& target : decoded.targets) {
+        for (const auto& source : target.sources)
+            EXPECT_EQ(source.owner, &target);
+        for (const auto& define : target.defines)
+            EXPECT_EQ(define.owner, &target);
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+///////                    Schema Validation Tests                      ///////
+///////////////////////////////////////////////////////////////////////////////
+TEST(DecoderTests, cannotDecodeEmptyDocument) {
+    try {
+        decode("");
+        FAIL() << "Expected an empty document to be rejected.";
+    } catch (const YAML::Exception& e) {
+        EXPECT_EQ(e.msg, "CPakFile is not a map");
+    }
+}
+
+TEST(DecoderTests, marksTheOffendingValue) {
+    const auto contents = R"(project:
+  name: sample
+  gpid: simtech
+  semv: 1.0.0
+
+targets:
+- name: base
+  type: executable
+  sources:
+  - source/main.cpp
+  defines: NOT_A_SEQUENCE
+)";
+
+    try {
+        decode(contents);
+        FAIL() << "Expected non sequence defines to be rejected.";
+    } catch (const YAML::Exception& e) {
+        EXPECT_EQ(e.msg, "Target defines must be a sequence.");
+        EXPECT_EQ(e.mark.line, 10);
+        EXPECT_EQ(e.mark.column, 11);
+    }
+}
+
+TEST(DecoderTests, marksInvalidCPakIDs) {
+    const auto contents = R"(project:
+  name: sample
+  gpid: simtech
+  semv: 1.0.0
+
+dependencies:
+- simtech/Other@1.0.0
+
+targets:
+- name: base
+  type: interface
+)";
+
+    try {
+        decode(contents);
+        FAIL() << "Expected an invalid CPakID to be rejected.";
+    } catch (const YAML::Exception& e) {
+        EXPECT_EQ(e.mark.line, 6);
+        EXPECT_EQ(e.mark.column, 2 + 8);
+    }
+}
+
+TEST(DecoderTests, cannotDecodeTargetMissingSources) {
+    const auto contents = R"(
+project:
+  name: sample
+  gpid: simtech
+  semv: 1.0.0
+
+targets:
+- name: base
+  type: executable
+)";
+
+    try {
+        decode(contents);
+        FAIL() << "Expected a target without sources to be rejected.";
+    } catch (const YAML::Exception& e) {
+        EXPECT_EQ(e.msg, "Target is missing sources.");
+    }
+}
+
+TEST(DecoderTests, cannotExpandNestedAliasesWithoutBound) {
+    std::string contents = "lol0: &lol0 [lol, lol, lol, lol, lol, lol, lol, lol]\n";
+    for (int level = 1; level < 10; ++level) {
+        const auto previous = "*lol" + std::to_string(level - 1);
+        contents += "lol" + std::to_string(level) + ": &lol" +
+                    std::to_string(level) + " [";
+        for (int alias = 0; alias < 8; ++alias)
+            contents += (alias == 0 ? "" : ", ") + previous;
+        contents += "]\n";
+    }
+
+    try {
+        decode(contents);
+        FAIL() << "Expected unbounded alias expansion to be rejected.";
+    } catch (const YAML::Exception& e) {
+        EXPECT_EQ(e.msg, "Alias expands to too many nodes.");
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+///////                          Benchmarks                             ///////
+///////////////////////////////////////////////////////////////////////////////
+TEST(DecoderTests, DISABLED_benchmarkLargeCPakFile) {
+    std::ostringstream contents;
+    contents << "project:\n  name: sample\n  gpid: simtech\n  semv: 1.0.0\n"
+             << "targets:\n";
+    for (auto target = 0; target < 100; ++target) {
+        contents << "- name: target" << target << "\n"
+                 << "  type: static library\n  sources:\n";
+        for (auto source = 0; source < 500; ++source)
+            contents << "  - source/" << target << "/file" << source << ".cpp\n";
+    }
+
+    const auto measure = [&](std::string_view name, auto load) {
+        const auto start    = std::chrono::steady_clock::now();
+        const auto cpakfile = load(contents.str());
+        const auto elapsed  = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start);
+
+        std::cout << name << ": " << elapsed.count() * 1e3 << " ms ("
+                  << cpakfile.targets.size() << " targets)" << std::endl;
+    };
+
+    measure("YAML::Node", [](const std::string& text) {
+        return YAML::Load(text).as<CPakFile>();
+    });
+    measure("Decoder", decode);
+}
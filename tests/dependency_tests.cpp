@@ -41,10 +41,98 @@ simtech/sample@1.0.0
     EXPECT_EQ(dependency.semv, semver::version::parse("1.0.0"));
 }
 
+TEST(DependencyTests, canDecodeDependencyWithVersionRange) {
+    const auto& yamlStr = R"(
+cpakid: simtech/sample@>=1.4 <2
+)";
+
+    const auto& yaml       = YAML::Load(yamlStr);
+    const auto& dependency = yaml.as<cpak::Dependency>();
+
+    EXPECT_EQ(dependency.name, "sample");
+    EXPECT_EQ(dependency.gpid, "simtech");
+    ASSERT_TRUE(dependency.constraint.has_value());
+    EXPECT_EQ(dependency.constraint->str(), ">=1.4 <2");
+    EXPECT_TRUE(dependency.constraint->acceptsVersion(semver::version::parse("1.9.0")));
+    EXPECT_EQ(cpak::dependencyToString(dependency), "simtech/sample@>=1.4 <2");
+}
+
+
 
 ///////////////////////////////////////////////////////////////////////////////
 ///////                    Schema Validation Tests                      ///////
 ///////////////////////////////////////////////////////////////////////////////
 TEST(DependencyTests, cannotDecodeDependencyMissingName) {
     const auto yamlStr = R"()";
-}
\ No newline at end of file
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////                      CPakID Parsing Tests                       ///////
+///////////////////////////////////////////////////////////////////////////////
+TEST(DependencyTests, canParseCPakID) {
+    static_assert(cpak::parseCPakID("simtech/sample@1.0.0").isValid());
+
+    const auto parsed =
+        cpak::parseCPakID("sim-tech/sample2@1.20.3-rc.1+build.007");
+    ASSERT_TRUE(parsed.isValid());
+    EXPECT_EQ(parsed.gpid, "sim-tech");
+    EXPECT_EQ(parsed.name, "sample2");
+    EXPECT_EQ(parsed.version, "1.20.3-rc.1+build.007");
+
+    const auto branch = cpak::identityFromString("simtech/sample@main", true);
+    EXPECT_EQ(branch.name, "sample");
+    EXPECT_TRUE(branch.versionIsBranch);
+    EXPECT_EQ(branch.semv, semver::version::parse("0.0.0-main"));
+}
+
+TEST(DependencyTests, cannotParseInvalidCPakID) {
+    const std::vector<std::pair<std::string_view, std::size_t>> invalid{
+        { "simtech", 7 },
+        { "Simtech/sample@1.0.0", 0 },
+        { "-simtech/sample@1.0.0", 0 },
+        { "sim--tech/sample@1.0.0", 4 },
+        { "simtech-/sample@1.0.0", 7 },
+        { "simtech/@1.0.0", 8 },
+        { "simtech/sample", 14 },
+        { "simtech/sample@1.0", 18 },
+        { "simtech/sample@01.0.0", 15 },
+        { "simtech/sample@1.0.0-01", 21 },
+        { "simtech/sample@1.0.0-rc..1", 24 },
+        { "simtech/sample@1.0.0 ", 20 },
+    };
+
+    for (const auto& [cpakid, position] : invalid) {
+        const auto parsed = cpak::parseCPakID(cpakid);
+        EXPECT_FALSE(parsed.isValid()) << cpakid;
+        EXPECT_EQ(parsed.errorPosition, position) << cpakid;
+    }
+
+    EXPECT_FALSE(cpak::parseCPakID(std::string(40, 'a') + "/b@1.0.0").isValid());
+    EXPECT_TRUE(cpak::parseCPakID(std::string(39, 'a') + "/b@1.0.0").isValid());
+}
+
+TEST(DependencyTests, cannotDecodeDependencyWithInvalidCPakID) {
+    const auto& yamlStr = R"(
+cpakid: simtech/sample@1.0
+)";
+
+    try {
+        const auto& yaml = YAML::Load(yamlStr);
+        yaml.as<cpak::Dependency>();
+        FAIL() << "Expected an invalid CPakID.";
+    } catch (const YAML::Exception& e) {
+        EXPECT_EQ(e.msg, "Identity is not a valid CPakID, expected '.' after "
+                         "the minor version at column 19.");
+        EXPECT_EQ(e.mark.column, 8 + 18);
+    }
+}
+
+TEST(DependencyTests, cannotDecodeDependencyWithInvalidVersionRange) {
+    try {
+        YAML::Load("simtech/sample@^1.a").as<cpak::Dependency>();
+        FAIL() << "Expected an invalid CPakID.";
+    } catch (const YAML::Exception& e) {
+        EXPECT_EQ(e.msg, "Identity is not a valid CPakID, expected a version "
+                         "number at column 16.");
+    }
+}
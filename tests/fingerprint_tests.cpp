@@ -0,0 +1,119 @@
+#include "utilities/fingerprint.hpp"
+#include "gtest/gtest.h"
+
+using cpak::utilities::Hash128;
+using cpak::utilities::ThreadPool;
+
+
+struct FingerprintTestFixture : public ::testing::Test {
+protected:
+    void
+    SetUp() override {
+        root_ = std::filesystem::temp_directory_path() / ".fingerprintcpaktesting";
+        std::filesystem::remove_all(root_);
+        std::filesystem::create_directories(root_ / "source");
+        writeFile(root_ / "CPakFile", "project: {}");
+        writeFile(root_ / "source" / "main.cpp", "int main() {}");
+    }
+
+    void
+    TearDown() override {
+        std::filesystem::remove_all(root_);
+    }
+
+    static void
+    writeFile(const std::filesystem::path& path, std::string_view contents) {
+        std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+        stream << contents;
+    }
+
+    std::string
+    fingerprint() {
+        const auto [block, result] =
+            cpak::utilities::fingerprintDirectory(root_, pool_);
+        EXPECT_EQ(result.value(), cpak::errc::success) << result.message();
+        return cpak::utilities::digestToString(block);
+    }
+
+    std::filesystem::path root_;
+    ThreadPool pool_{ 4 };
+};
+
+
+/////////////////////////////////////////////////////////////////////////////
+///////                   Positive Fingerprint Tests                  ///////
+/////////////////////////////////////////////////////////////////////////////
+TEST(ThreadPoolTests, canRunEveryIndexOnce) {
+    ThreadPool pool(4);
+    std::vector<std::atomic<int>> counts(1000);
+    pool.forEach(counts.size(), [&](std::size_t index) { counts[index]++; });
+
+    for (const auto& count : counts) EXPECT_EQ(count.load(), 1);
+}
+
+TEST(ThreadPoolTests, canNestForEachInsideTasks) {
+    ThreadPool pool(2);
+    std::atomic<int> total{ 0 };
+    pool.forEach(8, [&](std::size_t) {
+        pool.forEach(8, [&](std::size_t) { total++; });
+    });
+
+    EXPECT_EQ(total.load(), 64);
+    EXPECT_EQ(pool.submit([] { return 42; }).get(), 42);
+}
+
+TEST_F(FingerprintTestFixture, treeDigestIsIndependentOfPoolSize) {
+    // Spans several chunks with a partial one at the end.
+    std::string data(cpak::utilities::kTreeChunkSize * 2 + 1234, '\0');
+    for (auto index = 0u; index < data.size(); ++index)
+        data[index] = static_cast<char>(index * 7);
+    writeFile(root_ / "large.bin", data);
+
+    ThreadPool single(1);
+    const auto [serial, serialResult] =
+        cpak::utilities::hashFileTree<Hash128>(root_ / "large.bin", single);
+    const auto [parallel, parallelResult] =
+        cpak::utilities::hashFileTree<Hash128>(root_ / "large.bin", pool_);
+
+    ASSERT_EQ(serialResult.value(), cpak::errc::success);
+    ASSERT_EQ(parallelResult.value(), cpak::errc::success);
+    EXPECT_EQ(serial, parallel);
+}
+
+TEST_F(FingerprintTestFixture, fingerprintIsStableAndSkipsBuildOutput) {
+    const auto original = fingerprint();
+    EXPECT_EQ(fingerprint(), original);
+
+    std::filesystem::create_directories(root_ / ".cpak" / "build");
+    std::filesystem::create_directories(root_ / ".git");
+    writeFile(root_ / ".cpak" / "build" / "main.o", "object");
+    writeFile(root_ / ".git" / "HEAD", "ref: refs/heads/main");
+    EXPECT_EQ(fingerprint(), original);
+}
+
+TEST_F(FingerprintTestFixture, fingerprintChangesWithContentsAndLayout) {
+    const auto original = fingerprint();
+
+    writeFile(root_ / "source" / "main.cpp", "int main() { return 1; }");
+    const auto edited = fingerprint();
+    EXPECT_NE(edited, original);
+
+    std::filesystem::rename(root_ / "source" / "main.cpp",
+                            root_ / "source" / "entry.cpp");
+    const auto renamed = fingerprint();
+    EXPECT_NE(renamed, edited);
+
+    std::filesystem::permissions(root_ / "source" / "entry.cpp",
+                                 std::filesystem::perms::owner_exec,
+                                 std::filesystem::perm_options::add);
+    EXPECT_NE(fingerprint(), renamed);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+///////                   Negative Fingerprint Tests                  ///////
+/////////////////////////////////////////////////////////////////////////////
+TEST_F(FingerprintTestFixture, cannotFingerprintMissingDirectory) {
+    const auto [block, result] =
+        cpak::utilities::fingerprintDirectory(root_ / "missing", pool_);
+    EXPECT_EQ(result.value(), (int)cpak::errc::pathDoesNotExist);
+}
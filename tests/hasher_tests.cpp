@@ -0,0 +1,111 @@
+#include <chrono>
+#include "utilities/hasher.hpp"
+#include "gtest/gtest.h"
+
+using cpak::utilities::Blake3;
+using cpak::utilities::Checksum;
+using cpak::utilities::Hash128;
+using cpak::utilities::hashToString;
+
+
+std::string
+patternOf(std::size_t size) {
+    std::string data(size, '\0');
+    for (auto index = 0u; index < size; ++index)
+        data[index] = static_cast<char>(index % 251);
+    return data;
+}
+
+
+template<cpak::utilities::Hasher HasherType>
+std::string
+splitDigestOf(std::string_view data, std::size_t split) {
+    HasherType hasher(data.substr(0, split));
+    HasherType::update(hasher, data.substr(split));
+
+    typename HasherType::block_t block;
+    HasherType::finalize(hasher, block);
+    return cpak::utilities::digestToString(block);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////
+///////                     Positive Hasher Tests                     ///////
+/////////////////////////////////////////////////////////////////////////////
+TEST(HasherTests, allHashersSatisfyConcept) {
+    static_assert(cpak::utilities::Hasher<Checksum>);
+    static_assert(cpak::utilities::Hasher<Hash128>);
+    static_assert(cpak::utilities::Hasher<Blake3>);
+    static_assert(!cpak::utilities::Hasher<std::string>);
+}
+
+TEST(HasherTests, canReplicateHash128Vectors) {
+    EXPECT_EQ(hashToString<Hash128>(""), "00000000000000000000000000000000");
+    EXPECT_EQ(hashToString<Hash128>("abc"), "6778ad3f3f3f96b4522dca264174a23b");
+    EXPECT_EQ(hashToString<Hash128>("hello"),
+              "029bbd41b3a7d8cb191dae486a901e5b");
+    EXPECT_EQ(hashToString<Hash128>(patternOf(1025)),
+              "876e9ec63ae6ac83372d834685552068");
+    EXPECT_EQ(hashToString<Hash128>(patternOf(100000)),
+              "40a451e5c354a765a4e6d450c8b837b1");
+}
+
+TEST(HasherTests, canReplicateBlake3Vectors) {
+    EXPECT_EQ(hashToString<Blake3>(""),
+              "af1349b9f5f9a1a6a0404dea36dcc9499bcb25c9adc112b7cc9a93cae41f3262");
+    EXPECT_EQ(hashToString<Blake3>("abc"),
+              "6437b3ac38465133ffb63b75273a8db548c558465d79db03fd359c6cd5bd9d85");
+    EXPECT_EQ(hashToString<Blake3>(patternOf(1025)),
+              "d00278ae47eb27b34faecf67b4fe263f82d5412916c1ffd97c8cb7fb814b8444");
+    EXPECT_EQ(hashToString<Blake3>(patternOf(100000)),
+              "d93c23eedaf165a7e0be908ba86f1a7a520d568d2d13cde787c8580c5c72cc54");
+}
+
+TEST(HasherTests, canUpdateAcrossBlockBoundaries) {
+    const auto data = patternOf(5000);
+    for (auto split : { 1u, 15u, 16u, 17u, 63u, 64u, 1023u, 1024u, 1025u,
+                        2048u, 4999u }) {
+        EXPECT_EQ(splitDigestOf<Hash128>(data, split),
+                  hashToString<Hash128>(data))
+            << "split at " << split;
+        EXPECT_EQ(splitDigestOf<Blake3>(data, split),
+                  hashToString<Blake3>(data))
+            << "split at " << split;
+    }
+}
+
+TEST(HasherTests, canHashFileWithAnyHasher) {
+    const auto path =
+        std::filesystem::temp_directory_path() / ".hashercpaktesting";
+    const auto data = patternOf(5 << 20);
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << data;
+
+    const auto [fast, fastResult] = cpak::utilities::hashFile<Hash128>(path);
+    const auto [strong, strongResult] = cpak::utilities::hashFile<Blake3>(path);
+    std::filesystem::remove(path);
+
+    ASSERT_EQ(fastResult.value(), cpak::errc::success);
+    ASSERT_EQ(strongResult.value(), cpak::errc::success);
+    EXPECT_EQ(cpak::utilities::digestToString(fast),
+              hashToString<Hash128>(data));
+    EXPECT_EQ(cpak::utilities::digestToString(strong),
+              hashToString<Blake3>(data));
+}
+
+// Run with --gtest_also_run_disabled_tests to measure throughput.
+TEST(HasherTests, DISABLED_benchmarkThroughput) {
+    const auto data = std::string(256 << 20, 'x');
+    const auto measure = [&](std::string_view name, auto hash) {
+        const auto start = std::chrono::steady_clock::now();
+        const auto digest = hash(data);
+        const auto elapsed = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start);
+
+        std::cout << name << ": " << data.size() / elapsed.count() / 1e9
+                  << " GB/s (" << digest << ")" << std::endl;
+    };
+
+    measure("SHA-1", hashToString<Checksum>);
+    measure("Hash128", hashToString<Hash128>);
+    measure("BLAKE3", hashToString<Blake3>);
+}
@@ -0,0 +1,68 @@
+#include <thread>
+#include "accessible.hpp"
+#include "utilities/intern.hpp"
+#include "gtest/gtest.h"
+
+using cpak::utilities::InternedString;
+using cpak::utilities::StringTable;
+
+
+///////////////////////////////////////////////////////////////////////////////
+///////                      String Interning Tests                     ///////
+///////////////////////////////////////////////////////////////////////////////
+TEST(InternTests, equalStringsShareStorage) {
+    const std::string value = "simtech/sample@1.0.0";
+    const InternedString first(value);
+    const InternedString second(std::string_view("simtech/sample@1.0.0"));
+
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(&first.str(), &second.str());
+    EXPECT_EQ(first.hash(), second.hash());
+    EXPECT_NE(first, InternedString("simtech/other@1.0.0"));
+}
+
+TEST(InternTests, defaultIsTheEmptyString) {
+    const InternedString empty;
+
+    EXPECT_TRUE(empty.empty());
+    EXPECT_EQ(empty, InternedString(""));
+    EXPECT_EQ(&empty.str(), &StringTable::empty());
+}
+
+TEST(InternTests, outlivesTheOriginalString) {
+    InternedString interned;
+    {
+        std::string temporary = "-DTEMPORARY=1";
+        interned = temporary;
+        temporary.assign("overwritten");
+    }
+
+    EXPECT_EQ(interned, "-DTEMPORARY=1");
+    EXPECT_EQ(fmt::format("{}", interned), "-DTEMPORARY=1");
+}
+
+TEST(InternTests, canInternConcurrently) {
+    std::vector<std::thread> threads;
+    std::vector<const std::string*> addresses(8);
+    for (auto index = 0u; index < addresses.size(); ++index) {
+        threads.emplace_back([&addresses, index] {
+            for (auto count = 0; count < 1000; ++count)
+                InternedString(fmt::format("concurrent{}", count));
+
+            addresses[index] = &InternedString("concurrent0").str();
+        });
+    }
+
+    for (auto& thread : threads) thread.join();
+    for (const auto* address : addresses) EXPECT_EQ(address, addresses[0]);
+}
+
+TEST(InternTests, canDecodeInternedAccessibles) {
+    const auto node = YAML::Load("[ include, !private source ]");
+    const auto accessibles = node.as<cpak::Accessibles<InternedString>>();
+
+    ASSERT_EQ(accessibles.size(), 2);
+    EXPECT_EQ(accessibles[0].stored, "include");
+    EXPECT_TRUE(accessibles[1].isPrivate());
+    EXPECT_EQ(accessibles[1].stored, InternedString("source"));
+}
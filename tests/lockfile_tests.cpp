@@ -0,0 +1,189 @@
+#include "lockfile.hpp"
+#include "gtest/gtest.h"
+
+
+///////////////////////////////////////////////////////////////////////////////
+///////                    Positive Decoding Tests                      ///////
+///////////////////////////////////////////////////////////////////////////////
+TEST(LockfileTests, canDecodeLockfile) {
+    const auto& yamlStr = R"(
+dependencies:
+  simtech/sample@1.0.0:
+    commit: df22cb4bdb8080d3626b8ba50c00a1abe15fb167
+    tree: acdd62c2ba211c632461d8d8777afe1cb3d31096
+)";
+
+    const auto& yaml     = YAML::Load(yamlStr);
+    const auto& lockfile = yaml.as<cpak::Lockfile>();
+
+    ASSERT_EQ(lockfile.dependencies.size(), 1);
+    const auto& locked = lockfile.dependencies.at("simtech/sample@1.0.0");
+    EXPECT_EQ(locked.commit, "df22cb4bdb8080d3626b8ba50c00a1abe15fb167");
+    EXPECT_EQ(locked.tree, "acdd62c2ba211c632461d8d8777afe1cb3d31096");
+}
+
+TEST(LockfileTests, canDecodeEmptyLockfile) {
+    const auto& yaml     = YAML::Load("~");
+    const auto& lockfile = yaml.as<cpak::Lockfile>();
+
+    EXPECT_TRUE(lockfile.dependencies.empty());
+}
+
+TEST(LockfileTests, canDecodeLockedArchive) {
+    const auto& yamlStr = R"(
+dependencies:
+  simtech/sample@1.0.0:
+    archive: 9f86d081884c7d659a2feaa0c55ad015a3bf4f1b2b0b822cd15d6c15b0f00a08
+)";
+
+    const auto& yaml     = YAML::Load(yamlStr);
+    const auto& lockfile = yaml.as<cpak::Lockfile>();
+
+    const auto& locked = lockfile.dependencies.at("simtech/sample@1.0.0");
+    EXPECT_EQ(locked.archive,
+              "9f86d081884c7d659a2feaa0c55ad015a3bf4f1b2b0b822cd15d6c15b0f00a08");
+    EXPECT_TRUE(locked.commit.empty());
+}
+
+TEST(LockfileTests, encodesWhatItDecodes) {
+    cpak::Lockfile lockfile;
+    lockfile.dependencies["simtech/b@1.0.0"] = {
+        .commit = "2af5e1c8a4d1b3f7e6c9d0a2b4c6e8f0a1b3c5d7",
+        .tree   = "97d3f5a7c9e1b3d5f7a9c1e3b5d7f9a1c3e5b7d9",
+    };
+    lockfile.dependencies["simtech/a@1.0.0"] = {
+        .commit = "df22cb4bdb8080d3626b8ba50c00a1abe15fb167",
+        .tree   = "acdd62c2ba211c632461d8d8777afe1cb3d31096",
+    };
+    lockfile.dependencies["simtech/c@1.0.0"] = {
+        .archive = "9f86d081884c7d659a2feaa0c55ad015a3bf4f1b2b0b822cd15d6c15b0f00a08",
+    };
+
+    YAML::Node node;
+    node = lockfile;
+
+    YAML::Emitter emitter;
+    emitter << node;
+    EXPECT_EQ(YAML::Load(emitter.c_str()).as<cpak::Lockfile>(), lockfile);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////                    Schema Validation Tests                      ///////
+///////////////////////////////////////////////////////////////////////////////
+TEST(LockfileTests, cannotDecodeLockfileWithoutTree) {
+    const auto& yamlStr = R"(
+dependencies:
+  simtech/sample@1.0.0:
+    commit: df22cb4bdb8080d3626b8ba50c00a1abe15fb167
+)";
+
+    try {
+        const auto& yaml     = YAML::Load(yamlStr);
+        const auto& lockfile = yaml.as<cpak::Lockfile>();
+        FAIL() << "Expected an exception.";
+    } catch (const YAML::Exception& e) {
+        EXPECT_EQ(e.msg, "Locked dependency must have a commit and a tree.");
+    }
+}
+
+TEST(LockfileTests, cannotDecodeLockfileWithDependencySequence) {
+    const auto& yamlStr = R"(
+dependencies:
+  - simtech/sample@1.0.0
+)";
+
+    try {
+        const auto& yaml     = YAML::Load(yamlStr);
+        const auto& lockfile = yaml.as<cpak::Lockfile>();
+        FAIL() << "Expected an exception.";
+    } catch (const YAML::Exception& e) {
+        EXPECT_EQ(e.msg, "Lockfile dependencies must be a map.");
+    }
+}
+
+TEST(LockfileTests, cannotDecodeLockfileWithMalformedHashes) {
+    // Abbreviated, non-hex and overlong hashes are all rejected.
+    for (const auto& [commit, tree] : {
+             std::pair{ "df22cb4", "acdd62c2ba211c632461d8d8777afe1cb3d31096" },
+             std::pair{ "df22cb4bdb8080d3626b8ba50c00a1abe15fb167", "main" },
+             std::pair{ "zf22cb4bdb8080d3626b8ba50c00a1abe15fb167",
+                        "acdd62c2ba211c632461d8d8777afe1cb3d31096" },
+             std::pair{ "df22cb4bdb8080d3626b8ba50c00a1abe15fb1670",
+                        "acdd62c2ba211c632461d8d8777afe1cb3d31096" } }) {
+        const auto yamlStr = fmt::format(
+            "dependencies:\n  simtech/sample@1.0.0:\n    commit: {}\n    tree: {}\n",
+            commit, tree);
+
+        try {
+            const auto& yaml     = YAML::Load(yamlStr);
+            const auto& lockfile = yaml.as<cpak::Lockfile>();
+            ADD_FAILURE() << "Expected an exception for " << commit << " " << tree;
+        } catch (const YAML::Exception& e) {
+            EXPECT_EQ(e.msg, "Locked commit and tree must be hashes.");
+        }
+    }
+}
+
+TEST(LockfileTests, canDecodeSha256Hashes) {
+    const auto& yamlStr = R"(
+dependencies:
+  simtech/sample@1.0.0:
+    commit: 9f86d081884c7d659a2feaa0c55ad015a3bf4f1b2b0b822cd15d6c15b0f00a08
+    tree: 60303ae22b998861bce3b28f33eec1be758a213c86c93c076dbe9f558c11c752
+)";
+
+    const auto& lockfile = YAML::Load(yamlStr).as<cpak::Lockfile>();
+    EXPECT_EQ(lockfile.dependencies.at("simtech/sample@1.0.0").commit,
+              "9f86d081884c7d659a2feaa0c55ad015a3bf4f1b2b0b822cd15d6c15b0f00a08");
+}
+
+TEST(LockfileTests, cannotDecodeLockfileWithMalformedArchiveDigest) {
+    const auto& yamlStr = R"(
+dependencies:
+  simtech/sample@1.0.0:
+    archive: df22cb4bdb8080d3626b8ba50c00a1abe15fb167
+)";
+
+    try {
+        const auto& yaml     = YAML::Load(yamlStr);
+        const auto& lockfile = yaml.as<cpak::Lockfile>();
+        FAIL() << "Expected an exception.";
+    } catch (const YAML::Exception& e) {
+        EXPECT_EQ(e.msg, "Locked archive must be a digest.");
+    }
+}
+
+TEST(LockfileTests, cannotDecodeLockfileWithInvalidCPakID) {
+    const auto& yamlStr = R"(
+dependencies:
+  not-a-cpakid:
+    commit: df22cb4bdb8080d3626b8ba50c00a1abe15fb167
+    tree: acdd62c2ba211c632461d8d8777afe1cb3d31096
+)";
+
+    try {
+        const auto& yaml     = YAML::Load(yamlStr);
+        const auto& lockfile = yaml.as<cpak::Lockfile>();
+        FAIL() << "Expected an exception.";
+    } catch (const YAML::Exception& e) {
+        EXPECT_EQ(e.mark.line, 2);
+        EXPECT_EQ(e.mark.column, 2 + 12);
+    }
+}
+
+TEST(LockfileTests, cannotDecodeLockfileWithOverflowingVersion) {
+    const auto& yamlStr = R"(
+dependencies:
+  simtech/sample@99999999999999999999.0.0:
+    commit: df22cb4bdb8080d3626b8ba50c00a1abe15fb167
+    tree: acdd62c2ba211c632461d8d8777afe1cb3d31096
+)";
+
+    try {
+        const auto& yaml     = YAML::Load(yamlStr);
+        const auto& lockfile = yaml.as<cpak::Lockfile>();
+        FAIL() << "Expected an exception.";
+    } catch (const YAML::Exception& e) {
+        EXPECT_EQ(e.msg, "Locked dependency version is out of range.");
+    }
+}
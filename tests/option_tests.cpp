@@ -21,6 +21,22 @@ value: 1.0
 }
 
 
+TEST(OptionTests, canRecordReferencedOptions) {
+    const std::vector<cpak::BuildOption> options{
+        { .name = "OPT_LEVEL", .value = "2" },
+        { .name = "UNUSED", .value = "yes" },
+    };
+
+    std::map<std::string, std::string> referenced;
+    std::string argument = "-O${OPT_LEVEL}";
+    cpak::interpolateOptions(argument, options, referenced);
+
+    EXPECT_EQ(argument, "-O2");
+    ASSERT_EQ(referenced.size(), 1);
+    EXPECT_EQ(referenced["OPT_LEVEL"], "2");
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////                    Schema Validation Tests                      ///////
 ///////////////////////////////////////////////////////////////////////////////
@@ -113,3 +129,38 @@ value: 1.0
     cpak::interpolateOptions(argument, { option });
     EXPECT_EQ(argument, "-DVALUE:1.0");
 }
+
+TEST(OptionTests, canInterpolateManyOptions) {
+    const std::vector<cpak::BuildOption> options{
+        { .name = "ROOT", .value = "/opt" },
+        { .name = "ARCH", .value = "x64" },
+    };
+
+    std::string argument = "${ROOT}/lib/${ARCH}/$HOME/${ARCH}";
+    cpak::interpolateOptions(argument, options);
+    EXPECT_EQ(argument, "/opt/lib/x64/$HOME/x64");
+}
+
+TEST(OptionTests, keepsUnknownOptions) {
+    const std::vector<cpak::BuildOption> options{
+        { .name = "KNOWN", .value = "1" },
+    };
+
+    std::map<std::string, std::string> referenced;
+    std::string argument = "${UNKNOWN}-${KNOWN}-${lower}-${";
+    cpak::interpolateOptions(argument, options, referenced);
+
+    EXPECT_EQ(argument, "${UNKNOWN}-1-${lower}-${");
+    ASSERT_EQ(referenced.size(), 1);
+    EXPECT_EQ(referenced["KNOWN"], "1");
+}
+
+TEST(OptionTests, doesNotInterpolateOptionValues) {
+    const std::vector<cpak::BuildOption> options{
+        { .name = "SELF", .value = "${SELF}" },
+    };
+
+    std::string argument = "-D${SELF}";
+    cpak::interpolateOptions(argument, options);
+    EXPECT_EQ(argument, "-D${SELF}");
+}
@@ -0,0 +1,89 @@
+#include "decoder.hpp"
+#include "errorcode.hpp"
+#include "pipeline.hpp"
+#include "gtest/gtest.h"
+
+using namespace cpak;
+
+
+static CPakFile
+decode(const std::string& contents) {
+    if (spdlog::get("cpak") == nullptr) spdlog::stdout_color_mt("cpak");
+
+    std::istringstream stream(contents);
+    return decoder::decodeCPakFile(stream);
+}
+
+
+static constexpr std::string_view kCPakFile = R"(
+project:
+  name: sample
+  gpid: simtech
+  semv: 1.0.0
+
+options:
+- name: SUFFIX
+  value: exe
+
+targets:
+- name: base
+  type: static library
+  sources:
+  - source/base.cpp
+- name: common
+  type: interface
+  defines:
+  - COMMON=1
+- name: app${SUFFIX}
+  type: executable
+  interfaces:
+  - common
+  libraries:
+  - base
+  - pthread
+  sources:
+  - source/${SUFFIX}.cpp
+- name: other
+  type: executable
+  sources:
+  - source/${SUFFIX}/other.cpp
+)";
+
+
+///////////////////////////////////////////////////////////////////////////////
+///////                    Target Selection Tests                       ///////
+///////////////////////////////////////////////////////////////////////////////
+TEST(PipelineTests, selectsWhatTheRequestedTargetsNeed) {
+    auto cpakfile = decode(std::string(kCPakFile));
+    const auto [unresolved, result] = selectTargets(cpakfile, { "appexe" });
+
+    ASSERT_EQ(result.value(), errc::success);
+    ASSERT_EQ(cpakfile.targets.size(), 3);
+    EXPECT_EQ(cpakfile.targets[0].name, "base");
+    EXPECT_EQ(cpakfile.targets[1].name, "common");
+    EXPECT_EQ(cpakfile.targets[2].name, "appexe");
+    EXPECT_EQ(cpakfile.targets[2].sources[0].stored, "source/exe.cpp");
+    EXPECT_EQ(cpakfile.targets[2].sources[0].owner, &cpakfile.targets[2]);
+
+    ASSERT_EQ(unresolved.size(), 1);
+    EXPECT_EQ(unresolved[0], "pthread");
+}
+
+TEST(PipelineTests, interpolatesTheSelectedTargets) {
+    auto cpakfile = decode(std::string(kCPakFile));
+    const auto [unresolved, result] = selectTargets(cpakfile, { "other" });
+
+    ASSERT_EQ(result.value(), errc::success);
+    ASSERT_EQ(cpakfile.targets.size(), 1);
+    EXPECT_EQ(cpakfile.targets[0].sources[0].stored, "source/exe/other.cpp");
+    EXPECT_EQ(cpakfile.targets[0].sources[0].owner, &cpakfile.targets[0]);
+    EXPECT_TRUE(unresolved.empty());
+}
+
+TEST(PipelineTests, cannotSelectUnknownTargets) {
+    auto cpakfile = decode(std::string(kCPakFile));
+    const auto [unresolved, result] = selectTargets(cpakfile, { "missing" });
+
+    EXPECT_EQ(result.value(), errc::buildTargetNotFound);
+    EXPECT_EQ(cpakfile.targets.size(), 4);
+}
@@ -0,0 +1,85 @@
+#include "errorcode.hpp"
+#include "identity.hpp"
+#include "utilities/stropts.hpp"
+#include "gtest/gtest.h"
+
+// Referenced from application.cpp
+extern std::shared_ptr<spdlog::logger> logger;
+
+std::tuple<std::vector<std::string>, std::error_code>
+readPullList(const std::filesystem::path& listPath, bool useBranch) noexcept;
+
+std::vector<cpak::Identity>
+uniquePullIdentities(const std::vector<std::string>& ids, bool useBranch) noexcept;
+
+
+static std::filesystem::path
+writePullList(const std::string& contents) {
+    if (spdlog::get("cpak") == nullptr) spdlog::stdout_color_mt("cpak");
+    logger = spdlog::get("cpak");
+
+    const auto listPath = std::filesystem::path(testing::TempDir()) / "pull_list";
+    std::ofstream(listPath) << contents;
+    return listPath;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+///////                       Pull List Tests                           ///////
+///////////////////////////////////////////////////////////////////////////////
+TEST(PullTests, trimsStringsOfOnlyWhitespace) {
+    EXPECT_EQ(cpak::utilities::ltrim(" \t\r\n"), "");
+    EXPECT_EQ(cpak::utilities::ltrim(""), "");
+    EXPECT_EQ(cpak::utilities::ltrim("  simtech/a@1.0.0 "), "simtech/a@1.0.0 ");
+    EXPECT_EQ(cpak::utilities::trim("\t simtech/a@1.0.0 \r"), "simtech/a@1.0.0");
+}
+
+TEST(PullTests, readsIdsSkippingBlankLinesAndComments) {
+    const auto listPath = writePullList(
+        "# Build agent packages\n"
+        "simtech/a@1.0.0\n"
+        "   \n"
+        "\n"
+        "  simtech/b@2.1.0  \r\n"
+        "  # simtech/c@1.0.0\n");
+
+    const auto [ids, result] = readPullList(listPath, false);
+    ASSERT_EQ(result.value(), 0) << result.message();
+    EXPECT_EQ(ids, (std::vector<std::string>{ "simtech/a@1.0.0", "simtech/b@2.1.0" }));
+}
+
+TEST(PullTests, readsBranchIds) {
+    const auto listPath = writePullList("simtech/a@main\nsimtech/b@release.2\n");
+
+    const auto [ids, result] = readPullList(listPath, true);
+    ASSERT_EQ(result.value(), 0) << result.message();
+    EXPECT_EQ(ids, (std::vector<std::string>{ "simtech/a@main", "simtech/b@release.2" }));
+}
+
+TEST(PullTests, cannotReadListWithInvalidId) {
+    const auto listPath = writePullList("simtech/a@1.0.0\nsimtech/b@1.0\n");
+
+    const auto [ids, result] = readPullList(listPath, false);
+    EXPECT_EQ(result.value(), (int)cpak::errc::failure);
+    EXPECT_TRUE(ids.empty());
+}
+
+TEST(PullTests, cannotReadMissingList) {
+    writePullList("");
+
+    const auto [ids, result] = readPullList("/nonexistent/pull_list", false);
+    EXPECT_EQ(result.value(), (int)cpak::errc::pathDoesNotExist);
+    EXPECT_TRUE(ids.empty());
+}
+
+TEST(PullTests, pullsEachProjectOnce) {
+    const auto identities = uniquePullIdentities(
+        { "simtech/b@1.0.0", "simtech/a@1.0.0", "simtech/b@1.0.0",
+          "simtech/a@2.0.0" },
+        false);
+
+    ASSERT_EQ(identities.size(), 3);
+    EXPECT_EQ(cpak::identityToString(identities[0]), "simtech/b@1.0.0");
+    EXPECT_EQ(cpak::identityToString(identities[1]), "simtech/a@1.0.0");
+    EXPECT_EQ(cpak::identityToString(identities[2]), "simtech/a@2.0.0");
+}
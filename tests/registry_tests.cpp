@@ -0,0 +1,122 @@
+#include "decoder.hpp"
+#include "errorcode.hpp"
+#include "pipeline.hpp"
+#include "registry.hpp"
+#include "gtest/gtest.h"
+
+using namespace cpak;
+
+// Referenced from application.cpp
+extern std::queue<BuildTask> buildQueue;
+
+
+static CPakFile
+decode(const std::string& contents, const std::string& buildDirectory) {
+    if (spdlog::get("cpak") == nullptr) spdlog::stdout_color_mt("cpak");
+
+    // Every project compiles the same source.
+    const auto projectPath =
+        std::filesystem::path(testing::TempDir()) / "registry_tests";
+    std::filesystem::create_directories(projectPath);
+    std::ofstream(projectPath / "lib.cpp") << "int f() { return 0; }\n";
+
+    std::istringstream stream(contents);
+    auto cpakfile        = decoder::decodeCPakFile(stream);
+    cpakfile.projectPath = projectPath;
+    cpakfile.buildPath   = projectPath / buildDirectory;
+    return cpakfile;
+}
+
+
+static std::string
+libraryProject(const std::string& name, const std::string& dependencies) {
+    return fmt::format(R"(
+project:
+  name: {0}
+  gpid: simtech
+  semv: 1.0.0
+{1}
+targets:
+- name: {0}lib
+  type: static library
+  sources:
+  - lib.cpp
+)", name, dependencies);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+///////                        Registry Tests                           ///////
+///////////////////////////////////////////////////////////////////////////////
+TEST(RegistryTests, reservesEachProjectOnce) {
+    ProjectRegistry registry;
+    const auto identity = identityFromString("simtech/sample@1.0.0");
+
+    const auto [first, firstReserved]   = registry.reserve(identity);
+    const auto [second, secondReserved] = registry.reserve(identity);
+
+    EXPECT_TRUE(firstReserved);
+    EXPECT_FALSE(secondReserved);
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(registry.size(), 1);
+    EXPECT_EQ(registry.find(identity), first);
+    EXPECT_EQ(registry.get(first), nullptr);
+    EXPECT_EQ(registry.find(identityFromString("simtech/other@1.0.0")),
+              ProjectRegistry::kNoProject);
+}
+
+TEST(RegistryTests, storedProjectsKeepTheirAddress) {
+    ProjectRegistry registry;
+    const auto [handle, reserved] =
+        registry.reserve(identityFromString("simtech/a@1.0.0"));
+    const auto* stored =
+        &registry.store(handle, decode(libraryProject("a", ""), "a"));
+
+    for (auto index = 0; index < 256; ++index) {
+        const auto [other, _] = registry.reserve(
+            identityFromString(fmt::format("simtech/p{}@1.0.0", index)));
+        registry.store(other, decode(libraryProject("p", ""), "p"));
+    }
+
+    EXPECT_EQ(registry.get(handle), stored);
+    EXPECT_EQ(stored->targets.front().name, "alib");
+}
+
+TEST(RegistryTests, claimsTheBuildOfAProjectOnce) {
+    ProjectRegistry registry;
+    const auto [handle, reserved] =
+        registry.reserve(identityFromString("simtech/a@1.0.0"));
+
+    EXPECT_FALSE(registry.claimBuild(handle));
+    registry.store(handle, decode(libraryProject("a", ""), "a"));
+    EXPECT_TRUE(registry.claimBuild(handle));
+    EXPECT_FALSE(registry.claimBuild(handle));
+    EXPECT_FALSE(registry.claimBuild(ProjectRegistry::kNoProject));
+}
+
+TEST(RegistryTests, queuesDiamondDependencyOnce) {
+    // root depends on a and b, which both depend on c.
+    const auto dependsOnC = "dependencies:\n- simtech/c@1.0.0\n";
+    const auto rootFile   = libraryProject(
+        "root", "dependencies:\n- simtech/a@1.0.0\n- simtech/b@1.0.0\n");
+
+    auto& registry = ProjectRegistry::shared();
+    registry.clear();
+    for (const auto& [name, dependencies] :
+         { std::pair{ "a", dependsOnC }, std::pair{ "b", dependsOnC },
+           std::pair{ "c", "" } }) {
+        const auto [handle, reserved] = registry.reserve(
+            identityFromString(fmt::format("simtech/{}@1.0.0", name)));
+        registry.store(handle,
+                       decode(libraryProject(name, dependencies), name));
+    }
+
+    buildQueue = {};
+    const auto root = decode(rootFile, "root");
+    ASSERT_EQ(queueForBuild(root).value(), errc::success);
+
+    // A compile and a link task for each of root, a, b, and c.
+    EXPECT_EQ(buildQueue.size(), 8);
+    buildQueue = {};
+    registry.clear();
+}
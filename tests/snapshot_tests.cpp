@@ -0,0 +1,131 @@
+#include "errorcode.hpp"
+#include "snapshot.hpp"
+#include "gtest/gtest.h"
+
+
+struct SnapshotTestFixture : public ::testing::Test {
+protected:
+    static void
+    SetUpTestCase() {
+        // Keep the snapshots out of the real home directory.
+        originalHome_ = std::getenv("HOME");
+        temporaryHome_ =
+            std::filesystem::temp_directory_path() / ".snapshotcpaktesting";
+        std::filesystem::create_directories(temporaryHome_);
+        setenv("HOME", temporaryHome_.c_str(), 1);
+
+        cpakfile_ = YAML::Load(R"(
+project:
+  name: sample
+  gpid: simtech
+  semv: 1.0.0-alpha+dev
+  authors:
+  - someone
+  description: A sample project.
+
+options:
+- name: optimization
+  desc: The optimization level.
+  value: -O2
+
+repositories:
+- address: https://github.com/
+
+dependencies:
+- cpakid: simtech/other@2.1.0
+
+targets:
+- name: testexe
+  type: executable
+  defines:
+  - SAMPLE=1
+  - !private INTERNAL=1
+  options: >
+    -g ${optimization}
+  search:
+    include:
+    - include
+  sources:
+  - source/main.cpp
+
+install:
+  targets:
+  - testexe
+  files:
+  - !header include/*.hpp)").as<cpak::CPakFile>();
+    }
+
+    static void
+    TearDownTestCase() {
+        setenv("HOME", originalHome_.c_str(), 1);
+        std::filesystem::remove_all(temporaryHome_);
+    }
+
+    static std::string
+    dump(const cpak::CPakFile& cpakfile) {
+        return YAML::Dump(YAML::Node(cpakfile));
+    }
+
+    inline static std::string originalHome_;
+    inline static std::filesystem::path temporaryHome_;
+    inline static cpak::CPakFile cpakfile_;
+};
+
+
+/////////////////////////////////////////////////////////////////////////////
+///////                    Positive Snapshot Tests                    ///////
+/////////////////////////////////////////////////////////////////////////////
+TEST_F(SnapshotTestFixture, roundTripKeepsTheModel) {
+    const auto encoded = cpak::snapshot::encodeCPakFile(cpakfile_);
+    const auto decoded =
+        cpak::snapshot::decodeCPakFile(encoded.data(), encoded.size());
+
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(dump(*decoded), dump(cpakfile_));
+    EXPECT_EQ(decoded->targets[0].defines[1].owner, &decoded->targets[0]);
+    EXPECT_TRUE(decoded->targets[0].defines[1].isPrivate());
+}
+
+TEST_F(SnapshotTestFixture, storedSnapshotsCanBeLoaded) {
+    const auto key = cpak::snapshot::snapshotKey("digest");
+    ASSERT_EQ(cpak::snapshot::storeSnapshot(key, cpakfile_).value(),
+              cpak::errc::success);
+
+    const auto [loaded, result] = cpak::snapshot::loadSnapshot(key);
+    ASSERT_EQ(result.value(), cpak::errc::success);
+    ASSERT_TRUE(loaded.has_value());
+    EXPECT_EQ(dump(*loaded), dump(cpakfile_));
+}
+
+
+/////////////////////////////////////////////////////////////////////////////
+///////                    Negative Snapshot Tests                    ///////
+/////////////////////////////////////////////////////////////////////////////
+TEST_F(SnapshotTestFixture, keysDifferByContents) {
+    EXPECT_NE(cpak::snapshot::snapshotKey("first"),
+              cpak::snapshot::snapshotKey("second"));
+}
+
+TEST_F(SnapshotTestFixture, missingSnapshotIsACacheMiss) {
+    const auto [loaded, result] =
+        cpak::snapshot::loadSnapshot(cpak::snapshot::snapshotKey("missing"));
+    EXPECT_EQ(result.value(), cpak::errc::cacheMiss);
+    EXPECT_FALSE(loaded.has_value());
+}
+
+TEST_F(SnapshotTestFixture, cannotDecodeDamagedSnapshots) {
+    const auto encoded = cpak::snapshot::encodeCPakFile(cpakfile_);
+    EXPECT_FALSE(cpak::snapshot::decodeCPakFile(encoded.data(),
+                                                encoded.size() - 1));
+
+    auto damaged = encoded;
+    damaged[0] = 'X';
+    EXPECT_FALSE(cpak::snapshot::decodeCPakFile(damaged.data(),
+                                                damaged.size()));
+
+    // A length running past the end must not be trusted.
+    damaged = encoded;
+    damaged[4] = 0x7F;
+    EXPECT_FALSE(cpak::snapshot::decodeCPakFile(damaged.data(),
+                                                damaged.size()));
+}
\ No newline at end of file
@@ -0,0 +1,177 @@
+#include "errorcode.hpp"
+#include "solver.hpp"
+#include "gtest/gtest.h"
+
+using namespace cpak;
+
+
+// Every version of every package, and what each version requires.
+using PackageIndex = std::map<
+    std::string,
+    std::map<std::string, std::vector<std::pair<std::string, std::string>>>>;
+
+
+static VersionConstraint
+constraint(std::string_view text) {
+    return VersionConstraint::parse(text).value();
+}
+
+
+static solver::PackageSource
+sourceOf(const PackageIndex& index) {
+    return {
+        .versions = [&index](const std::string& package) {
+            std::vector<version> versions;
+            const auto iter = index.find(package);
+            if (iter != index.end())
+                for (const auto& [semv, _] : iter->second)
+                    versions.push_back(version::parse(semv));
+
+            return std::make_tuple(versions, make_error_code(errc::success));
+        },
+        .requirements = [&index](const std::string& package, const version& semv) {
+            std::vector<solver::Requirement> requirements;
+            for (const auto& [name, range] : index.at(package).at(semv.str()))
+                requirements.push_back({ name, constraint(range) });
+
+            return std::make_tuple(requirements, make_error_code(errc::success));
+        },
+    };
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+///////                       Constraint Tests                          ///////
+///////////////////////////////////////////////////////////////////////////////
+TEST(SolverTests, constraintsAcceptTheirRanges) {
+    const auto accepts = [](std::string_view text, std::string_view semv) {
+        return constraint(text).acceptsVersion(version::parse(std::string(semv)));
+    };
+
+    EXPECT_TRUE(accepts("^1.2", "1.9.0"));
+    EXPECT_FALSE(accepts("^1.2", "2.0.0"));
+    EXPECT_FALSE(accepts("^1.2", "1.1.9"));
+    EXPECT_TRUE(accepts("^0.2.3", "0.2.9"));
+    EXPECT_FALSE(accepts("^0.2.3", "0.3.0"));
+    EXPECT_TRUE(accepts("~1.2.3", "1.2.9"));
+    EXPECT_FALSE(accepts("~1.2.3", "1.3.0"));
+    EXPECT_TRUE(accepts(">=1.4 <2", "1.4.0"));
+    EXPECT_FALSE(accepts(">=1.4 <2", "2.0.0"));
+    EXPECT_TRUE(accepts("1.x || >=3", "3.1.0"));
+    EXPECT_FALSE(accepts("1.x || >=3", "2.1.0"));
+    EXPECT_TRUE(accepts("1.0 - 2.1", "2.1.7"));
+    EXPECT_TRUE(accepts("*", "4.0.0"));
+    EXPECT_TRUE(accepts("1.2.3", "1.2.3"));
+    EXPECT_FALSE(accepts("1.2.3", "1.2.4"));
+}
+
+TEST(SolverTests, constraintsOnlyAcceptNamedPreReleases) {
+    EXPECT_FALSE(constraint("^1.0").acceptsVersion(version::parse("1.1.0-rc.1")));
+    EXPECT_TRUE(constraint(">=1.1.0-rc.0 <2")
+                    .acceptsVersion(version::parse("1.1.0-rc.1")));
+    EXPECT_FALSE(constraint(">=1.1.0-rc.0 <2")
+                     .acceptsVersion(version::parse("1.2.0-rc.1")));
+}
+
+TEST(SolverTests, cannotParseInvalidConstraints) {
+    EXPECT_FALSE(VersionConstraint::parse("^1.a").has_value());
+    EXPECT_FALSE(VersionConstraint::parse(">=01.0").has_value());
+    EXPECT_FALSE(VersionConstraint::parse("<*").has_value());
+    EXPECT_TRUE(constraint("=1.0.0").isExact());
+    EXPECT_FALSE(constraint("1.0").isExact());
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+///////                         Solver Tests                            ///////
+///////////////////////////////////////////////////////////////////////////////
+TEST(SolverTests, selectsOneVersionSharedByEveryDependent) {
+    const PackageIndex index = {
+        { "simtech/a", { { "1.0.0", { { "simtech/c", "^1.1" } } } } },
+        { "simtech/b", { { "1.0.0", { { "simtech/c", ">=1.0 <1.3" } } } } },
+        { "simtech/c", { { "1.0.0", {} }, { "1.2.0", {} }, { "1.4.0", {} } } },
+    };
+
+    const auto [selection, result] = solver::resolve(
+        "root",
+        { { "simtech/a", constraint("^1") }, { "simtech/b", constraint("^1") } },
+        sourceOf(index));
+
+    ASSERT_EQ(result.value(), errc::success);
+    EXPECT_EQ(selection.size(), 3);
+    EXPECT_EQ(selection.at("simtech/c"), version::parse("1.2.0"));
+}
+
+TEST(SolverTests, backtracksToAnOlderVersion) {
+    // The newest a needs a c that b doesn't accept.
+    const PackageIndex index = {
+        { "simtech/a", { { "1.0.0", { { "simtech/c", "^1" } } },
+                         { "1.1.0", { { "simtech/c", "^2" } } } } },
+        { "simtech/b", { { "1.0.0", { { "simtech/c", "^1" } } } } },
+        { "simtech/c", { { "1.0.0", {} }, { "2.0.0", {} } } },
+    };
+
+    const auto [selection, result] = solver::resolve(
+        "root",
+        { { "simtech/a", constraint("^1") }, { "simtech/b", constraint("1.0.0") } },
+        sourceOf(index));
+
+    ASSERT_EQ(result.value(), errc::success);
+    EXPECT_EQ(selection.at("simtech/a"), version::parse("1.0.0"));
+    EXPECT_EQ(selection.at("simtech/c"), version::parse("1.0.0"));
+}
+
+TEST(SolverTests, prefersTheLockedVersion) {
+    const PackageIndex index = {
+        { "simtech/c", { { "1.0.0", {} }, { "1.2.0", {} }, { "1.4.0", {} } } },
+    };
+
+    auto source      = sourceOf(index);
+    source.preferred = [](const std::string&) -> std::optional<version> {
+        return version::parse("1.2.0");
+    };
+
+    const auto [selection, result] =
+        solver::resolve("root", { { "simtech/c", constraint("^1") } }, source);
+
+    ASSERT_EQ(result.value(), errc::success);
+    EXPECT_EQ(selection.at("simtech/c"), version::parse("1.2.0"));
+}
+
+TEST(SolverTests, explainsConflicts) {
+    const PackageIndex index = {
+        { "simtech/a", { { "1.0.0", { { "simtech/c", "^2" } } } } },
+        { "simtech/b", { { "1.0.0", { { "simtech/c", "^1" } } } } },
+        { "simtech/c", { { "1.0.0", {} }, { "2.0.0", {} } } },
+    };
+
+    std::vector<std::string> explanation;
+    const auto [selection, result] = solver::resolve(
+        "simtech/app",
+        { { "simtech/a", constraint("^1") }, { "simtech/b", constraint("^1") } },
+        sourceOf(index), &explanation);
+
+    ASSERT_EQ(result.value(), errc::versionConflict);
+    ASSERT_FALSE(explanation.empty());
+
+    std::string text;
+    for (const auto& line : explanation) text += line + "\n";
+    EXPECT_NE(text.find("simtech/a@1.0.0 depends on simtech/c ^2"), std::string::npos)
+        << text;
+    EXPECT_NE(text.find("simtech/b@1.0.0 depends on simtech/c ^1"), std::string::npos)
+        << text;
+    EXPECT_NE(text.find("version solving failed"), std::string::npos) << text;
+}
+
+TEST(SolverTests, explainsMissingVersions) {
+    std::vector<std::string> explanation;
+    const auto [selection, result] = solver::resolve(
+        "simtech/app", { { "simtech/a", constraint("^3") } },
+        sourceOf({ { "simtech/a", { { "1.0.0", {} } } } }), &explanation);
+
+    ASSERT_EQ(result.value(), errc::versionConflict);
+    ASSERT_EQ(explanation.size(), 1);
+    EXPECT_EQ(explanation.front(),
+              "Because simtech/app depends on simtech/a ^3, which matches no "
+              "versions, version solving failed.");
+}
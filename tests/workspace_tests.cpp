@@ -0,0 +1,194 @@
+#include "errorcode.hpp"
+#include "pipeline.hpp"
+#include "registry.hpp"
+#include "workspace.hpp"
+#include "gtest/gtest.h"
+
+// Referenced from application.cpp
+extern std::shared_ptr<spdlog::logger> logger;
+extern std::queue<cpak::BuildTask> buildQueue;
+
+std::error_code
+handleWorkspaceBuild(const std::filesystem::path& workspacePath) noexcept;
+
+
+// Writes a project with a single target that uses the shared library.
+static void
+writeMember(const std::filesystem::path& path, const std::string& name) {
+    std::filesystem::create_directories(path);
+    std::ofstream(path / "main.cpp") << "int shared();\nint main() { return shared(); }\n";
+    std::ofstream(path / "CPakFile") << fmt::format(R"(
+project:
+  name: {0}
+  gpid: simtech
+  semv: 1.0.0
+
+dependencies:
+- cpakid: simtech/shared@1.0.0
+  remote:
+    address: {1}
+
+targets:
+- name: {0}exe
+  type: executable
+  sources:
+  - main.cpp
+  libraries:
+  - sharedlib
+)", name, (path.parent_path() / "remotes").string());
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+///////                    Positive Decoding Tests                      ///////
+///////////////////////////////////////////////////////////////////////////////
+TEST(WorkspaceTests, canDecodeWorkspace) {
+    const auto& yamlStr = R"(
+members:
+  - core
+  - tools/app
+)";
+
+    const auto& yaml      = YAML::Load(yamlStr);
+    const auto& workspace = yaml.as<cpak::Workspace>();
+
+    EXPECT_EQ(workspace.members.size(), 2);
+    EXPECT_EQ(workspace.members[0], "core");
+    EXPECT_EQ(workspace.members[1], "tools/app");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////                    Schema Validation Tests                      ///////
+///////////////////////////////////////////////////////////////////////////////
+TEST(WorkspaceTests, cannotDecodeWorkspaceMissingMembers) {
+    const auto& yamlStr = R"(
+name: sample
+)";
+
+    try {
+        const auto& yaml      = YAML::Load(yamlStr);
+        const auto& workspace = yaml.as<cpak::Workspace>();
+        FAIL() << "Expected an exception.";
+    } catch (const YAML::Exception& e) {
+        EXPECT_EQ(e.msg, "Workspace must list its members.");
+    }
+}
+
+TEST(WorkspaceTests, cannotDecodeWorkspaceEmptyMembers) {
+    const auto& yamlStr = R"(
+members: []
+)";
+
+    try {
+        const auto& yaml      = YAML::Load(yamlStr);
+        const auto& workspace = yaml.as<cpak::Workspace>();
+        FAIL() << "Expected an exception.";
+    } catch (const YAML::Exception& e) {
+        EXPECT_EQ(e.msg, "Workspace members must not be empty.");
+    }
+}
+
+TEST(WorkspaceTests, cannotDecodeWorkspaceNonScalarMember) {
+    const auto& yamlStr = R"(
+members:
+  - path: core
+)";
+
+    try {
+        const auto& yaml      = YAML::Load(yamlStr);
+        const auto& workspace = yaml.as<cpak::Workspace>();
+        FAIL() << "Expected an exception.";
+    } catch (const YAML::Exception& e) {
+        EXPECT_EQ(e.msg, "Workspace member must be a path.");
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////                      Workspace Build Tests                      ///////
+///////////////////////////////////////////////////////////////////////////////
+TEST(WorkspaceTests, buildsMembersWithSharedDependencyAsOneGraph) {
+    if (spdlog::get("cpak") == nullptr) spdlog::stdout_color_mt("cpak");
+    logger = spdlog::get("cpak");
+
+    const auto rootPath = std::filesystem::temp_directory_path() / ".workspacecpaktesting";
+    const auto homePath = std::string(std::getenv("HOME"));
+    std::filesystem::remove_all(rootPath);
+
+    // Both members depend on the same library from a remote on disk.
+    const auto remotePath = rootPath / "remotes" / "simtech" / "shared";
+    subprocess::check_output(
+        fmt::format("mkdir -p {0} && cd {0} && git init --quiet && "
+                    "printf 'int shared() {{ return 0; }}\\n' > shared.cpp && "
+                    "printf 'project:\\n  name: shared\\n  gpid: simtech\\n"
+                    "  semv: 1.0.0\\ntargets:\\n- name: sharedlib\\n"
+                    "  type: static library\\n  sources:\\n  - shared.cpp\\n' > CPakFile && "
+                    "git add CPakFile shared.cpp && "
+                    "git -c user.name=cpak -c user.email=cpak@localhost "
+                    "commit --quiet -m init && git tag 1.0.0",
+                    remotePath.string()),
+        subprocess::shell{ true });
+
+    writeMember(rootPath / "first", "first");
+    writeMember(rootPath / "second", "second");
+    std::ofstream(rootPath / "CPakWorkspace") << "members:\n- first\n- second\n";
+
+    auto& registry = cpak::ProjectRegistry::shared();
+    registry.clear();
+    buildQueue = {};
+
+    setenv("HOME", (rootPath / "home").c_str(), 1);
+    const auto result = handleWorkspaceBuild(rootPath);
+    setenv("HOME", homePath.c_str(), 1);
+
+    const auto* first  = registry.get(
+        registry.find(cpak::identityFromString("simtech/first@1.0.0")));
+    const auto* second = registry.get(
+        registry.find(cpak::identityFromString("simtech/second@1.0.0")));
+    const auto projects = registry.size();
+    const auto built    = first != nullptr && second != nullptr &&
+        std::filesystem::exists(first->binaryBuildPath() / "firstexe") &&
+        std::filesystem::exists(second->binaryBuildPath() / "secondexe");
+
+    registry.clear();
+    std::filesystem::remove_all(rootPath);
+
+    // The shared dependency is loaded and built once for both members.
+    ASSERT_EQ(result.value(), 0) << result.message();
+    EXPECT_EQ(projects, 3);
+    EXPECT_TRUE(built);
+}
+
+TEST(WorkspaceTests, linkTasksWaitForQueuedCompileTasks) {
+    if (spdlog::get("cpak") == nullptr) spdlog::stdout_color_mt("cpak");
+
+    // Compile tasks run on the pool and finish out of order, a link task must
+    // only run once every task queued before it is done.
+    std::atomic<int> compiled{ 0 };
+    std::vector<int> seenByLinks;
+    const auto compile = [&compiled](int delay) {
+        return cpak::BuildTask{ .execute = [&compiled, delay] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+            ++compiled;
+            return cpak::make_error_code(cpak::errc::success);
+        } };
+    };
+
+    const auto link = cpak::BuildTask{
+        .execute = [&] {
+            seenByLinks.push_back(compiled.load());
+            return cpak::make_error_code(cpak::errc::success);
+        },
+        .waitsForQueued = true,
+    };
+
+    buildQueue = {};
+    for (const auto delay : { 30, 10, 20 }) buildQueue.push(compile(delay));
+    buildQueue.push(link);
+    for (const auto delay : { 20, 0 }) buildQueue.push(compile(delay));
+    buildQueue.push(link);
+
+    const auto result = cpak::executeBuild();
+    ASSERT_EQ(result.value(), 0) << result.message();
+    EXPECT_EQ(seenByLinks, (std::vector{ 3, 5 }));
+    EXPECT_EQ(compiled.load(), 5);
+}